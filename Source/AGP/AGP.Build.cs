@@ -10,7 +10,13 @@ public class AGP : ModuleRules
 	
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore" });
 
-		PrivateDependencyModuleNames.AddRange(new string[] { "EnhancedInput", "AIModule" });
+		PrivateDependencyModuleNames.AddRange(new string[] { "EnhancedInput", "AIModule", "Json", "NavigationSystem" });
+
+		if (Target.bBuildEditor)
+		{
+			// For the undo transactions of the navigation graph generator.
+			PrivateDependencyModuleNames.Add("UnrealEd");
+		}
 
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/WorldSettings.h"
+#include "AGPWorldSettings.generated.h"
+
+/**
+ * The world settings used by every map in this project. Holds the per-map options of the pathfinding subsystem.
+ */
+UCLASS()
+class AGP_API AAGPWorldSettings : public AWorldSettings
+{
+	GENERATED_BODY()
+
+public:
+
+	/**
+	 * If true, the pathfinding subsystem will load the navigation graph, its landmarks and its distance fields from the
+	 * file baked for this map with the AGP.Pathfinding.BakeGraph console command, instead of walking the navigation
+	 * node actors and building them when the world begins play. Bake again after changing the nodes. Falls back to the
+	 * actors if the map has no usable baked file.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Pathfinding")
+	bool bUseBakedNavigationGraph = false;
+
+	/**
+	 * If true, the pathfinding subsystem will precompute the shortest path between every pair of nodes when the world
+	 * begins play, so that finding a path is just a walk along the table. Uses memory quadratic in the node count.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Pathfinding")
+	bool bUseNextHopTable = false;
+
+	/**
+	 * The next hop table is skipped if the map has more nodes than this. The table stores node ids in 16 bits, so it
+	 * can't hold more than 65534 nodes.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Pathfinding", meta = (EditCondition = "bUseNextHopTable", ClampMin = "1", ClampMax = "65534"))
+	int32 MaxNextHopTableNodes = 4096;
+
+	/**
+	 * The next hop table is skipped if it would need more memory than this. It takes 4 bytes per pair of nodes, so 64
+	 * MB for 4096 nodes.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Pathfinding", meta = (EditCondition = "bUseNextHopTable", ClampMin = "1", Units = "Megabytes"))
+	int32 MaxNextHopTableMegabytes = 128;
+
+	/**
+	 * The number of landmarks used to tighten the A* heuristic. Each one costs two 16 bit distances per node and two
+	 * searches over the whole graph when the world begins play. Zero, the default, turns the landmark heuristic off.
+	 * Worth turning on for maps where paths take long detours, such as mazes. Compare the nodes expanded with the
+	 * AGP.Pathfinding.CompareHeuristics console command before keeping it on.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Pathfinding", meta = (ClampMin = "0", ClampMax = "32"))
+	int32 NumLandmarks = 0;
+
+	/**
+	 * If true, the pathfinding subsystem will build a contraction hierarchy when the world begins play and answer node
+	 * to node paths with it instead of A*. Best for large levels whose navigation graph doesn't change.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Pathfinding")
+	bool bUseContractionHierarchy = false;
+
+	/**
+	 * If true, node to node path requests are answered over a clustered abstract graph and only the part of the path
+	 * that is about to be walked is refined into real nodes. The paths can be slightly longer than the shortest path.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Pathfinding")
+	bool bUseHierarchicalPathfinding = false;
+
+	/**
+	 * If true, the A* searches of path requests run on the game thread, a slice at a time, under a budget shared by
+	 * every request each frame, instead of on the worker threads. The searches that can't be sliced, such as over the
+	 * hierarchies, still run on the workers. Keeps the frame time flat however many requests are waiting, at the cost
+	 * of the paths taking longer to arrive.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Pathfinding")
+	bool bTimeSlicePathRequests = false;
+
+	/**
+	 * The time, in microseconds, that the time sliced searches of all of the path requests may take each frame.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Pathfinding", meta = (EditCondition = "bTimeSlicePathRequests", ClampMin = "10", Units = "Microseconds"))
+	float PathSearchBudgetMicroseconds = 500.0f;
+};
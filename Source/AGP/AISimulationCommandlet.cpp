@@ -0,0 +1,272 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AISimulationCommandlet.h"
+
+#include "AGP/Characters/EnemyCharacter.h"
+#include "AGP/Characters/HealthComponent.h"
+#include "AGP/Characters/PlayerCharacter.h"
+#include "AGP/Pathfinding/NavigationNode.h"
+#include "AGP/Pathfinding/PathfindingSubsystem.h"
+#include "AGP/Pathfinding/SyntheticNavigationGraph.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+CSV_DEFINE_CATEGORY(AISimulation, true);
+
+namespace
+{
+	// The scripted player walks between random nodes at this speed.
+	constexpr float PlayerSpeed = 500.0f;
+	// Enemies within this distance of the player may be damaged each second.
+	constexpr float PlayerRange = 1500.0f;
+	constexpr float DamageChance = 0.5f;
+	constexpr float Damage = 10.0f;
+	// Every enemy is healed by this much every HealInterval seconds, so damaged enemies come back out of cover.
+	constexpr float Healing = 30.0f;
+	constexpr float HealInterval = 5.0f;
+	// The characters are spawned this far above the nodes so their capsules start clear of the floor.
+	constexpr double SpawnHeight = 100.0;
+
+	/**
+	 * @return A hash of the rounded positions, states and health of the enemies.
+	 */
+	uint32 HashEnemies(TConstArrayView<AEnemyCharacter*> Enemies, TConstArrayView<UHealthComponent*> EnemyHealth)
+	{
+		uint32 Hash = 0;
+		for (int32 Index = 0; Index < Enemies.Num(); ++Index)
+		{
+			const FVector Location = Enemies[Index]->GetActorLocation();
+			const int32 State[5] = {
+				FMath::RoundToInt32(Location.X),
+				FMath::RoundToInt32(Location.Y),
+				FMath::RoundToInt32(Location.Z),
+				static_cast<int32>(Enemies[Index]->GetCurrentState()),
+				EnemyHealth[Index] ? FMath::RoundToInt32(EnemyHealth[Index]->GetCurrentHealth()) : 0
+			};
+			Hash = FCrc::MemCrc32(State, sizeof(State), Hash);
+		}
+		return Hash;
+	}
+}
+
+UAISimulationCommandlet::UAISimulationCommandlet()
+{
+	LogToConsole = true;
+}
+
+int32 UAISimulationCommandlet::Main(const FString& Params)
+{
+#if !CSV_PROFILER
+	UE_LOG(LogTemp, Error, TEXT("The AI simulation records its frames with the CSV profiler, which isn't in this build."))
+	return 1;
+#else
+	int32 NumEnemies = 100;
+	FParse::Value(*Params, TEXT("Enemies="), NumEnemies);
+	NumEnemies = FMath::Max(NumEnemies, 1);
+	int32 NumFrames = 1800;
+	FParse::Value(*Params, TEXT("Frames="), NumFrames);
+	float FixedStep = 1.0f / 30.0f;
+	FParse::Value(*Params, TEXT("FixedStep="), FixedStep);
+	FString ShapeName = TEXT("Grid");
+	FParse::Value(*Params, TEXT("Shape="), ShapeName);
+	int32 NumNodes = 10000;
+	FParse::Value(*Params, TEXT("Nodes="), NumNodes);
+	int32 Seed = 1;
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FString EnemyClassPath;
+	FParse::Value(*Params, TEXT("EnemyClass="), EnemyClassPath);
+	FString OutputPath = FPaths::ProfilingDir() / TEXT("CSV/AISimulation.csv");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	ESyntheticGraphShape Shape;
+	if (!FSyntheticNavigationGraph::ParseShape(ShapeName, Shape))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unknown graph shape %s."), *ShapeName)
+		return 1;
+	}
+	TSubclassOf<AEnemyCharacter> EnemyClass = AEnemyCharacter::StaticClass();
+	if (!EnemyClassPath.IsEmpty())
+	{
+		EnemyClass = LoadClass<AEnemyCharacter>(nullptr, *EnemyClassPath);
+		if (!EnemyClass)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Unable to load the enemy class %s."), *EnemyClassPath)
+			return 1;
+		}
+	}
+	UStaticMesh* FloorMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!FloorMesh)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unable to load the floor mesh."))
+		return 1;
+	}
+
+	// The engine's own random numbers are used by the pawn sensing timers, so seed them along with the script.
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+	FRandomStream ScriptStream(Seed);
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(FixedStep);
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("AISimulation"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->SetGameMode(FURL());
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	UPathfindingSubsystem* PathfindingSubsystem = World->GetSubsystem<UPathfindingSubsystem>();
+	if (!PathfindingSubsystem)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Unable to find the PathfindingSubsystem"))
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		return 1;
+	}
+	PathfindingSubsystem->SetDeterministicPathDelivery(true);
+	const FSyntheticNavigationGraph GraphData = FSyntheticNavigationGraph::Generate(Shape, NumNodes, Seed);
+	PathfindingSubsystem->RebuildFromGraphData(GraphData.Locations, GraphData.NodeTypes, GraphData.Connections);
+
+	// A single flat box under the whole graph for the characters to walk on. Its top is level with the nodes.
+	const FBox Bounds(GraphData.Locations);
+	const FVector FloorScale((Bounds.GetSize().X + 2.0 * PlayerRange) / 100.0, (Bounds.GetSize().Y + 2.0 * PlayerRange) / 100.0, 1.0);
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AStaticMeshActor* Floor = World->SpawnActor<AStaticMeshActor>(AStaticMeshActor::StaticClass(),
+		FTransform(FRotator::ZeroRotator, FVector(Bounds.GetCenter().X, Bounds.GetCenter().Y, -50.0), FloorScale), SpawnParameters);
+	Floor->GetStaticMeshComponent()->SetStaticMesh(FloorMesh);
+
+	const auto RandomNodeLocation = [&ScriptStream, &GraphData]()
+	{
+		return GraphData.Locations[ScriptStream.RandHelper(GraphData.Locations.Num())] + FVector(0.0, 0.0, SpawnHeight);
+	};
+
+	// The pawn sensing of the enemies only notices pawns that are controlled by a player controller.
+	APlayerCharacter* Player = World->SpawnActor<APlayerCharacter>(APlayerCharacter::StaticClass(), RandomNodeLocation(), FRotator::ZeroRotator, SpawnParameters);
+	APlayerController* PlayerController = World->SpawnActor<APlayerController>(SpawnParameters);
+	PlayerController->Possess(Player);
+	FVector PlayerTarget = RandomNodeLocation();
+
+	TArray<AEnemyCharacter*> Enemies;
+	TArray<UHealthComponent*> EnemyHealth;
+	Enemies.Reserve(NumEnemies);
+	EnemyHealth.Reserve(NumEnemies);
+	for (int32 Index = 0; Index < NumEnemies; ++Index)
+	{
+		const FRotator Rotation(0.0, ScriptStream.FRandRange(0.0f, 360.0f), 0.0);
+		AEnemyCharacter* Enemy = World->SpawnActor<AEnemyCharacter>(EnemyClass, RandomNodeLocation(), Rotation, SpawnParameters);
+		if (!Enemy->GetController())
+		{
+			// The character movement only runs for characters that have a controller.
+			Enemy->SpawnDefaultController();
+		}
+		Enemies.Add(Enemy);
+		EnemyHealth.Add(Enemy->FindComponentByClass<UHealthComponent>());
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Simulating %d enemies on a %s graph of %d nodes for %d frames."), NumEnemies,
+		FSyntheticNavigationGraph::GetShapeName(Shape), GraphData.Locations.Num(), NumFrames)
+
+	const int32 FramesPerDamage = FMath::Max(FMath::RoundToInt32(1.0f / FixedStep), 1);
+	const int32 FramesPerHeal = FMath::Max(FMath::RoundToInt32(HealInterval / FixedStep), 1);
+	FCsvProfiler::Get()->BeginCapture(-1, FPaths::GetPath(OutputPath), FPaths::GetCleanFilename(OutputPath));
+	uint32 StateHash = 0;
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		FCsvProfiler::Get()->BeginFrame();
+
+		// Walk the player towards its target and pick a new one when it gets there.
+		FVector PlayerLocation = Player->GetActorLocation();
+		const FVector ToTarget = PlayerTarget - PlayerLocation;
+		const double StepLength = PlayerSpeed * FixedStep;
+		if (ToTarget.Size() <= StepLength)
+		{
+			PlayerLocation = PlayerTarget;
+			PlayerTarget = RandomNodeLocation();
+		}
+		else
+		{
+			PlayerLocation += ToTarget.GetUnsafeNormal() * StepLength;
+		}
+		Player->SetActorLocation(PlayerLocation, false, nullptr, ETeleportType::TeleportPhysics);
+
+		if (Frame % FramesPerDamage == 0)
+		{
+			for (int32 Index = 0; Index < Enemies.Num(); ++Index)
+			{
+				if (EnemyHealth[Index] && FVector::Dist(Enemies[Index]->GetActorLocation(), PlayerLocation) <= PlayerRange
+					&& ScriptStream.FRand() < DamageChance)
+				{
+					EnemyHealth[Index]->ApplyDamage(Damage);
+				}
+			}
+		}
+		if (Frame % FramesPerHeal == 0)
+		{
+			for (UHealthComponent* Health : EnemyHealth)
+			{
+				if (Health)
+				{
+					Health->ApplyHealing(Healing);
+				}
+			}
+		}
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		World->Tick(LEVELTICK_All, FixedStep);
+		const double GameThreadMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+		++GFrameCounter;
+
+		int32 NumEvade = 0;
+		int32 NumSlipAway = 0;
+		int32 NumLowHP = 0;
+		int32 NumControlled = 0;
+		for (const AEnemyCharacter* Enemy : Enemies)
+		{
+			switch (Enemy->GetCurrentState())
+			{
+			case EEnemyState::Evade:
+				++NumEvade;
+				break;
+			case EEnemyState::SlipAway:
+				++NumSlipAway;
+				break;
+			case EEnemyState::LowHP:
+				++NumLowHP;
+				break;
+			case EEnemyState::Controlled:
+				++NumControlled;
+				break;
+			}
+		}
+		StateHash = HashEnemies(Enemies, EnemyHealth);
+
+		CSV_CUSTOM_STAT(AISimulation, GameThreadMs, static_cast<float>(GameThreadMs), ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(AISimulation, Enemies, Enemies.Num(), ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(AISimulation, Evade, NumEvade, ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(AISimulation, SlipAway, NumSlipAway, ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(AISimulation, LowHP, NumLowHP, ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(AISimulation, Controlled, NumControlled, ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(AISimulation, StateHash, static_cast<int32>(StateHash), ECsvCustomStatOp::Set);
+
+		FCsvProfiler::Get()->EndFrame();
+	}
+
+	// The capture ends at the start of the next frame and the file is written on another thread.
+	const TSharedFuture<FString> CsvFilename = FCsvProfiler::Get()->EndCapture();
+	FCsvProfiler::Get()->BeginFrame();
+	FCsvProfiler::Get()->EndFrame();
+	UE_LOG(LogTemp, Display, TEXT("Wrote the simulation frames to %s. Final state hash %08x."), *CsvFilename.Get(), StateHash)
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	return 0;
+#endif
+}
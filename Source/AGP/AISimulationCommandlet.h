@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AISimulationCommandlet.generated.h"
+
+/**
+ * Runs many enemy characters on a generated navigation graph without a map or a renderer, to measure how the frame time
+ * grows with the number of enemies. A scripted player walks between random nodes and damages and heals the enemies
+ * near it on a fixed schedule, which drives the enemies through every state of their state machine. The world is
+ * ticked with a fixed time step and the CSV profiler records every frame: the game thread time, the enemy and
+ * pathfinding timings (including the searches on the workers), the engine's own timings and the number of enemies in
+ * each state.
+ *
+ * Every random choice comes from the seed and paths are delivered on the tick after they were requested, so two runs
+ * with the same arguments simulate the same frames. The StateHash column covers the positions, states and health of
+ * every enemy, so comparing it between runs shows where they diverged.
+ *
+ * Run with:
+ * UnrealEditor-Cmd AGP.uproject -run=AISimulation -nullrhi [-Enemies=100] [-Frames=1800] [-FixedStep=0.0333]
+ * [-Shape=Grid] [-Nodes=10000] [-Seed=1] [-EnemyClass=/Game/Blueprints/BP_EnemyCharacter.BP_EnemyCharacter_C]
+ * [-Output=Path.csv]
+ */
+UCLASS()
+class AGP_API UAISimulationCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UAISimulationCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
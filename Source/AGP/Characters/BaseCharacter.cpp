@@ -42,17 +42,23 @@ bool ABaseCharacter::Fire(const FVector& FireAtLocation)
 			{
 				HitCharacterHealth->ApplyDamage(WeaponDamage);
 			}
+#if ENABLE_DRAW_DEBUG
 			DrawDebugLine(GetWorld(), BulletStartPosition->GetComponentLocation(), HitResult.ImpactPoint, FColor::Green, false, 1.0f);
+#endif
 		}
 		else
 		{
+#if ENABLE_DRAW_DEBUG
 			DrawDebugLine(GetWorld(), BulletStartPosition->GetComponentLocation(), HitResult.ImpactPoint, FColor::Orange, false, 1.0f);
+#endif
 		}
 		
 	}
 	else
 	{
+#if ENABLE_DRAW_DEBUG
 		DrawDebugLine(GetWorld(), BulletStartPosition->GetComponentLocation(), FireAtLocation, FColor::Red, false, 1.0f);
+#endif
 	}
 
 	TimeSinceLastShot = 0.0f;
@@ -64,6 +70,11 @@ void ABaseCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+	UpdateTimeSinceLastShot(DeltaTime);
+}
+
+void ABaseCharacter::UpdateTimeSinceLastShot(float DeltaTime)
+{
 	if (bHasWeaponEquipped)
 	{
 		TimeSinceLastShot += DeltaTime;
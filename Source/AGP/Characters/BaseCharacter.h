@@ -61,6 +61,10 @@ protected:
 	 * @return true if a shot was taken and false otherwise.
 	 */
 	bool Fire(const FVector& FireAtLocation);
+	/**
+	 * Will advance the TimeSinceLastShot while a weapon is equipped. Called by Tick.
+	 */
+	void UpdateTimeSinceLastShot(float DeltaTime);
 
 public:	
 	// Called every frame
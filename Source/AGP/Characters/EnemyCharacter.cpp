@@ -6,11 +6,15 @@
 #include "HealthComponent.h"
 #include "PlayerCharacter.h"
 #include "AGP/Bunker.h"
+#include "AGP/SubSystemAI.h"
 #include "AGP/Pathfinding/PathfindingSubsystem.h"
 #include "Perception/PawnSensingComponent.h"
 #include "Components/SphereComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/GameplayStatics.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+CSV_DEFINE_CATEGORY(EnemyAI, true);
 
 // Sets default values
 AEnemyCharacter::AEnemyCharacter()
@@ -38,6 +42,30 @@ void AEnemyCharacter::BeginPlay()
 	{
 		PawnSensingComponent->OnSeePawn.AddDynamic(this, &AEnemyCharacter::OnSensedPawn);
 	}
+	if (HealthComponent)
+	{
+		HealthComponent->OnHealthChanged.AddUObject(this, &AEnemyCharacter::OnHealthChanged);
+	}
+	AISubsystem = GetWorld()->GetSubsystem<USubSystemAI>();
+	if (AISubsystem)
+	{
+		AISubsystem->RegisterAgent(this);
+		// The subsystem updates every enemy in one pass and holds their state, so this one doesn't tick at all.
+		PrimaryActorTick.UnRegisterTickFunction();
+	}
+}
+
+void AEnemyCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (AISubsystem)
+	{
+		AISubsystem->UnregisterAgent(this);
+	}
+	if (PathfindingSubsystem)
+	{
+		PathfindingSubsystem->CancelPathRequest(PathRequest);
+	}
+	Super::EndPlay(EndPlayReason);
 }
 
 void AEnemyCharacter::MoveAlongPath()
@@ -57,7 +85,70 @@ void AEnemyCharacter::MoveAlongPath()
 	if (FVector::Distance(GetActorLocation(), CurrentPath[CurrentPath.Num() - 1]) < PathfindingError)
 	{
 		CurrentPath.Pop();
+		// 3. If the path was found hierarchically then refine the next part of it.
+		if (CurrentPath.IsEmpty() && PathContinuation.HasRemaining() && PathfindingSubsystem)
+		{
+			PathfindingSubsystem->ContinuePath(PathContinuation, CurrentPath);
+		}
+		UpdatePathCursor();
+	}
+}
+
+void AEnemyCharacter::RequestPath(const FPathQuery& Query)
+{
+	if (!PathfindingSubsystem || PathfindingSubsystem->IsPathRequestPending(PathRequest)) return;
+
+	PathRequest = PathfindingSubsystem->RequestPathAsync(Query, FOnPathComputed::CreateUObject(this, &AEnemyCharacter::OnPathComputed));
+}
+
+void AEnemyCharacter::ResetPath()
+{
+	CurrentPath.Empty();
+	PathContinuation.Reset();
+	ActivePlanner.Reset();
+	UpdatePathCursor();
+	SetLastPathRequestFailed(false);
+	if (PathfindingSubsystem)
+	{
+		PathfindingSubsystem->CancelPathRequest(PathRequest);
+	}
+}
+
+void AEnemyCharacter::OnPathComputed(const TArray<FVector>& Path, const FPathContinuation& Continuation)
+{
+	PathRequest.Invalidate();
+	CurrentPath = Path;
+	PathContinuation = Continuation;
+	UpdatePathCursor();
+	SetLastPathRequestFailed(Path.IsEmpty());
+}
+
+void AEnemyCharacter::RequestPathToNearest(const FPathQuery& Query)
+{
+	if (!bUseIncrementalPlanner)
+	{
+		RequestPath(Query);
+		return;
 	}
+	if (!PathfindingSubsystem) return;
+
+	const EPointType GoalType = Query.Kind == EPathQueryKind::Exit ? EPointType::EscapePoint
+		: Query.Kind == EPathQueryKind::SpawnPoint ? EPointType::SpawnPoint : EPointType::Cover;
+	TSharedPtr<FDStarLitePlanner, ESPMode::ThreadSafe>& Planner = Planners.FindOrAdd(GoalType);
+	// A rebuilt graph has different nodes, so the planner has to start again on it.
+	if (!Planner || Planner->GetGraph() != PathfindingSubsystem->GetGraph())
+	{
+		Planner = PathfindingSubsystem->CreatePlanner(GoalType);
+		if (!Planner) return;
+	}
+	ActivePlanner = Planner;
+	SetLastPathRequestFailed(!PathfindingSubsystem->ReplanPath(*Planner, Query.StartLocation, CurrentPath));
+	UpdatePathCursor();
+}
+
+bool AEnemyCharacter::NeedsNewPath() const
+{
+	return CurrentPath.IsEmpty() || (ActivePlanner && ActivePlanner->HasPendingChanges());
 }
 
 void AEnemyCharacter::TickPatrol()
@@ -65,7 +156,7 @@ void AEnemyCharacter::TickPatrol()
 	//UE_LOG(LogTemp, Display, TEXT("TickPatrol"))
 	if (CurrentPath.IsEmpty())
 	{
-		CurrentPath = PathfindingSubsystem->GetRandomPath(GetActorLocation());
+		RequestPath({EPathQueryKind::Random, GetActorLocation()});
 	}
 	MoveAlongPath();
 }
@@ -73,46 +164,48 @@ void AEnemyCharacter::TickPatrol()
 void AEnemyCharacter::TickEngage()
 {
 	//UE_LOG(LogTemp, Display, TEXT("TickEngage"))
-	if (!SensedCharacter) return;
+	APlayerCharacter* Target = GetSensedCharacter();
+	if (!Target) return;
 	
 	if (CurrentPath.IsEmpty())
 	{
-		CurrentPath = PathfindingSubsystem->GetPath(GetActorLocation(), SensedCharacter->GetActorLocation());
+		RequestPath({EPathQueryKind::Point, GetActorLocation(), Target->GetActorLocation()});
 	}
 	MoveAlongPath();
-	Fire(SensedCharacter->GetActorLocation());
+	Fire(Target->GetActorLocation());
 }
 
 void AEnemyCharacter::TickEvade()
 {
 	//UE_LOG(LogTemp, Display, TEXT("TickEvade"))
 	// Find the player and return if it can't find it.
-	if (!SensedCharacter) return;
+	const APlayerCharacter* Target = GetSensedCharacter();
+	if (!Target) return;
 
 	if (CurrentPath.IsEmpty())
 	{
 		GetCharacterMovement()->MaxWalkSpeed = 600.0f;
-		CurrentPath = PathfindingSubsystem->GetPathAway(GetActorLocation(), SensedCharacter->GetActorLocation());
+		RequestPath({EPathQueryKind::Away, GetActorLocation(), Target->GetActorLocation()});
 	}
 	MoveAlongPath();
 }
 
 void AEnemyCharacter::TickAway()
 {
-	if (CurrentPath.IsEmpty())
+	if (NeedsNewPath())
 	{
 		GetCharacterMovement()->MaxWalkSpeed = 400.0f;
-		CurrentPath = PathfindingSubsystem->GetExitPath(GetActorLocation());
+		RequestPathToNearest({EPathQueryKind::Exit, GetActorLocation()});
 	}
 	MoveAlongPath();
 }
 
 void AEnemyCharacter::TickIntoCover()
 {
-	if(CurrentPath.IsEmpty())
+	if(NeedsNewPath() && !HasLastPathRequestFailed())
 	{
 		GetCharacterMovement()->MaxWalkSpeed = 700.0f;
-		CurrentPath = PathfindingSubsystem->GetNearestCoverPath(GetActorLocation(),GetActorLocation());
+		RequestPathToNearest({EPathQueryKind::NearestCover, GetActorLocation()});
 	}
 	MoveAlongPath();
 	
@@ -120,10 +213,10 @@ void AEnemyCharacter::TickIntoCover()
 
 void AEnemyCharacter::TickBack()
 {
-	if (CurrentPath.IsEmpty())
+	if (NeedsNewPath())
 	{
 		GetCharacterMovement()->MaxWalkSpeed = 500.0f;
-		CurrentPath = PathfindingSubsystem->GetSpawnPointPath(GetActorLocation());
+		RequestPathToNearest({EPathQueryKind::SpawnPoint, GetActorLocation()});
 	}
 	MoveAlongPath();
 }
@@ -132,19 +225,20 @@ void AEnemyCharacter::OnSensedPawn(APawn* SensedActor)
 {
 	if (APlayerCharacter* Player = Cast<APlayerCharacter>(SensedActor))
 	{
-		SensedCharacter = Player;
+		SetSensedCharacter(Player);
 		UE_LOG(LogTemp, Display, TEXT("Sensed Player"))
 	}
 }
 
 void AEnemyCharacter::UpdateSight()
 {
-	if (!SensedCharacter) return;
+	const APlayerCharacter* Target = GetSensedCharacter();
+	if (!Target) return;
 	if (PawnSensingComponent)
 	{
-		if (PawnSensingComponent && !PawnSensingComponent->HasLineOfSightTo(SensedCharacter))
+		if (PawnSensingComponent && !PawnSensingComponent->HasLineOfSightTo(Target))
 		{
-			SensedCharacter = nullptr;
+			SetSensedCharacter(nullptr);
 			UE_LOG(LogTemp, Display, TEXT("Lost Player"))
 		}
 	}
@@ -156,91 +250,117 @@ void AEnemyCharacter::UpdateSight()
 // Called every frame
 void AEnemyCharacter::Tick(float DeltaTime)
 {
+	CSV_SCOPED_TIMING_STAT(EnemyAI, EnemyTick);
 	Super::Tick(DeltaTime);
 
+	TickAgent(CurrentState, DeltaTime);
+	ApplyDecision(USubSystemAI::Decide(CurrentState, GetHealthFraction(), SensedCharacter != nullptr, !CurrentPath.IsEmpty(), bLastPathRequestFailed));
+}
+
+void AEnemyCharacter::TickAgent(EEnemyState State, float DeltaTime)
+{
 	UpdateSight();
-	switch(CurrentState)
+	switch(State)
 	{
 	case EEnemyState::Evade:
 		TickEvade();
-		if(!SensedCharacter)
-		{
-			CurrentPath.Empty();
-			CurrentState = EEnemyState::SlipAway;
-		}
-		else
-		{
-			if(HealthComponent->GetCurrentHealthPercentage()<0.4f)
-			{
-				CurrentPath.Empty();
-				CurrentState = EEnemyState::LowHP;
-			}
-		}
 		break;
-		
 	case EEnemyState::SlipAway:
 		TickAway();
-		if(SensedCharacter)
-		{
-			if(HealthComponent->GetCurrentHealthPercentage()==1.0f)
-			{
-				CurrentPath.Empty();
-				CurrentState = EEnemyState::Controlled;
-			}
-			if(HealthComponent->GetCurrentHealthPercentage() >= 0.4f && HealthComponent->GetCurrentHealthPercentage() <= 0.9f)
-			{
-				CurrentPath.Empty();
-				CurrentState = EEnemyState::Evade;
-			}
-			else if(HealthComponent->GetCurrentHealthPercentage()<0.4f)
-			{
-				CurrentPath.Empty();
-				CurrentState = EEnemyState::LowHP;
-			}
-			
-		}
 		break;
-		
 	case EEnemyState::LowHP:
 		TickIntoCover();
-		if(!SensedCharacter)
-		{
-			CurrentPath.Empty();
-			CurrentState = EEnemyState::SlipAway;
-		}
-		else
-		{
-			if(CurrentPath.IsEmpty())
-			{
-				FVector Target=	PathfindingSubsystem->FurthestSplinePoint(SensedCharacter->GetActorLocation());
-				UE_LOG(LogTemp, Warning, TEXT("PointLocation: X = %f, Y = %f, Z = %f"), 
-				Target.X, Target.Y, Target.Z);
-				CurrentPath.Add(Target);
-			}
-		}
-		
 		break;
-		
 	case EEnemyState::Controlled:
 		TickBack();
-		if(!SensedCharacter)
-		{
-			CurrentPath.Empty();
-			CurrentState = EEnemyState::SlipAway;
-		}
-		if(SensedCharacter)
-		{
-			if(HealthComponent->GetCurrentHealthPercentage()<1.0f)
-			{
-				CurrentPath.Empty();
-				CurrentState = EEnemyState::Evade;
-			}
-			
-		}
 		break;
 	}
 }
 
+void AEnemyCharacter::ApplyDecision(const FEnemyAIDecision& Decision)
+{
+	if (Decision.bResetPath)
+	{
+		ResetPath();
+	}
+	SetCurrentState(Decision.NextState);
+
+	const APlayerCharacter* SensedTarget = GetSensedCharacter();
+	if (Decision.bUseSplineFallback && SensedTarget && PathfindingSubsystem)
+	{
+		FVector Target = PathfindingSubsystem->FurthestSplinePoint(SensedTarget->GetActorLocation());
+		UE_LOG(LogTemp, Verbose, TEXT("PointLocation: X = %f, Y = %f, Z = %f"), Target.X, Target.Y, Target.Z);
+		CurrentPath.Add(Target);
+		UpdatePathCursor();
+	}
+}
+
+EEnemyState AEnemyCharacter::GetCurrentState() const
+{
+	return AgentIndex != INDEX_NONE ? AISubsystem->States[AgentIndex] : CurrentState;
+}
+
+void AEnemyCharacter::SetCurrentState(EEnemyState State)
+{
+	if (AgentIndex != INDEX_NONE)
+	{
+		AISubsystem->States[AgentIndex] = State;
+		return;
+	}
+	CurrentState = State;
+}
+
+float AEnemyCharacter::GetHealthFraction() const
+{
+	return HealthComponent ? HealthComponent->GetCurrentHealthPercentage() : 1.0f;
+}
+
+APlayerCharacter* AEnemyCharacter::GetSensedCharacter() const
+{
+	return AgentIndex != INDEX_NONE ? AISubsystem->SensedTargets[AgentIndex] : SensedCharacter;
+}
+
+void AEnemyCharacter::SetSensedCharacter(APlayerCharacter* Target)
+{
+	if (AgentIndex != INDEX_NONE)
+	{
+		AISubsystem->SensedTargets[AgentIndex] = Target;
+		return;
+	}
+	SensedCharacter = Target;
+}
+
+bool AEnemyCharacter::HasLastPathRequestFailed() const
+{
+	return AgentIndex != INDEX_NONE ? AISubsystem->LastPathRequestsFailed[AgentIndex] : bLastPathRequestFailed;
+}
+
+void AEnemyCharacter::SetLastPathRequestFailed(bool bFailed)
+{
+	if (AgentIndex != INDEX_NONE)
+	{
+		AISubsystem->LastPathRequestsFailed[AgentIndex] = bFailed;
+		return;
+	}
+	bLastPathRequestFailed = bFailed;
+}
+
+void AEnemyCharacter::UpdatePathCursor()
+{
+	if (AgentIndex != INDEX_NONE)
+	{
+		AISubsystem->PathCursors[AgentIndex] = CurrentPath.Num();
+	}
+}
+
+void AEnemyCharacter::OnHealthChanged(float HealthPercentage)
+{
+	if (AgentIndex != INDEX_NONE)
+	{
+		AISubsystem->HealthFractions[AgentIndex] = HealthPercentage;
+	}
+}
+
 // Called to bind functionality to input
 void AEnemyCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputComponent)
 {
@@ -6,6 +6,7 @@
 #include "GameFramework/Character.h"
 #include "BaseCharacter.h"
 #include "PlayerCharacter.h"
+#include "AGP/Pathfinding/PathQuery.h"
 
 #include "EnemyCharacter.generated.h"
 
@@ -14,6 +15,10 @@
 class UPawnSensingComponent;
 class APlayerCharacter;
 class UPathfindingSubsystem;
+class USubSystemAI;
+class FDStarLitePlanner;
+enum class EPointType : uint8;
+struct FEnemyAIDecision;
 
 /**
  * An enum to hold the current state of the enemy character.
@@ -44,6 +49,7 @@ public:
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Sensing")
 	float SightRadius=1000.0f;
@@ -54,6 +60,31 @@ protected:
 	 * Will move the character along the CurrentPath or do nothing to the character if the path is empty.
 	 */
 	void MoveAlongPath();
+
+	/**
+	 * Will ask the pathfinding subsystem for a new CurrentPath on a worker thread. Does nothing if a path has already
+	 * been requested and has not arrived yet. The character keeps following its CurrentPath until then.
+	 * @param Query The path to find.
+	 */
+	void RequestPath(const FPathQuery& Query);
+	/**
+	 * Will empty the CurrentPath and cancel any path that has been requested but not arrived yet.
+	 */
+	void ResetPath();
+	/**
+	 * Called by the pathfinding subsystem when the requested path has been found.
+	 */
+	void OnPathComputed(const TArray<FVector>& Path, const FPathContinuation& Continuation);
+	/**
+	 * Will find a new CurrentPath to the nearest node of the query's point type. Uses the incremental planner of the point type when
+	 * bUseIncrementalPlanner is set, otherwise requests the path on a worker thread.
+	 * @param Query An Exit, SpawnPoint or NearestCover query.
+	 */
+	void RequestPathToNearest(const FPathQuery& Query);
+	/**
+	 * @return true if the CurrentPath is empty, or if it came from the ActivePlanner and the graph has changed since.
+	 */
+	bool NeedsNewPath() const;
 	
 	/**
 	 * Logic that controls the enemy character when in the Patrol state.
@@ -91,6 +122,11 @@ protected:
 	 */
 	UPROPERTY()
 	UPathfindingSubsystem* PathfindingSubsystem;
+	/**
+	 * The subsystem that this enemy is registered with, if any.
+	 */
+	UPROPERTY()
+	USubSystemAI* AISubsystem;
 
 	/**
 	 * A pointer to the PawnSensingComponent attached to this enemy character.
@@ -100,7 +136,8 @@ protected:
 
 	/**
 	 * A pointer to a PlayerCharacter that can be seen by this enemy character. If this is nullptr then the enemy cannot
-	 * see any PlayerCharacter.
+	 * see any PlayerCharacter. Only holds it while the enemy isn't registered with the USubSystemAI, so use
+	 * GetSensedCharacter and SetSensedCharacter.
 	 */
 	UPROPERTY()
 	APlayerCharacter* SensedCharacter = nullptr;
@@ -112,8 +149,40 @@ protected:
 	TArray<FVector> CurrentPath;
 
 	/**
-	 * The current state of the enemy character. This determines which logic to use when executing the finite state machine
-	 * found in the tick function of this enemy character.
+	 * The path request that is waiting to be delivered to the CurrentPath. Invalid if there isn't one.
+	 */
+	FPathRequestHandle PathRequest;
+	/**
+	 * The rest of a hierarchical path that is refined into the CurrentPath as the character walks it.
+	 */
+	FPathContinuation PathContinuation;
+	/**
+	 * Whether the last path that was delivered was empty because no path could be found. Only holds it while the enemy
+	 * isn't registered with the USubSystemAI, so use HasLastPathRequestFailed and SetLastPathRequestFailed.
+	 */
+	bool bLastPathRequestFailed = false;
+
+	/**
+	 * If true, the states that head to the nearest node of a point type use an incremental planner, so moving and
+	 * changes to the graph only repair the last path instead of searching again. Each planner keeps two floats per
+	 * node of the graph for as long as the enemy lives, so only turn this on for a few enemies on large graphs.
+	 */
+	UPROPERTY(EditAnywhere, Category = "AI")
+	bool bUseIncrementalPlanner = false;
+	/**
+	 * The incremental planners of this enemy, one for each point type that it has headed to. Kept when the state
+	 * changes, so that coming back to a state repairs its last search instead of starting again.
+	 */
+	TMap<EPointType, TSharedPtr<FDStarLitePlanner, ESPMode::ThreadSafe>> Planners;
+	/**
+	 * The planner that the CurrentPath came from. Reset whenever the path is.
+	 */
+	TSharedPtr<FDStarLitePlanner, ESPMode::ThreadSafe> ActivePlanner;
+
+	/**
+	 * The current state of the enemy character. This determines which logic to use when executing the finite state machine.
+	 * Holds the state that the enemy starts in, and its state for as long as it isn't registered with the USubSystemAI,
+	 * which holds it otherwise. Use GetCurrentState and SetCurrentState.
 	 */
 	UPROPERTY(EditAnywhere)
 	EEnemyState CurrentState = EEnemyState::SlipAway;
@@ -137,13 +206,60 @@ protected:
 	FRotator InitialRotation;
 	bool bIsScanningLeft = true;
 
+	void SetCurrentState(EEnemyState State);
+	void SetSensedCharacter(APlayerCharacter* Target);
+	void SetLastPathRequestFailed(bool bFailed);
+	/**
+	 * Will write the number of points left on the CurrentPath to the USubSystemAI. Called whenever the path changes.
+	 */
+	void UpdatePathCursor();
+	/**
+	 * Bound to the health component, to write the health fraction to the USubSystemAI as it changes.
+	 */
+	void OnHealthChanged(float HealthPercentage);
+
 
 public:	
 
+	/**
+	 * Only ticks if there is no USubSystemAI to update this enemy along with the others. The tick function is
+	 * unregistered when the enemy registers with one.
+	 */
 	virtual void Tick(float DeltaTime) override;
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
+
+	/**
+	 * Will run one frame of the logic of a state: updates the sight of the player, moves along the path and asks for
+	 * new paths. Called by the USubSystemAI in place of Tick, or by Tick when this enemy isn't registered with one.
+	 */
+	void TickAgent(EEnemyState State, float DeltaTime);
+	/**
+	 * Will carry out the decision that the state machine made for this enemy.
+	 */
+	void ApplyDecision(const FEnemyAIDecision& Decision);
+
+	EEnemyState GetCurrentState() const;
+	float GetHealthFraction() const;
+	APlayerCharacter* GetSensedCharacter() const;
+
+	/**
+	 * @return The number of points left on the CurrentPath.
+	 */
+	int32 GetPathCursor() const
+	{
+		return CurrentPath.Num();
+	}
+
+	bool HasLastPathRequestFailed() const;
 	
 private:
+
+	friend class USubSystemAI;
+
+	/**
+	 * The index of this enemy in the USubSystemAI's arrays, or INDEX_NONE if it isn't registered with it.
+	 */
+	int32 AgentIndex = INDEX_NONE;
 	
 	/**
 	 * NOT USED ANYMORE - Was used for TickEvade and TickEngage before we setup the UPawnSensingComponent.
@@ -37,6 +37,7 @@ void UHealthComponent::ApplyDamage(float DamageAmount)
 		OnDeath();
 		CurrentHealth = 0.0f;
 	}
+	OnHealthChanged.Broadcast(GetCurrentHealthPercentage());
 }
 
 void UHealthComponent::ApplyHealing(float HealingAmount)
@@ -47,6 +48,7 @@ void UHealthComponent::ApplyHealing(float HealingAmount)
 	{
 		CurrentHealth = 100.0f;
 	}
+	OnHealthChanged.Broadcast(GetCurrentHealthPercentage());
 }
 
 
@@ -57,6 +59,7 @@ void UHealthComponent::BeginPlay()
 
 	// ...
 	CurrentHealth = MaxHealth;
+	OnHealthChanged.Broadcast(GetCurrentHealthPercentage());
 }
 
 
@@ -6,6 +6,7 @@
 #include "Components/ActorComponent.h"
 #include "HealthComponent.generated.h"
 
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnHealthChanged, float /* HealthPercentage */);
 
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class AGP_API UHealthComponent : public UActorComponent
@@ -22,6 +23,11 @@ public:
 	void ApplyDamage(float DamageAmount);
 	void ApplyHealing(float HealingAmount);
 
+	/**
+	 * Broadcast with the new health percentage whenever the current health is set, damaged or healed.
+	 */
+	FOnHealthChanged OnHealthChanged;
+
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
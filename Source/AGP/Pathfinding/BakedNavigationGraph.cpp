@@ -0,0 +1,380 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "BakedNavigationGraph.h"
+
+#include "NavigationDistanceFields.h"
+#include "NavigationGraph.h"
+#include "NavigationLandmarks.h"
+#include "NavigationNode.h"
+#include "PathfindingStats.h"
+#include "Async/MappedFileHandle.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+FBakedNavigationGraph::~FBakedNavigationGraph()
+{
+	// Unmap the region before closing the file it belongs to.
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+bool FBakedNavigationGraph::Write(const FString& Filename, const FNavigationGraph& Graph, const FNavigationLandmarks* Landmarks,
+	const FNavigationDistanceFields* DistanceFields)
+{
+	if (DistanceFields && DistanceFields->NumNodes != Graph.GetNumNodes())
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("The distance fields were built for another graph and can't be baked to %s."), *Filename)
+		return false;
+	}
+
+	FHeader Header;
+	FMemory::Memzero(Header);
+	Header.Magic = Magic;
+	Header.FormatVersion = FormatVersion;
+	Header.NumNodes = Graph.GetNumNodes();
+	Header.NumEdges = Graph.GetNumEdges();
+	Header.NumLandmarks = Landmarks ? Landmarks->GetNumLandmarks() : 0;
+	Header.NumDistanceFieldTypes = DistanceFields ? static_cast<int32>(EPointType::MAX) : 0;
+
+	TArray64<uint8> Bytes;
+	Bytes.AddZeroed(sizeof(FHeader));
+	auto AddSection = [&Bytes, &Header](ESection Section, const auto& Array)
+	{
+		const int64 Offset = Align(Bytes.Num(), SectionAlignment);
+		const int64 SectionSize = static_cast<int64>(Array.Num()) * sizeof(*Array.GetData());
+		Bytes.SetNumZeroed(Offset + SectionSize);
+		if (SectionSize > 0)
+		{
+			FMemory::Memcpy(Bytes.GetData() + Offset, Array.GetData(), SectionSize);
+		}
+		Header.Sections[static_cast<uint32>(Section)] = {Offset, SectionSize};
+	};
+
+	AddSection(ESection::PositionsX, Graph.PositionsX);
+	AddSection(ESection::PositionsY, Graph.PositionsY);
+	AddSection(ESection::PositionsZ, Graph.PositionsZ);
+	AddSection(ESection::NodeTypes, Graph.NodeTypes);
+	AddSection(ESection::EdgeOffsets, Graph.EdgeOffsets);
+	AddSection(ESection::EdgeTargets, Graph.EdgeTargets);
+	AddSection(ESection::EdgeCosts, Graph.EdgeCosts);
+	AddSection(ESection::ReverseEdgeOffsets, Graph.ReverseEdgeOffsets);
+	AddSection(ESection::ReverseEdgeSources, Graph.ReverseEdgeSources);
+	AddSection(ESection::ReverseEdgeForwardIds, Graph.ReverseEdgeForwardIds);
+	if (Landmarks)
+	{
+		AddSection(ESection::LandmarkNodes, Landmarks->LandmarkNodes);
+		AddSection(ESection::FromLandmarkScales, Landmarks->FromLandmarkScales);
+		AddSection(ESection::ToLandmarkScales, Landmarks->ToLandmarkScales);
+		AddSection(ESection::FromLandmark, Landmarks->FromLandmark);
+		AddSection(ESection::ToLandmark, Landmarks->ToLandmark);
+	}
+	else
+	{
+		AddSection(ESection::LandmarkNodes, TConstArrayView<int32>());
+		AddSection(ESection::FromLandmarkScales, TConstArrayView<float>());
+		AddSection(ESection::ToLandmarkScales, TConstArrayView<float>());
+		AddSection(ESection::FromLandmark, TConstArrayView<uint16>());
+		AddSection(ESection::ToLandmark, TConstArrayView<uint16>());
+	}
+	if (DistanceFields)
+	{
+		AddSection(ESection::DistanceFieldDistances, DistanceFields->Distances);
+		AddSection(ESection::DistanceFieldNextNodes, DistanceFields->NextNodes);
+	}
+	else
+	{
+		AddSection(ESection::DistanceFieldDistances, TConstArrayView<float>());
+		AddSection(ESection::DistanceFieldNextNodes, TConstArrayView<int32>());
+	}
+	Bytes.SetNumZeroed(Align(Bytes.Num(), SectionAlignment));
+	Header.FileSize = Bytes.Num();
+	FMemory::Memcpy(Bytes.GetData(), &Header, sizeof(FHeader));
+
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Filename), true);
+	if (!FFileHelper::SaveArrayToFile(Bytes, *Filename))
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("Failed to write the baked navigation graph to %s."), *Filename)
+		return false;
+	}
+	UE_LOG(LogPathfinding, Display, TEXT("Baked %d nodes, %d edges, %d landmarks and %d distance fields to %s (%.2f MB)."), Header.NumNodes,
+		Header.NumEdges, Header.NumLandmarks, Header.NumDistanceFieldTypes, *Filename, Bytes.Num() / (1024.0 * 1024.0))
+	return true;
+}
+
+FBakedNavigationGraphPtr FBakedNavigationGraph::Load(const FString& Filename)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*Filename))
+	{
+		return nullptr;
+	}
+
+	const TSharedRef<FBakedNavigationGraph, ESPMode::ThreadSafe> BakedGraph(new FBakedNavigationGraph());
+	BakedGraph->MappedFile.Reset(PlatformFile.OpenMapped(*Filename));
+	if (BakedGraph->MappedFile)
+	{
+		BakedGraph->MappedRegion.Reset(BakedGraph->MappedFile->MapRegion(0, BakedGraph->MappedFile->GetFileSize()));
+	}
+	if (BakedGraph->MappedRegion)
+	{
+		BakedGraph->Data = BakedGraph->MappedRegion->GetMappedPtr();
+		BakedGraph->Size = BakedGraph->MappedRegion->GetMappedSize();
+	}
+	else
+	{
+		// Some platforms, and files inside pak files, can't be mapped. One read into one block works just as well.
+		BakedGraph->MappedFile.Reset();
+		if (!FFileHelper::LoadFileToArray(BakedGraph->LoadedData, *Filename))
+		{
+			UE_LOG(LogPathfinding, Warning, TEXT("Failed to read the baked navigation graph %s."), *Filename)
+			return nullptr;
+		}
+		BakedGraph->Data = BakedGraph->LoadedData.GetData();
+		BakedGraph->Size = BakedGraph->LoadedData.Num();
+	}
+
+	if (!BakedGraph->Validate(Filename))
+	{
+		return nullptr;
+	}
+	return BakedGraph;
+}
+
+bool FBakedNavigationGraph::Validate(const FString& Filename) const
+{
+	if (Size < static_cast<int64>(sizeof(FHeader)) || !IsAligned(Data, SectionAlignment))
+	{
+		UE_LOG(LogPathfinding, Warning, TEXT("The baked navigation graph %s is too small to be valid."), *Filename)
+		return false;
+	}
+
+	const FHeader& Header = GetHeader();
+	if (Header.Magic != Magic || Header.FormatVersion != FormatVersion)
+	{
+		UE_LOG(LogPathfinding, Warning, TEXT("The baked navigation graph %s is from another format version or byte order and needs to be baked again."), *Filename)
+		return false;
+	}
+	if (Header.FileSize != Size || Header.NumNodes < 0 || Header.NumEdges < 0 || Header.NumLandmarks < 0
+		|| (Header.NumDistanceFieldTypes != 0 && Header.NumDistanceFieldTypes != static_cast<int32>(EPointType::MAX)))
+	{
+		UE_LOG(LogPathfinding, Warning, TEXT("The baked navigation graph %s has a damaged header."), *Filename)
+		return false;
+	}
+
+	const int64 NumNodes = Header.NumNodes;
+	const int64 NumEdges = Header.NumEdges;
+	const int64 NumLandmarks = Header.NumLandmarks;
+	const int64 NumDistanceFieldTypes = Header.NumDistanceFieldTypes;
+	int64 ExpectedSizes[static_cast<uint32>(ESection::Num)];
+	ExpectedSizes[static_cast<uint32>(ESection::PositionsX)] = NumNodes * sizeof(float);
+	ExpectedSizes[static_cast<uint32>(ESection::PositionsY)] = NumNodes * sizeof(float);
+	ExpectedSizes[static_cast<uint32>(ESection::PositionsZ)] = NumNodes * sizeof(float);
+	ExpectedSizes[static_cast<uint32>(ESection::NodeTypes)] = NumNodes * sizeof(EPointType);
+	ExpectedSizes[static_cast<uint32>(ESection::EdgeOffsets)] = (NumNodes + 1) * sizeof(int32);
+	ExpectedSizes[static_cast<uint32>(ESection::EdgeTargets)] = NumEdges * sizeof(int32);
+	ExpectedSizes[static_cast<uint32>(ESection::EdgeCosts)] = NumEdges * sizeof(float);
+	ExpectedSizes[static_cast<uint32>(ESection::ReverseEdgeOffsets)] = (NumNodes + 1) * sizeof(int32);
+	ExpectedSizes[static_cast<uint32>(ESection::ReverseEdgeSources)] = NumEdges * sizeof(int32);
+	ExpectedSizes[static_cast<uint32>(ESection::ReverseEdgeForwardIds)] = NumEdges * sizeof(int32);
+	ExpectedSizes[static_cast<uint32>(ESection::LandmarkNodes)] = NumLandmarks * sizeof(int32);
+	ExpectedSizes[static_cast<uint32>(ESection::FromLandmarkScales)] = NumLandmarks * sizeof(float);
+	ExpectedSizes[static_cast<uint32>(ESection::ToLandmarkScales)] = NumLandmarks * sizeof(float);
+	ExpectedSizes[static_cast<uint32>(ESection::FromLandmark)] = NumNodes * NumLandmarks * sizeof(uint16);
+	ExpectedSizes[static_cast<uint32>(ESection::ToLandmark)] = NumNodes * NumLandmarks * sizeof(uint16);
+	ExpectedSizes[static_cast<uint32>(ESection::DistanceFieldDistances)] = NumNodes * NumDistanceFieldTypes * sizeof(float);
+	ExpectedSizes[static_cast<uint32>(ESection::DistanceFieldNextNodes)] = NumNodes * NumDistanceFieldTypes * sizeof(int32);
+
+	for (uint32 Section = 0; Section < static_cast<uint32>(ESection::Num); ++Section)
+	{
+		const FSectionEntry& Entry = Header.Sections[Section];
+		if (Entry.Size != ExpectedSizes[Section] || Entry.Offset < static_cast<int64>(sizeof(FHeader))
+			|| Entry.Offset % SectionAlignment != 0 || Entry.Offset > Size - Entry.Size)
+		{
+			UE_LOG(LogPathfinding, Warning, TEXT("The baked navigation graph %s has a damaged section %u."), *Filename, Section)
+			return false;
+		}
+	}
+
+	// The searches index straight into the sections with the ids stored in them, without any bounds checks, so every
+	// id has to be checked here once rather than on every step of every search.
+	auto IsValidOffsets = [NumNodes, NumEdges](TConstArrayView<int32> Offsets)
+	{
+		if (Offsets[0] != 0 || Offsets[NumNodes] != NumEdges) return false;
+		for (int64 NodeId = 0; NodeId < NumNodes; ++NodeId)
+		{
+			if (Offsets[NodeId] > Offsets[NodeId + 1]) return false;
+		}
+		return true;
+	};
+	auto IsValidIds = [](TConstArrayView<int32> Ids, int64 NumIds, bool bAllowNone)
+	{
+		for (const int32 Id : Ids)
+		{
+			if ((Id < 0 || Id >= NumIds) && !(bAllowNone && Id == INDEX_NONE)) return false;
+		}
+		return true;
+	};
+
+	const TConstArrayView<int32> EdgeOffsets = GetSection<int32>(ESection::EdgeOffsets);
+	const TConstArrayView<int32> EdgeTargets = GetSection<int32>(ESection::EdgeTargets);
+	const TConstArrayView<int32> ReverseEdgeOffsets = GetSection<int32>(ESection::ReverseEdgeOffsets);
+	const TConstArrayView<int32> ReverseEdgeSources = GetSection<int32>(ESection::ReverseEdgeSources);
+	const TConstArrayView<int32> ReverseEdgeForwardIds = GetSection<int32>(ESection::ReverseEdgeForwardIds);
+	if (!IsValidOffsets(EdgeOffsets) || !IsValidOffsets(ReverseEdgeOffsets))
+	{
+		UE_LOG(LogPathfinding, Warning, TEXT("The baked navigation graph %s has damaged edge offsets."), *Filename)
+		return false;
+	}
+	if (!IsValidIds(EdgeTargets, NumNodes, false) || !IsValidIds(ReverseEdgeSources, NumNodes, false)
+		|| !IsValidIds(ReverseEdgeForwardIds, NumEdges, false))
+	{
+		UE_LOG(LogPathfinding, Warning, TEXT("The baked navigation graph %s has damaged edges."), *Filename)
+		return false;
+	}
+
+	// Each incoming edge of a node has to be the forward edge that leads into it from its source.
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		for (int32 ReverseEdgeId = ReverseEdgeOffsets[NodeId]; ReverseEdgeId < ReverseEdgeOffsets[NodeId + 1]; ++ReverseEdgeId)
+		{
+			const int32 SourceNode = ReverseEdgeSources[ReverseEdgeId];
+			const int32 ForwardEdgeId = ReverseEdgeForwardIds[ReverseEdgeId];
+			if (EdgeTargets[ForwardEdgeId] != NodeId || ForwardEdgeId < EdgeOffsets[SourceNode] || ForwardEdgeId >= EdgeOffsets[SourceNode + 1])
+			{
+				UE_LOG(LogPathfinding, Warning, TEXT("The baked navigation graph %s has reverse edges that don't match its edges."), *Filename)
+				return false;
+			}
+		}
+	}
+
+	// A negative cost would break every search that stops at the first time it reaches a node, and NaN compares false
+	// with everything, so both would make the searches give wrong paths rather than fail.
+	for (const float EdgeCost : GetSection<float>(ESection::EdgeCosts))
+	{
+		if (!(EdgeCost >= 0.0f))
+		{
+			UE_LOG(LogPathfinding, Warning, TEXT("The baked navigation graph %s has damaged edge costs."), *Filename)
+			return false;
+		}
+	}
+
+	for (const EPointType NodeType : GetSection<EPointType>(ESection::NodeTypes))
+	{
+		if (static_cast<uint8>(NodeType) >= static_cast<uint8>(EPointType::MAX))
+		{
+			UE_LOG(LogPathfinding, Warning, TEXT("The baked navigation graph %s has damaged node types."), *Filename)
+			return false;
+		}
+	}
+
+	if (!IsValidIds(GetSection<int32>(ESection::LandmarkNodes), NumNodes, false))
+	{
+		UE_LOG(LogPathfinding, Warning, TEXT("The baked navigation graph %s has damaged landmarks."), *Filename)
+		return false;
+	}
+	if (!IsValidIds(GetSection<int32>(ESection::DistanceFieldNextNodes), NumNodes, true) || !HasValidDistanceFieldChains())
+	{
+		UE_LOG(LogPathfinding, Warning, TEXT("The baked navigation graph %s has damaged distance fields."), *Filename)
+		return false;
+	}
+	return true;
+}
+
+bool FBakedNavigationGraph::HasValidDistanceFieldChains() const
+{
+	const int32 NumNodes = GetNumNodes();
+	const TConstArrayView<EPointType> NodeTypes = GetSection<EPointType>(ESection::NodeTypes);
+	const TConstArrayView<float> Distances = GetSection<float>(ESection::DistanceFieldDistances);
+	const TConstArrayView<int32> NextNodes = GetSection<int32>(ESection::DistanceFieldNextNodes);
+
+	enum class EChainState : uint8
+	{
+		Unvisited,
+		OnWalk,
+		Ends
+	};
+	TArray<EChainState> ChainStates;
+	TArray<int32> Walk;
+	for (int32 PointType = 0; PointType < GetHeader().NumDistanceFieldTypes; ++PointType)
+	{
+		const float* FieldDistances = Distances.GetData() + static_cast<int64>(PointType) * NumNodes;
+		const int32* FieldNextNodes = NextNodes.GetData() + static_cast<int64>(PointType) * NumNodes;
+
+		// Every node has to either be unreachable, be a node of the point type itself, or step to a node that is no
+		// further from the nearest one.
+		for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+		{
+			const float Distance = FieldDistances[NodeId];
+			const int32 NextNode = FieldNextNodes[NodeId];
+			if (!(Distance >= 0.0f))
+			{
+				return false;
+			}
+			if (NextNode == INDEX_NONE)
+			{
+				if (Distance != UE_MAX_FLT) return false;
+			}
+			else if (NextNode == NodeId)
+			{
+				if (Distance != 0.0f || static_cast<int32>(NodeTypes[NodeId]) != PointType) return false;
+			}
+			else if (FieldNextNodes[NextNode] == INDEX_NONE || FieldDistances[NextNode] > Distance)
+			{
+				return false;
+			}
+		}
+
+		// Zero cost edges let neighbours have the same distance, so the distances alone can't rule out a loop. Walk every
+		// chain once, and fail if a walk comes back to a node that it has already passed.
+		ChainStates.Init(EChainState::Unvisited, NumNodes);
+		for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+		{
+			Walk.Reset();
+			int32 CurrentNode = NodeId;
+			while (CurrentNode != INDEX_NONE && ChainStates[CurrentNode] == EChainState::Unvisited)
+			{
+				ChainStates[CurrentNode] = EChainState::OnWalk;
+				Walk.Add(CurrentNode);
+				CurrentNode = FieldNextNodes[CurrentNode] == CurrentNode ? INDEX_NONE : FieldNextNodes[CurrentNode];
+			}
+			if (CurrentNode != INDEX_NONE && ChainStates[CurrentNode] == EChainState::OnWalk)
+			{
+				return false;
+			}
+			for (const int32 WalkedNode : Walk)
+			{
+				ChainStates[WalkedNode] = EChainState::Ends;
+			}
+		}
+	}
+	return true;
+}
+
+FString FBakedNavigationGraph::GetFilename(const UWorld& World)
+{
+	return FPaths::ProjectContentDir() / TEXT("NavigationGraphs") / UWorld::RemovePIEPrefix(World.GetMapName()) + TEXT(".agpnav");
+}
+
+int32 FBakedNavigationGraph::GetNumNodes() const
+{
+	return GetHeader().NumNodes;
+}
+
+int32 FBakedNavigationGraph::GetNumEdges() const
+{
+	return GetHeader().NumEdges;
+}
+
+int32 FBakedNavigationGraph::GetNumLandmarks() const
+{
+	return GetHeader().NumLandmarks;
+}
+
+bool FBakedNavigationGraph::HasDistanceFields() const
+{
+	return GetHeader().NumDistanceFieldTypes > 0;
+}
@@ -0,0 +1,171 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FNavigationDistanceFields;
+class FNavigationGraph;
+class FNavigationLandmarks;
+class IMappedFileHandle;
+class IMappedFileRegion;
+class UWorld;
+
+/**
+ * A navigation graph, and optionally its landmark tables and distance fields, baked into one binary file so that the
+ * world doesn't need to walk the navigation node actors and rebuild everything when it begins play.
+ *
+ * The file starts with a header followed by a table of sections, one for each array of the graph, the landmarks and
+ * the distance fields.
+ * Each section is stored exactly as it is laid out in memory and is found by its byte offset from the start of the
+ * file, aligned to SectionAlignment, so the file can be memory mapped and its arrays used in place without any parsing
+ * or per-node allocations. The file is written in the byte order of the machine that baked it and is rejected by a
+ * machine with the other byte order, as its magic number reads backwards there.
+ */
+class AGP_API FBakedNavigationGraph
+{
+public:
+
+	/**
+	 * The arrays stored in the file, in the order of the section table.
+	 */
+	enum class ESection : uint32
+	{
+		PositionsX,
+		PositionsY,
+		PositionsZ,
+		NodeTypes,
+		EdgeOffsets,
+		EdgeTargets,
+		EdgeCosts,
+		ReverseEdgeOffsets,
+		ReverseEdgeSources,
+		ReverseEdgeForwardIds,
+		LandmarkNodes,
+		FromLandmarkScales,
+		ToLandmarkScales,
+		FromLandmark,
+		ToLandmark,
+		DistanceFieldDistances,
+		DistanceFieldNextNodes,
+		Num
+	};
+
+	// "AGPN" when read as bytes.
+	static constexpr uint32 Magic = 0x4E504741;
+	// Bump whenever the layout of the header or of any section changes, so that old files are rebaked.
+	static constexpr uint32 FormatVersion = 2;
+	static constexpr int64 SectionAlignment = 16;
+
+	~FBakedNavigationGraph();
+
+	/**
+	 * Will write the graph, the landmarks and the distance fields to a file.
+	 * @param Filename The file to write. Any existing file is replaced.
+	 * @param Graph The graph to write.
+	 * @param Landmarks The landmarks built for the graph, or nullptr to leave them out.
+	 * @param DistanceFields The distance fields built for the graph, or nullptr to leave them out.
+	 * @return true if the file was written.
+	 */
+	static bool Write(const FString& Filename, const FNavigationGraph& Graph, const FNavigationLandmarks* Landmarks,
+		const FNavigationDistanceFields* DistanceFields);
+
+	/**
+	 * Will memory map a baked file, or read it into one block of memory on platforms that can't map files, and check
+	 * that its header and section table match this build.
+	 * @return The baked graph, or nullptr if the file is missing, from another format version or damaged.
+	 */
+	static TSharedPtr<const FBakedNavigationGraph, ESPMode::ThreadSafe> Load(const FString& Filename);
+
+	/**
+	 * @return The file that the navigation graph of the map is baked to. Kept in its own content folder that is
+	 * staged as loose files, as files inside a pak file can't be memory mapped.
+	 */
+	static FString GetFilename(const UWorld& World);
+
+	int32 GetNumNodes() const;
+	int32 GetNumEdges() const;
+	int32 GetNumLandmarks() const;
+
+	/**
+	 * @return true if the distance fields were baked along with the graph.
+	 */
+	bool HasDistanceFields() const;
+
+	/**
+	 * @return The size in bytes of the whole file.
+	 */
+	int64 GetSize() const
+	{
+		return Size;
+	}
+
+	/**
+	 * @return true if the file is memory mapped rather than read into memory.
+	 */
+	bool IsMapped() const
+	{
+		return MappedRegion.IsValid();
+	}
+
+	/**
+	 * @return The array stored in a section. Only valid while this baked graph is alive.
+	 */
+	template <typename T>
+	TConstArrayView<T> GetSection(ESection Section) const
+	{
+		const FSectionEntry& Entry = GetHeader().Sections[static_cast<uint32>(Section)];
+		return TConstArrayView<T>(reinterpret_cast<const T*>(Data + Entry.Offset), static_cast<int32>(Entry.Size / sizeof(T)));
+	}
+
+private:
+
+	struct FSectionEntry
+	{
+		// The byte offset of the section from the start of the file.
+		int64 Offset;
+		// The size of the section in bytes.
+		int64 Size;
+	};
+
+	struct FHeader
+	{
+		uint32 Magic;
+		uint32 FormatVersion;
+		int32 NumNodes;
+		int32 NumEdges;
+		int32 NumLandmarks;
+		// Either 0 when the distance fields weren't baked, or one for each EPointType.
+		int32 NumDistanceFieldTypes;
+		int64 FileSize;
+		FSectionEntry Sections[static_cast<uint32>(ESection::Num)];
+	};
+
+	FBakedNavigationGraph() = default;
+
+	const FHeader& GetHeader() const
+	{
+		return *reinterpret_cast<const FHeader*>(Data);
+	}
+
+	/**
+	 * @return true if the header and every section fit the file and have the sizes that the node, edge and landmark
+	 * counts call for, and every offset and node or edge id stored in the sections is in range.
+	 */
+	bool Validate(const FString& Filename) const;
+	/**
+	 * @return true if walking the next nodes of the distance fields from any node ends at a node of the field's point
+	 * type or at a node that can't reach one, without looping. FindPath trusts every chain to end.
+	 */
+	bool HasValidDistanceFieldChains() const;
+
+	// The file and the region of it that is mapped, when the file is memory mapped.
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	// The file contents when it couldn't be memory mapped.
+	TArray64<uint8> LoadedData;
+	const uint8* Data = nullptr;
+	int64 Size = 0;
+};
+
+typedef TSharedPtr<const FBakedNavigationGraph, ESPMode::ThreadSafe> FBakedNavigationGraphPtr;
@@ -0,0 +1,447 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ContractionHierarchy.h"
+
+#include "NavigationGraph.h"
+#include "NavigationOpenSet.h"
+#include "NavigationSearchWorkspace.h"
+#include "Algo/Reverse.h"
+
+namespace
+{
+	// The witness searches give up after settling this many nodes and add the shortcut anyway. A few unneeded
+	// shortcuts don't change any answers, they only make the queries a little slower.
+	constexpr int32 MaxWitnessSettledNodes = 500;
+
+	struct FBuildEdge
+	{
+		int32 NodeId;
+		float Cost;
+		int32 MiddleNode;
+	};
+
+	/**
+	 * The graph while it is being contracted, with the outgoing and incoming edges of every node, shortcuts included.
+	 */
+	class FContractionBuilder
+	{
+	public:
+
+		FContractionBuilder(const FNavigationGraph& Graph, FNavigationSearchWorkspace& InWorkspace)
+			: Workspace(InWorkspace)
+		{
+			NumNodes = Graph.GetNumNodes();
+			OutEdges.SetNum(NumNodes);
+			InEdges.SetNum(NumNodes);
+			bContracted.Init(false, NumNodes);
+			ContractedNeighbours.Init(0, NumNodes);
+			for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+			{
+				for (int32 EdgeId = Graph.GetEdgeBegin(NodeId); EdgeId < Graph.GetEdgeEnd(NodeId); ++EdgeId)
+				{
+					if (Graph.IsEdgeBlocked(EdgeId)) continue;
+					AddOrImproveEdge(NodeId, Graph.GetEdgeTarget(EdgeId), Graph.GetEdgeCost(EdgeId), INDEX_NONE);
+				}
+			}
+		}
+
+		/**
+		 * Nodes that would add few shortcuts compared to the edges they remove, and that don't have many contracted
+		 * neighbours already, are contracted first. That keeps the number of shortcuts down and the hierarchy even.
+		 */
+		int32 GetPriority(int32 NodeId)
+		{
+			int32 NumRemovedEdges = 0;
+			for (const FBuildEdge& Edge : OutEdges[NodeId])
+			{
+				NumRemovedEdges += bContracted[Edge.NodeId] ? 0 : 1;
+			}
+			for (const FBuildEdge& Edge : InEdges[NodeId])
+			{
+				NumRemovedEdges += bContracted[Edge.NodeId] ? 0 : 1;
+			}
+			return ContractNode(NodeId, true) - NumRemovedEdges + ContractedNeighbours[NodeId];
+		}
+
+		/**
+		 * Will add a shortcut between every pair of neighbours whose shortest path goes through the node.
+		 * @param bSimulate If true, only counts the shortcuts without adding them or contracting the node.
+		 * @return The number of shortcuts.
+		 */
+		int32 ContractNode(int32 NodeId, bool bSimulate)
+		{
+			int32 NumNewShortcuts = 0;
+			// Shortcuts are only ever added between the neighbours, so the edges of this node don't change in the loop.
+			for (const FBuildEdge& InEdge : InEdges[NodeId])
+			{
+				if (bContracted[InEdge.NodeId]) continue;
+
+				// Zero cost edges are valid, between nodes in the same place, so a MaxCost of zero still needs a search.
+				float MaxCost = 0.0f;
+				bool bHasOutEdges = false;
+				for (const FBuildEdge& OutEdge : OutEdges[NodeId])
+				{
+					if (bContracted[OutEdge.NodeId] || OutEdge.NodeId == InEdge.NodeId) continue;
+					MaxCost = FMath::Max(MaxCost, InEdge.Cost + OutEdge.Cost);
+					bHasOutEdges = true;
+				}
+				if (!bHasOutEdges)
+				{
+					continue;
+				}
+
+				WitnessSearch(InEdge.NodeId, NodeId, MaxCost);
+				for (const FBuildEdge& OutEdge : OutEdges[NodeId])
+				{
+					if (bContracted[OutEdge.NodeId] || OutEdge.NodeId == InEdge.NodeId) continue;
+
+					// A shortcut is only needed if there is no other path that is at least as short.
+					const float ShortcutCost = InEdge.Cost + OutEdge.Cost;
+					if (Workspace.GetGScore(OutEdge.NodeId) > ShortcutCost)
+					{
+						++NumNewShortcuts;
+						if (!bSimulate)
+						{
+							AddOrImproveEdge(InEdge.NodeId, OutEdge.NodeId, ShortcutCost, NodeId);
+						}
+					}
+				}
+			}
+
+			if (!bSimulate)
+			{
+				bContracted[NodeId] = true;
+				for (const FBuildEdge& Edge : OutEdges[NodeId])
+				{
+					++ContractedNeighbours[Edge.NodeId];
+				}
+				for (const FBuildEdge& Edge : InEdges[NodeId])
+				{
+					++ContractedNeighbours[Edge.NodeId];
+				}
+			}
+			return NumNewShortcuts;
+		}
+
+		int32 NumNodes = 0;
+		TArray<TArray<FBuildEdge>> OutEdges;
+		TArray<TArray<FBuildEdge>> InEdges;
+
+	private:
+
+		/**
+		 * Will run a Dijkstra search from the SourceNode over the nodes that haven't been contracted, apart from the
+		 * ExcludedNode, until the MaxCost is reached. The distances found are left in the workspace.
+		 */
+		void WitnessSearch(int32 SourceNode, int32 ExcludedNode, float MaxCost)
+		{
+			Workspace.BeginSearch(NumNodes);
+			FNavigationOpenSet& OpenSet = Workspace.GetOpenSet();
+			Workspace.Visit(SourceNode, 0.0f);
+			Workspace.SetGScore(SourceNode, 0.0f);
+			OpenSet.Push(SourceNode, 0.0f);
+
+			while (!OpenSet.IsEmpty() && OpenSet.TopKey() <= MaxCost && Workspace.GetNumExpanded() < MaxWitnessSettledNodes)
+			{
+				const int32 CurrentNode = Workspace.ExpandNext();
+				const float CurrentGScore = Workspace.GetGScore(CurrentNode);
+				for (const FBuildEdge& Edge : OutEdges[CurrentNode])
+				{
+					if (bContracted[Edge.NodeId] || Edge.NodeId == ExcludedNode) continue;
+					const float TentativeGScore = CurrentGScore + Edge.Cost;
+					if (!Workspace.IsVisited(Edge.NodeId))
+					{
+						Workspace.Visit(Edge.NodeId, 0.0f);
+					}
+					if (TentativeGScore < Workspace.GetGScore(Edge.NodeId))
+					{
+						Workspace.SetGScore(Edge.NodeId, TentativeGScore);
+						OpenSet.Push(Edge.NodeId, TentativeGScore);
+					}
+				}
+			}
+		}
+
+		void AddOrImproveEdge(int32 FromNode, int32 ToNode, float Cost, int32 MiddleNode)
+		{
+			for (FBuildEdge& Edge : OutEdges[FromNode])
+			{
+				if (Edge.NodeId == ToNode)
+				{
+					if (Cost < Edge.Cost)
+					{
+						Edge.Cost = Cost;
+						Edge.MiddleNode = MiddleNode;
+						for (FBuildEdge& ReverseEdge : InEdges[ToNode])
+						{
+							if (ReverseEdge.NodeId == FromNode)
+							{
+								ReverseEdge.Cost = Cost;
+								ReverseEdge.MiddleNode = MiddleNode;
+							}
+						}
+					}
+					return;
+				}
+			}
+			OutEdges[FromNode].Add({ToNode, Cost, MiddleNode});
+			InEdges[ToNode].Add({FromNode, Cost, MiddleNode});
+		}
+
+		FNavigationSearchWorkspace& Workspace;
+		TArray<bool> bContracted;
+		TArray<int32> ContractedNeighbours;
+	};
+}
+
+void FContractionHierarchy::Build(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace)
+{
+	const int32 NumNodes = Graph.GetNumNodes();
+	GraphVersion = Graph.GetVersion();
+	NumShortcuts = 0;
+	Ranks.Init(INDEX_NONE, NumNodes);
+
+	FContractionBuilder Builder(Graph, Workspace);
+
+	// Contract the nodes in order of priority. Priorities go stale as the neighbours of a node are contracted, so each
+	// node's priority is recomputed when it reaches the top and it is put back if it is no longer the lowest.
+	FNavigationOpenSet Queue;
+	Queue.Reset(NumNodes);
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		Queue.Push(NodeId, static_cast<float>(Builder.GetPriority(NodeId)));
+	}
+
+	int32 NextRank = 0;
+	while (!Queue.IsEmpty())
+	{
+		const int32 NodeId = Queue.Pop();
+		const float Priority = static_cast<float>(Builder.GetPriority(NodeId));
+		if (!Queue.IsEmpty() && Priority > Queue.TopKey())
+		{
+			Queue.Push(NodeId, Priority);
+			continue;
+		}
+
+		Ranks[NodeId] = NextRank++;
+		NumShortcuts += Builder.ContractNode(NodeId, false);
+	}
+
+	// Every edge goes from a lower to a higher ranked node or the other way around. Split them into the upward edges
+	// of their source and the downward edges of their target.
+	UpEdgeOffsets.Init(0, NumNodes + 1);
+	DownEdgeOffsets.Init(0, NumNodes + 1);
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		for (const FBuildEdge& Edge : Builder.OutEdges[NodeId])
+		{
+			if (Ranks[NodeId] < Ranks[Edge.NodeId])
+			{
+				++UpEdgeOffsets[NodeId + 1];
+			}
+			else
+			{
+				++DownEdgeOffsets[Edge.NodeId + 1];
+			}
+		}
+	}
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		UpEdgeOffsets[NodeId + 1] += UpEdgeOffsets[NodeId];
+		DownEdgeOffsets[NodeId + 1] += DownEdgeOffsets[NodeId];
+	}
+
+	UpEdgeTargets.SetNumUninitialized(UpEdgeOffsets[NumNodes]);
+	UpEdgeCosts.SetNumUninitialized(UpEdgeOffsets[NumNodes]);
+	UpEdgeMiddles.SetNumUninitialized(UpEdgeOffsets[NumNodes]);
+	DownEdgeSources.SetNumUninitialized(DownEdgeOffsets[NumNodes]);
+	DownEdgeCosts.SetNumUninitialized(DownEdgeOffsets[NumNodes]);
+	DownEdgeMiddles.SetNumUninitialized(DownEdgeOffsets[NumNodes]);
+	TArray<int32> NextUpEdge(UpEdgeOffsets.GetData(), NumNodes);
+	TArray<int32> NextDownEdge(DownEdgeOffsets.GetData(), NumNodes);
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		for (const FBuildEdge& Edge : Builder.OutEdges[NodeId])
+		{
+			if (Ranks[NodeId] < Ranks[Edge.NodeId])
+			{
+				const int32 EdgeId = NextUpEdge[NodeId]++;
+				UpEdgeTargets[EdgeId] = Edge.NodeId;
+				UpEdgeCosts[EdgeId] = Edge.Cost;
+				UpEdgeMiddles[EdgeId] = Edge.MiddleNode;
+			}
+			else
+			{
+				const int32 EdgeId = NextDownEdge[Edge.NodeId]++;
+				DownEdgeSources[EdgeId] = NodeId;
+				DownEdgeCosts[EdgeId] = Edge.Cost;
+				DownEdgeMiddles[EdgeId] = Edge.MiddleNode;
+			}
+		}
+	}
+}
+
+SIZE_T FContractionHierarchy::GetAllocatedSize() const
+{
+	return Ranks.GetAllocatedSize()
+		+ UpEdgeOffsets.GetAllocatedSize() + UpEdgeTargets.GetAllocatedSize() + UpEdgeCosts.GetAllocatedSize() + UpEdgeMiddles.GetAllocatedSize()
+		+ DownEdgeOffsets.GetAllocatedSize() + DownEdgeSources.GetAllocatedSize() + DownEdgeCosts.GetAllocatedSize() + DownEdgeMiddles.GetAllocatedSize();
+}
+
+bool FContractionHierarchy::FindPath(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath) const
+{
+	OutPath.Reset();
+	if (!Ranks.IsValidIndex(StartNode) || !Ranks.IsValidIndex(EndNode))
+	{
+		return false;
+	}
+
+	FNavigationSearchWorkspace& ForwardWorkspace = Workspace;
+	FNavigationSearchWorkspace& BackwardWorkspace = Workspace.GetReverseWorkspace();
+	const auto BeginSearch = [this](FNavigationSearchWorkspace& SearchWorkspace, int32 SourceNode)
+	{
+		SearchWorkspace.BeginSearch(Ranks.Num());
+		SearchWorkspace.Visit(SourceNode, 0.0f);
+		SearchWorkspace.SetGScore(SourceNode, 0.0f);
+		SearchWorkspace.GetOpenSet().Push(SourceNode, 0.0f);
+	};
+	BeginSearch(ForwardWorkspace, StartNode);
+	BeginSearch(BackwardWorkspace, EndNode);
+
+	const auto Relax = [](FNavigationSearchWorkspace& SearchWorkspace, int32 CurrentNode, int32 ConnectedNode, float TentativeGScore)
+	{
+		if (!SearchWorkspace.IsVisited(ConnectedNode))
+		{
+			SearchWorkspace.Visit(ConnectedNode, 0.0f);
+		}
+		if (TentativeGScore < SearchWorkspace.GetGScore(ConnectedNode))
+		{
+			SearchWorkspace.SetCameFrom(ConnectedNode, CurrentNode);
+			SearchWorkspace.SetGScore(ConnectedNode, TentativeGScore);
+			SearchWorkspace.GetOpenSet().Push(ConnectedNode, TentativeGScore);
+		}
+	};
+
+	// Take turns expanding the two searches. Each one stops once it can't find a shorter path than the best one so far.
+	float BestCost = UE_MAX_FLT;
+	int32 MeetingNode = INDEX_NONE;
+	bool bForwardTurn = true;
+	while (true)
+	{
+		const bool bForwardDone = ForwardWorkspace.GetOpenSet().IsEmpty() || ForwardWorkspace.GetOpenSet().TopKey() >= BestCost;
+		const bool bBackwardDone = BackwardWorkspace.GetOpenSet().IsEmpty() || BackwardWorkspace.GetOpenSet().TopKey() >= BestCost;
+		if (bForwardDone && bBackwardDone)
+		{
+			break;
+		}
+		const bool bForward = bBackwardDone || (!bForwardDone && bForwardTurn);
+		bForwardTurn = !bForwardTurn;
+
+		FNavigationSearchWorkspace& SearchWorkspace = bForward ? ForwardWorkspace : BackwardWorkspace;
+		const FNavigationSearchWorkspace& OtherWorkspace = bForward ? BackwardWorkspace : ForwardWorkspace;
+		const int32 CurrentNode = SearchWorkspace.ExpandNext();
+		const float CurrentGScore = SearchWorkspace.GetGScore(CurrentNode);
+
+		if (OtherWorkspace.IsVisited(CurrentNode) && CurrentGScore + OtherWorkspace.GetGScore(CurrentNode) < BestCost)
+		{
+			BestCost = CurrentGScore + OtherWorkspace.GetGScore(CurrentNode);
+			MeetingNode = CurrentNode;
+		}
+
+		if (bForward)
+		{
+			for (int32 EdgeId = UpEdgeOffsets[CurrentNode]; EdgeId < UpEdgeOffsets[CurrentNode + 1]; ++EdgeId)
+			{
+				Relax(SearchWorkspace, CurrentNode, UpEdgeTargets[EdgeId], CurrentGScore + UpEdgeCosts[EdgeId]);
+			}
+		}
+		else
+		{
+			for (int32 EdgeId = DownEdgeOffsets[CurrentNode]; EdgeId < DownEdgeOffsets[CurrentNode + 1]; ++EdgeId)
+			{
+				Relax(SearchWorkspace, CurrentNode, DownEdgeSources[EdgeId], CurrentGScore + DownEdgeCosts[EdgeId]);
+			}
+		}
+	}
+
+	if (MeetingNode == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// The path in the hierarchy runs up from the start to the meeting node and then down to the end.
+	TArray<int32> HierarchyNodes;
+	for (int32 NodeId = MeetingNode; NodeId != INDEX_NONE; NodeId = ForwardWorkspace.GetCameFrom(NodeId))
+	{
+		HierarchyNodes.Add(NodeId);
+	}
+	Algo::Reverse(HierarchyNodes);
+	for (int32 NodeId = BackwardWorkspace.GetCameFrom(MeetingNode); NodeId != INDEX_NONE; NodeId = BackwardWorkspace.GetCameFrom(NodeId))
+	{
+		HierarchyNodes.Add(NodeId);
+	}
+
+	TArray<int32> PathNodes;
+	PathNodes.Add(StartNode);
+	for (int32 Index = 1; Index < HierarchyNodes.Num(); ++Index)
+	{
+		UnpackEdge(HierarchyNodes[Index - 1], HierarchyNodes[Index], PathNodes);
+	}
+
+	// The paths are consumed from the back so they are stored in reverse order.
+	OutPath.Reserve(PathNodes.Num());
+	for (int32 Index = PathNodes.Num() - 1; Index >= 0; --Index)
+	{
+		OutPath.Add(Graph.GetNodeLocation(PathNodes[Index]));
+	}
+	return true;
+}
+
+int32 FContractionHierarchy::GetMiddleNode(int32 FromNode, int32 ToNode) const
+{
+	if (Ranks[FromNode] < Ranks[ToNode])
+	{
+		for (int32 EdgeId = UpEdgeOffsets[FromNode]; EdgeId < UpEdgeOffsets[FromNode + 1]; ++EdgeId)
+		{
+			if (UpEdgeTargets[EdgeId] == ToNode)
+			{
+				return UpEdgeMiddles[EdgeId];
+			}
+		}
+	}
+	else
+	{
+		for (int32 EdgeId = DownEdgeOffsets[ToNode]; EdgeId < DownEdgeOffsets[ToNode + 1]; ++EdgeId)
+		{
+			if (DownEdgeSources[EdgeId] == FromNode)
+			{
+				return DownEdgeMiddles[EdgeId];
+			}
+		}
+	}
+	checkNoEntry();
+	return INDEX_NONE;
+}
+
+void FContractionHierarchy::UnpackEdge(int32 FromNode, int32 ToNode, TArray<int32>& OutNodes) const
+{
+	// A shortcut through M stands for the edges FromNode -> M and M -> ToNode, which may be shortcuts themselves. Use
+	// a stack instead of recursion, pushing the second half first so that the first half is unpacked first.
+	TArray<TPair<int32, int32>, TInlineAllocator<32>> Stack;
+	Stack.Emplace(FromNode, ToNode);
+	while (!Stack.IsEmpty())
+	{
+		const TPair<int32, int32> Edge = Stack.Pop(false);
+		const int32 MiddleNode = GetMiddleNode(Edge.Key, Edge.Value);
+		if (MiddleNode == INDEX_NONE)
+		{
+			OutNodes.Add(Edge.Value);
+		}
+		else
+		{
+			Stack.Emplace(MiddleNode, Edge.Value);
+			Stack.Emplace(Edge.Key, MiddleNode);
+		}
+	}
+}
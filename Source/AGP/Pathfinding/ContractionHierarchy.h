@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FNavigationGraph;
+class FNavigationSearchWorkspace;
+
+/**
+ * A contraction hierarchy over a static FNavigationGraph. When it is built every node is given a rank and the nodes
+ * are contracted from the least to the most important, adding a shortcut edge wherever removing a node would make a
+ * shortest path longer. A query is then two small Dijkstra searches that only ever go up in rank, one forwards from
+ * the start and one backwards from the end, and the shortcuts on the path they meet on are unpacked back into the
+ * original nodes. Queries touch a tiny part of the graph but the hierarchy must be rebuilt if the graph changes.
+ */
+class AGP_API FContractionHierarchy
+{
+public:
+
+	/**
+	 * Will order and contract every node of the graph.
+	 * @param Graph The graph to build the hierarchy for.
+	 * @param Workspace The scratch memory for the witness searches.
+	 */
+	void Build(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace);
+
+	/**
+	 * @return The version of the graph that the hierarchy was built from.
+	 */
+	uint32 GetGraphVersion() const
+	{
+		return GraphVersion;
+	}
+
+	int32 GetNumShortcuts() const
+	{
+		return NumShortcuts;
+	}
+
+	/**
+	 * @return The number of bytes used by the hierarchy.
+	 */
+	SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * Will find the shortest path between two nodes with a bidirectional upward search.
+	 * @param Graph The graph that the hierarchy was built from.
+	 * @param Workspace The scratch memory for the search. Its reverse workspace is used for the backward search.
+	 * @param StartNode The node id that the path will start at.
+	 * @param EndNode The node id that the path will end at.
+	 * @param OutPath Will be filled with the node locations along the path, in reverse order. Empty if there is no path.
+	 * @return true if a path was found.
+	 */
+	bool FindPath(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath) const;
+
+private:
+
+	/**
+	 * @return The node that the edge between two adjacent nodes of the hierarchy is a shortcut through, or INDEX_NONE
+	 * if it is an original edge.
+	 */
+	int32 GetMiddleNode(int32 FromNode, int32 ToNode) const;
+
+	/**
+	 * Will replace the edge between two adjacent nodes of the hierarchy with the original nodes that it stands for,
+	 * adding every node after FromNode, up to and including ToNode, to OutNodes.
+	 */
+	void UnpackEdge(int32 FromNode, int32 ToNode, TArray<int32>& OutNodes) const;
+
+	uint32 GraphVersion = 0;
+	int32 NumShortcuts = 0;
+	TArray<int32> Ranks;
+
+	// The edges from each node to higher ranked nodes, in CSR form. Followed by the forward search.
+	TArray<int32> UpEdgeOffsets;
+	TArray<int32> UpEdgeTargets;
+	TArray<float> UpEdgeCosts;
+	TArray<int32> UpEdgeMiddles;
+
+	// The edges into each node from higher ranked nodes, in CSR form. Followed backwards by the backward search.
+	TArray<int32> DownEdgeOffsets;
+	TArray<int32> DownEdgeSources;
+	TArray<float> DownEdgeCosts;
+	TArray<int32> DownEdgeMiddles;
+};
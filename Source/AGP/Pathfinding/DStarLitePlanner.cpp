@@ -0,0 +1,236 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DStarLitePlanner.h"
+
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+void FDStarLitePlanner::Initialize(const FNavigationGraphPtr& InGraph, TConstArrayView<int32> InGoalNodes)
+{
+	Graph = InGraph;
+	KeyModifier = 0.0f;
+	StartNode = INDEX_NONE;
+	LastStartNode = INDEX_NONE;
+	PendingEdgeChanges.Reset();
+	bHasPendingChanges = false;
+	NumExpanded = 0;
+
+	const int32 NumNodes = Graph ? Graph->GetNumNodes() : 0;
+	GoalNodes.Init(false, NumNodes);
+	GScores.Init(UE_MAX_FLT, NumNodes);
+	RhsScores.Init(UE_MAX_FLT, NumNodes);
+	OpenSet.Reset(NumNodes);
+
+	// The search runs backwards so every goal starts out consistent with a cost of zero and waits to be expanded.
+	for (const int32 GoalNode : InGoalNodes)
+	{
+		if (GoalNodes.IsValidIndex(GoalNode) && !GoalNodes[GoalNode])
+		{
+			GoalNodes[GoalNode] = true;
+			RhsScores[GoalNode] = 0.0f;
+			OpenSet.Push(GoalNode, {0.0f, 0.0f});
+		}
+	}
+}
+
+void FDStarLitePlanner::UpdateGraph(const FNavigationGraphPtr& NewGraph, TConstArrayView<int32> ChangedEdges)
+{
+	if (!Graph || !NewGraph || NewGraph == Graph)
+	{
+		return;
+	}
+
+	// The search state is indexed by node and edge id so it can only be kept if the new graph has the same layout.
+	if (NewGraph->GetNumNodes() != Graph->GetNumNodes() || NewGraph->GetNumEdges() != Graph->GetNumEdges())
+	{
+		TArray<int32> Goals;
+		for (TConstSetBitIterator<> It(GoalNodes); It; ++It)
+		{
+			Goals.Add(It.GetIndex());
+		}
+		Initialize(NewGraph, Goals);
+		bHasPendingChanges = true;
+		return;
+	}
+
+	// Several updates may come in before the next path is asked for, so only the first old cost of an edge is kept.
+	for (const int32 EdgeId : ChangedEdges)
+	{
+		if (EdgeId >= 0 && EdgeId < Graph->GetNumEdges() && !PendingEdgeChanges.Contains(EdgeId))
+		{
+			PendingEdgeChanges.Add(EdgeId, Graph->GetEdgeCost(EdgeId));
+		}
+	}
+	Graph = NewGraph;
+	bHasPendingChanges = true;
+}
+
+bool FDStarLitePlanner::FindPath(int32 InStartNode, TArray<FVector>& OutPath)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FDStarLitePlanner::FindPath);
+	OutPath.Reset();
+	NumExpanded = 0;
+	if (!Graph || !Graph->IsValidNode(InStartNode))
+	{
+		return false;
+	}
+
+	// The keys already in the open set were made with the heuristic to the old start node. Raising the key modifier
+	// by how far the start has moved keeps them lower bounds without having to re-key the whole open set.
+	StartNode = InStartNode;
+	if (LastStartNode != INDEX_NONE && LastStartNode != StartNode)
+	{
+		KeyModifier += Graph->Distance(LastStartNode, StartNode);
+	}
+	LastStartNode = StartNode;
+
+	// Only the sources of the changed edges can have a different cost to the goals through them. The rest is
+	// repaired by the search as those changes spread out.
+	for (const TPair<int32, float>& EdgeChange : PendingEdgeChanges)
+	{
+		const int32 EdgeId = EdgeChange.Key;
+		const int32 EdgeTarget = Graph->GetEdgeTarget(EdgeId);
+		const float NewCost = Graph->GetEdgeCost(EdgeId);
+		if (NewCost == EdgeChange.Value)
+		{
+			continue;
+		}
+
+		// Edges only store their target so find the source from the incoming edges of the target.
+		for (int32 ReverseEdgeId = Graph->GetReverseEdgeBegin(EdgeTarget); ReverseEdgeId < Graph->GetReverseEdgeEnd(EdgeTarget); ++ReverseEdgeId)
+		{
+			if (Graph->GetReverseEdgeForwardId(ReverseEdgeId) == EdgeId)
+			{
+				UpdateNode(Graph->GetReverseEdgeSource(ReverseEdgeId));
+				break;
+			}
+		}
+	}
+	PendingEdgeChanges.Reset();
+	bHasPendingChanges = false;
+
+	ComputeShortestPath();
+	if (RhsScores[StartNode] == UE_MAX_FLT)
+	{
+		return false;
+	}
+
+	// Every node now knows its cost to the goals, so walk down the costs taking the cheapest successor each time.
+	TArray<int32> PathNodes;
+	PathNodes.Add(StartNode);
+	int32 CurrentNode = StartNode;
+	while (!GoalNodes[CurrentNode])
+	{
+		int32 BestNode = INDEX_NONE;
+		float BestCost = UE_MAX_FLT;
+		for (int32 EdgeId = Graph->GetEdgeBegin(CurrentNode); EdgeId < Graph->GetEdgeEnd(CurrentNode); ++EdgeId)
+		{
+			const int32 ConnectedNode = Graph->GetEdgeTarget(EdgeId);
+			const float EdgeCost = Graph->GetEdgeCost(EdgeId);
+			if (GScores[ConnectedNode] == UE_MAX_FLT || Graph->IsEdgeBlocked(EdgeId))
+			{
+				continue;
+			}
+			const float Cost = EdgeCost + GScores[ConnectedNode];
+			if (Cost < BestCost)
+			{
+				BestCost = Cost;
+				BestNode = ConnectedNode;
+			}
+		}
+
+		// A path can never be longer than the number of nodes, so anything longer means the costs have looped.
+		if (BestNode == INDEX_NONE || PathNodes.Num() > Graph->GetNumNodes())
+		{
+			return false;
+		}
+		PathNodes.Add(BestNode);
+		CurrentNode = BestNode;
+	}
+
+	// The paths handed out are in reverse order, from the goal back to the start.
+	OutPath.Reset(PathNodes.Num());
+	for (int32 PathIndex = PathNodes.Num() - 1; PathIndex >= 0; --PathIndex)
+	{
+		OutPath.Add(Graph->GetNodeLocation(PathNodes[PathIndex]));
+	}
+	return true;
+}
+
+FDStarLitePlanner::FKey FDStarLitePlanner::CalculateKey(int32 NodeId) const
+{
+	const float Cost = FMath::Min(GScores[NodeId], RhsScores[NodeId]);
+	if (Cost == UE_MAX_FLT)
+	{
+		return {UE_MAX_FLT, UE_MAX_FLT};
+	}
+	return {Cost + Graph->Distance(StartNode, NodeId) + KeyModifier, Cost};
+}
+
+void FDStarLitePlanner::UpdateNode(int32 NodeId)
+{
+	if (!GoalNodes[NodeId])
+	{
+		RhsScores[NodeId] = GetBestSuccessorCost(NodeId);
+	}
+
+	// Only the nodes whose cost is out of date need to be in the open set.
+	if (GScores[NodeId] != RhsScores[NodeId])
+	{
+		OpenSet.Push(NodeId, CalculateKey(NodeId));
+	}
+	else
+	{
+		OpenSet.Remove(NodeId);
+	}
+}
+
+float FDStarLitePlanner::GetBestSuccessorCost(int32 NodeId) const
+{
+	float BestCost = UE_MAX_FLT;
+	for (int32 EdgeId = Graph->GetEdgeBegin(NodeId); EdgeId < Graph->GetEdgeEnd(NodeId); ++EdgeId)
+	{
+		const float ConnectedCost = GScores[Graph->GetEdgeTarget(EdgeId)];
+		const float EdgeCost = Graph->GetEdgeCost(EdgeId);
+		if (ConnectedCost != UE_MAX_FLT && !Graph->IsEdgeBlocked(EdgeId))
+		{
+			BestCost = FMath::Min(BestCost, EdgeCost + ConnectedCost);
+		}
+	}
+	return BestCost;
+}
+
+void FDStarLitePlanner::ComputeShortestPath()
+{
+	while (!OpenSet.IsEmpty() && (OpenSet.TopKey() < CalculateKey(StartNode) || RhsScores[StartNode] > GScores[StartNode]))
+	{
+		const FKey OldKey = OpenSet.TopKey();
+		const int32 CurrentNode = OpenSet.Pop();
+		++NumExpanded;
+
+		const FKey NewKey = CalculateKey(CurrentNode);
+		if (OldKey < NewKey)
+		{
+			// The key was made before the start moved or the costs changed, so put it back with the key it has now.
+			OpenSet.Push(CurrentNode, NewKey);
+			continue;
+		}
+
+		if (GScores[CurrentNode] > RhsScores[CurrentNode])
+		{
+			// The cost went down so settle it, which can only make its predecessors cheaper.
+			GScores[CurrentNode] = RhsScores[CurrentNode];
+		}
+		else
+		{
+			// The cost went up so start the node again from nothing, along with every predecessor that relied on it.
+			GScores[CurrentNode] = UE_MAX_FLT;
+			UpdateNode(CurrentNode);
+		}
+
+		for (int32 ReverseEdgeId = Graph->GetReverseEdgeBegin(CurrentNode); ReverseEdgeId < Graph->GetReverseEdgeEnd(CurrentNode); ++ReverseEdgeId)
+		{
+			UpdateNode(Graph->GetReverseEdgeSource(ReverseEdgeId));
+		}
+	}
+}
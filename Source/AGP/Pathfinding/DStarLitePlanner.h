@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavigationGraph.h"
+#include "NavigationOpenSet.h"
+
+/**
+ * An incremental planner (D* Lite) for one agent heading to a fixed set of goal nodes. It searches backwards from the
+ * goals and keeps its search state between paths, so when the agent moves or some edge costs change only the part of
+ * the search that the change affects is repaired instead of running a new search from scratch.
+ *
+ * The planner keeps two floats per node of the graph, so give each agent its own planner only while it needs one.
+ */
+class AGP_API FDStarLitePlanner
+{
+public:
+
+	/**
+	 * Will throw away the search state and start planning to the goal nodes on the given graph.
+	 * @param InGraph The graph snapshot to plan on.
+	 * @param InGoalNodes The nodes that a path may end at.
+	 */
+	void Initialize(const FNavigationGraphPtr& InGraph, TConstArrayView<int32> InGoalNodes);
+
+	/**
+	 * Will switch to a new snapshot of the graph. If it has the same nodes and edges as the current one then only the
+	 * ChangedEdges are repaired the next time a path is asked for, otherwise the search starts again.
+	 * @param NewGraph The new graph snapshot.
+	 * @param ChangedEdges The ids of the edges whose costs are different in the new snapshot.
+	 */
+	void UpdateGraph(const FNavigationGraphPtr& NewGraph, TConstArrayView<int32> ChangedEdges);
+
+	/**
+	 * @return true if the graph has changed since the last path was found.
+	 */
+	bool HasPendingChanges() const
+	{
+		return bHasPendingChanges;
+	}
+
+	const FNavigationGraphPtr& GetGraph() const
+	{
+		return Graph;
+	}
+
+	/**
+	 * Will repair the search for the current start node and the graph changes since the last path.
+	 * @param StartNode The node id that the agent is at.
+	 * @param OutPath Will be filled with the node locations along the path, in reverse order. Empty if there is no path.
+	 * @return true if a path was found.
+	 */
+	bool FindPath(int32 StartNode, TArray<FVector>& OutPath);
+
+	/**
+	 * @return The number of nodes that were expanded the last time a path was found.
+	 */
+	int32 GetNumExpanded() const
+	{
+		return NumExpanded;
+	}
+
+private:
+
+	/**
+	 * The D* Lite priority, compared first by K1 and then by K2.
+	 */
+	struct FKey
+	{
+		float K1;
+		float K2;
+
+		bool operator<(const FKey& Other) const
+		{
+			return K1 < Other.K1 || (K1 == Other.K1 && K2 < Other.K2);
+		}
+
+		bool operator<=(const FKey& Other) const
+		{
+			return !(Other < *this);
+		}
+	};
+
+	FKey CalculateKey(int32 NodeId) const;
+	void UpdateNode(int32 NodeId);
+	/**
+	 * @return The cheapest cost to a goal through any of the node's successors.
+	 */
+	float GetBestSuccessorCost(int32 NodeId) const;
+	void ComputeShortestPath();
+
+	FNavigationGraphPtr Graph;
+	TBitArray<> GoalNodes;
+	TArray<float> GScores;
+	TArray<float> RhsScores;
+	TNavigationOpenSet<FKey> OpenSet;
+	// The offset that keeps the keys of the open set valid as the start node moves, instead of re-keying every node.
+	float KeyModifier = 0.0f;
+	int32 StartNode = INDEX_NONE;
+	int32 LastStartNode = INDEX_NONE;
+	// The costs of the changed edges in the snapshot before the pending changes, by edge id.
+	TMap<int32, float> PendingEdgeChanges;
+	bool bHasPendingChanges = false;
+	int32 NumExpanded = 0;
+};
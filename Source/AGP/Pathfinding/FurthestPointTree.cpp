@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FurthestPointTree.h"
+
+#include "Algo/Sort.h"
+
+namespace
+{
+	constexpr int32 MaxLeafItems = 8;
+}
+
+void FFurthestPointTree::Build(TConstArrayView<FVector> Points, TConstArrayView<int32> Ids)
+{
+	check(Points.Num() == Ids.Num());
+	TreeNodes.Reset();
+	ItemIds.Reset();
+	ItemLocations.Reset();
+	if (Points.IsEmpty())
+	{
+		return;
+	}
+
+	TArray<FVector3f> Locations;
+	TArray<int32> Order;
+	Locations.Reserve(Points.Num());
+	Order.Reserve(Points.Num());
+	for (int32 Index = 0; Index < Points.Num(); ++Index)
+	{
+		Locations.Add(FVector3f(Points[Index]));
+		Order.Add(Index);
+	}
+
+	TreeNodes.Reserve(2 * FMath::DivideAndRoundUp(Points.Num(), MaxLeafItems));
+	BuildRecursive(Order, Locations, 0, Order.Num());
+
+	// Store the items in tree order so that a leaf's items are next to each other in memory.
+	ItemIds.Reserve(Order.Num());
+	ItemLocations.Reserve(Order.Num());
+	for (const int32 Index : Order)
+	{
+		ItemIds.Add(Ids[Index]);
+		ItemLocations.Add(Locations[Index]);
+	}
+}
+
+int32 FFurthestPointTree::BuildRecursive(TArray<int32>& Order, const TArray<FVector3f>& Locations, int32 Start, int32 Count)
+{
+	FBox3f Bounds(ForceInit);
+	for (int32 Index = Start; Index < Start + Count; ++Index)
+	{
+		Bounds += Locations[Order[Index]];
+	}
+
+	const int32 TreeNodeIndex = TreeNodes.Add({Bounds.Min, Bounds.Max, INDEX_NONE, INDEX_NONE, Start, Count});
+	if (Count <= MaxLeafItems)
+	{
+		return TreeNodeIndex;
+	}
+
+	// Split the points in half along the longest axis of the box.
+	const FVector3f Size = Bounds.GetSize();
+	const int32 Axis = Size.X >= Size.Y && Size.X >= Size.Z ? 0 : (Size.Y >= Size.Z ? 1 : 2);
+	const int32 HalfCount = Count / 2;
+	Algo::Sort(MakeArrayView(Order.GetData() + Start, Count), [&Locations, Axis](int32 A, int32 B)
+	{
+		return Locations[A][Axis] < Locations[B][Axis];
+	});
+
+	const int32 FirstChild = BuildRecursive(Order, Locations, Start, HalfCount);
+	const int32 SecondChild = BuildRecursive(Order, Locations, Start + HalfCount, Count - HalfCount);
+	TreeNodes[TreeNodeIndex].FirstChild = FirstChild;
+	TreeNodes[TreeNodeIndex].SecondChild = SecondChild;
+	return TreeNodeIndex;
+}
+
+float FFurthestPointTree::MaxDistanceSquared(const FTreeNode& TreeNode, const FVector3f& Location)
+{
+	const float DX = FMath::Max(FMath::Abs(Location.X - TreeNode.Min.X), FMath::Abs(Location.X - TreeNode.Max.X));
+	const float DY = FMath::Max(FMath::Abs(Location.Y - TreeNode.Min.Y), FMath::Abs(Location.Y - TreeNode.Max.Y));
+	const float DZ = FMath::Max(FMath::Abs(Location.Z - TreeNode.Min.Z), FMath::Abs(Location.Z - TreeNode.Max.Z));
+	return DX * DX + DY * DY + DZ * DZ;
+}
+
+int32 FFurthestPointTree::FindFurthest(const FVector& Location) const
+{
+	if (IsEmpty())
+	{
+		return INDEX_NONE;
+	}
+
+	const FVector3f QueryLocation(Location);
+	int32 BestItem = INDEX_NONE;
+	float BestDistanceSquared = -1.0f;
+
+	// Depth first, always going into the child whose box could hold the furthest point first.
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+	while (!Stack.IsEmpty())
+	{
+		const FTreeNode& TreeNode = TreeNodes[Stack.Pop(false)];
+		if (MaxDistanceSquared(TreeNode, QueryLocation) <= BestDistanceSquared)
+		{
+			// Nothing in here can be further away than the best point so far.
+			continue;
+		}
+
+		if (TreeNode.FirstChild == INDEX_NONE)
+		{
+			for (int32 Item = TreeNode.ItemStart; Item < TreeNode.ItemStart + TreeNode.ItemCount; ++Item)
+			{
+				const float DistanceSquared = FVector3f::DistSquared(ItemLocations[Item], QueryLocation);
+				if (DistanceSquared > BestDistanceSquared)
+				{
+					BestDistanceSquared = DistanceSquared;
+					BestItem = Item;
+				}
+			}
+			continue;
+		}
+
+		const int32 FirstChild = TreeNode.FirstChild;
+		const int32 SecondChild = TreeNode.SecondChild;
+		const float FirstBound = MaxDistanceSquared(TreeNodes[FirstChild], QueryLocation);
+		const float SecondBound = MaxDistanceSquared(TreeNodes[SecondChild], QueryLocation);
+		// Push the more promising child last so that it is popped first.
+		if (FirstBound > SecondBound)
+		{
+			Stack.Add(SecondChild);
+			Stack.Add(FirstChild);
+		}
+		else
+		{
+			Stack.Add(FirstChild);
+			Stack.Add(SecondChild);
+		}
+	}
+
+	return ItemIds[BestItem];
+}
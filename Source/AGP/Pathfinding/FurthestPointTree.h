@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * A bounding volume tree over a fixed set of points that finds the point furthest away from a query location. Each
+ * tree node stores the box around its points, and the furthest any point in a box can be from the query is the
+ * distance to the box's furthest corner, so whole subtrees can be skipped once a point further than that is known.
+ * Boxes are visited furthest first, which means most queries only open a handful of leaves.
+ */
+class AGP_API FFurthestPointTree
+{
+public:
+
+	/**
+	 * Will build the tree over the given points. Any previous contents are thrown away.
+	 * @param Points The locations of the points.
+	 * @param Ids The id that will be returned for each point. Must be the same length as Points.
+	 */
+	void Build(TConstArrayView<FVector> Points, TConstArrayView<int32> Ids);
+
+	bool IsEmpty() const
+	{
+		return ItemIds.IsEmpty();
+	}
+
+	/**
+	 * @param Location The location to find the furthest point from.
+	 * @return The id of the point furthest away from the Location or INDEX_NONE if the tree is empty.
+	 */
+	int32 FindFurthest(const FVector& Location) const;
+
+private:
+
+	struct FTreeNode
+	{
+		FVector3f Min;
+		FVector3f Max;
+		// The indices of the two children in the TreeNodes array or INDEX_NONE if this is a leaf.
+		int32 FirstChild;
+		int32 SecondChild;
+		// The range of items in this node.
+		int32 ItemStart;
+		int32 ItemCount;
+	};
+
+	int32 BuildRecursive(TArray<int32>& Order, const TArray<FVector3f>& Locations, int32 Start, int32 Count);
+
+	/**
+	 * @return An upper bound of the squared distance between the Location and any point inside the tree node.
+	 */
+	static float MaxDistanceSquared(const FTreeNode& TreeNode, const FVector3f& Location);
+
+	TArray<FTreeNode> TreeNodes;
+	TArray<int32> ItemIds;
+	TArray<FVector3f> ItemLocations;
+};
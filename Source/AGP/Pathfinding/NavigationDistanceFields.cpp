@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationDistanceFields.h"
+
+#include "BakedNavigationGraph.h"
+#include "NavigationGraph.h"
+#include "NavigationSearch.h"
+#include "NavigationSearchWorkspace.h"
+
+void FNavigationDistanceFields::Build(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace)
+{
+	NumNodes = Graph.GetNumNodes();
+	GraphVersion = Graph.GetVersion();
+	BakedGraph.Reset();
+
+	TArray<int32> PointTypeNodeIds[static_cast<int32>(EPointType::MAX)];
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		PointTypeNodeIds[static_cast<int32>(Graph.GetNodeType(NodeId))].Add(NodeId);
+	}
+
+	constexpr int32 NumPointTypes = static_cast<int32>(EPointType::MAX);
+	Storage.Distances.Init(UE_MAX_FLT, NumPointTypes * NumNodes);
+	Storage.NextNodes.Init(INDEX_NONE, NumPointTypes * NumNodes);
+	for (int32 PointType = 0; PointType < NumPointTypes; ++PointType)
+	{
+		if (PointTypeNodeIds[PointType].IsEmpty()) continue;
+
+		// Searching backwards from every node of the type at once gives each node its distance to the nearest one.
+		float* FieldDistances = Storage.Distances.GetData() + PointType * NumNodes;
+		int32* FieldNextNodes = Storage.NextNodes.GetData() + PointType * NumNodes;
+		FNavigationSearch::Dijkstra(Graph, Workspace, PointTypeNodeIds[PointType], [FieldDistances, FieldNextNodes, &Workspace](int32 NodeId)
+		{
+			FieldDistances[NodeId] = Workspace.GetGScore(NodeId);
+			const int32 NextNode = Workspace.GetCameFrom(NodeId);
+			FieldNextNodes[NodeId] = NextNode == INDEX_NONE ? NodeId : NextNode;
+		}, ENavigationSearchDirection::Reverse);
+	}
+	BindStorage();
+}
+
+void FNavigationDistanceFields::InitFromBaked(const TSharedRef<const FBakedNavigationGraph, ESPMode::ThreadSafe>& InBakedGraph, uint32 InGraphVersion)
+{
+	GraphVersion = InGraphVersion;
+	NumNodes = InBakedGraph->GetNumNodes();
+	Storage = FStorage();
+	BakedGraph = InBakedGraph;
+
+	Distances = InBakedGraph->GetSection<float>(FBakedNavigationGraph::ESection::DistanceFieldDistances);
+	NextNodes = InBakedGraph->GetSection<int32>(FBakedNavigationGraph::ESection::DistanceFieldNextNodes);
+}
+
+void FNavigationDistanceFields::BindStorage()
+{
+	Distances = Storage.Distances;
+	NextNodes = Storage.NextNodes;
+}
+
+int32 FNavigationDistanceFields::GetNearestNode(EPointType PointType, int32 NodeId) const
+{
+	if (NodeId < 0 || NodeId >= NumNodes || GetNextNode(PointType, NodeId) == INDEX_NONE)
+	{
+		return INDEX_NONE;
+	}
+
+	while (GetNextNode(PointType, NodeId) != NodeId)
+	{
+		NodeId = GetNextNode(PointType, NodeId);
+	}
+	return NodeId;
+}
+
+bool FNavigationDistanceFields::FindPath(const FNavigationGraph& Graph, EPointType PointType, int32 StartNode, TArray<FVector>& OutPath) const
+{
+	OutPath.Reset();
+	if (StartNode < 0 || StartNode >= NumNodes || GetNextNode(PointType, StartNode) == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// The path is stored in reverse order so count the steps first and fill it in from the back.
+	int32 PathLength = 1;
+	for (int32 NodeId = StartNode; GetNextNode(PointType, NodeId) != NodeId; NodeId = GetNextNode(PointType, NodeId))
+	{
+		++PathLength;
+	}
+
+	OutPath.SetNumUninitialized(PathLength);
+	int32 PathIndex = PathLength - 1;
+	for (int32 NodeId = StartNode; ; NodeId = GetNextNode(PointType, NodeId))
+	{
+		OutPath[PathIndex--] = Graph.GetNodeLocation(NodeId);
+		if (GetNextNode(PointType, NodeId) == NodeId) break;
+	}
+	return true;
+}
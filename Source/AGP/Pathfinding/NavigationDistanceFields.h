@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavigationNode.h"
+
+class FBakedNavigationGraph;
+class FNavigationGraph;
+class FNavigationSearchWorkspace;
+
+/**
+ * For every EPointType, the path distance from each node of a graph to the nearest node of that type and the next
+ * node to step to on the way there. Built with one reverse multi-source Dijkstra per point type so the path from any
+ * node to its nearest cover, spawn or escape point is just a walk along the next nodes.
+ *
+ * The fields are either built or point straight into a baked navigation graph that was loaded from disk.
+ */
+class AGP_API FNavigationDistanceFields
+{
+public:
+
+	FNavigationDistanceFields() = default;
+	UE_NONCOPYABLE(FNavigationDistanceFields);
+
+	/**
+	 * Will run one reverse Dijkstra per point type that has any nodes in the graph.
+	 * @param Graph The graph to build the fields for.
+	 * @param Workspace The scratch memory for the searches.
+	 */
+	void Build(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace);
+
+	/**
+	 * Will point the fields at the sections of a baked navigation graph, without copying them.
+	 * @param InBakedGraph The baked graph to use the fields of. It is kept alive for as long as the fields are.
+	 * @param InGraphVersion The version of the graph that was loaded from the same baked graph.
+	 */
+	void InitFromBaked(const TSharedRef<const FBakedNavigationGraph, ESPMode::ThreadSafe>& InBakedGraph, uint32 InGraphVersion);
+
+	/**
+	 * @return The version of the graph that the fields were built from.
+	 */
+	uint32 GetGraphVersion() const
+	{
+		return GraphVersion;
+	}
+
+	/**
+	 * @return The path distance from the node to the nearest node of the point type, or UE_MAX_FLT if none can be
+	 * reached.
+	 */
+	float GetDistance(EPointType PointType, int32 NodeId) const
+	{
+		return Distances[GetFieldIndex(PointType, NodeId)];
+	}
+
+	/**
+	 * @return The next node on the shortest path from the node to the nearest node of the point type, the node
+	 * itself if it is of that type, or INDEX_NONE if none can be reached.
+	 */
+	int32 GetNextNode(EPointType PointType, int32 NodeId) const
+	{
+		return NextNodes[GetFieldIndex(PointType, NodeId)];
+	}
+
+	/**
+	 * @return The node of the point type that is nearest to the node by path distance, or INDEX_NONE if none can be
+	 * reached.
+	 */
+	int32 GetNearestNode(EPointType PointType, int32 NodeId) const;
+
+	/**
+	 * Will walk the next nodes from the StartNode to the nearest node of the point type.
+	 * @param Graph The graph that the fields were built from.
+	 * @param PointType The type of node to find a path to.
+	 * @param StartNode The node id that the path starts at.
+	 * @param OutPath Will be filled with the node locations along the path, in reverse order. Empty if there is no path.
+	 * @return true if there is a path.
+	 */
+	bool FindPath(const FNavigationGraph& Graph, EPointType PointType, int32 StartNode, TArray<FVector>& OutPath) const;
+
+private:
+
+	friend class FBakedNavigationGraph;
+
+	/**
+	 * The fields that were built rather than loaded.
+	 */
+	struct FStorage
+	{
+		TArray<float> Distances;
+		TArray<int32> NextNodes;
+	};
+
+	/**
+	 * @return The index of the node in the Distances and NextNodes of the point type.
+	 */
+	int32 GetFieldIndex(EPointType PointType, int32 NodeId) const
+	{
+		return static_cast<int32>(PointType) * NumNodes + NodeId;
+	}
+
+	/**
+	 * Will point the fields at the Storage.
+	 */
+	void BindStorage();
+
+	uint32 GraphVersion = 0;
+	int32 NumNodes = 0;
+	FStorage Storage;
+	// Keeps the memory that the fields point into alive when they were loaded.
+	TSharedPtr<const FBakedNavigationGraph, ESPMode::ThreadSafe> BakedGraph;
+
+	// NumNodes entries for each point type, one point type after another.
+	TConstArrayView<float> Distances;
+	TConstArrayView<int32> NextNodes;
+};
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationGoalSet.h"
+
+#include "NavigationGraph.h"
+#include "NavigationSpatialIndex.h"
+
+void FNavigationGoalSet::AddPointType(EPointType PointType, const TSharedRef<const FNavigationSpatialIndex, ESPMode::ThreadSafe>& SpatialIndex)
+{
+	if (PointTypeMask & GetPointTypeBit(PointType)) return;
+	PointTypeMask |= GetPointTypeBit(PointType);
+	const FNavigationSpatialGrid& PointTypeGrid = SpatialIndex->GetNodeGrid(PointType);
+	if (!PointTypeGrid.IsEmpty())
+	{
+		PointTypeGrids.Add(&PointTypeGrid);
+		SpatialIndices.AddUnique(SpatialIndex);
+	}
+}
+
+void FNavigationGoalSet::SetNodes(const FNavigationGraph& Graph, TConstArrayView<int32> NodeIds)
+{
+	GoalNodes.Init(false, Graph.GetNumNodes());
+	TArray<int32> ValidNodeIds;
+	ValidNodeIds.Reserve(NodeIds.Num());
+	for (const int32 NodeId : NodeIds)
+	{
+		if (Graph.IsValidNode(NodeId) && !GoalNodes[NodeId])
+		{
+			GoalNodes[NodeId] = true;
+			ValidNodeIds.Add(NodeId);
+		}
+	}
+	NodeGrid.Build(Graph, ValidNodeIds);
+}
+
+bool FNavigationGoalSet::IsGoal(const FNavigationGraph& Graph, int32 NodeId) const
+{
+	return (PointTypeMask & GetPointTypeBit(Graph.GetNodeType(NodeId))) != 0
+		|| (GoalNodes.IsValidIndex(NodeId) && GoalNodes[NodeId]);
+}
+
+float FNavigationGoalSet::GetHeuristic(const FNavigationGraph& Graph, int32 NodeId) const
+{
+	// The minimum of the straight line distances to each goal is still a lower bound on the path cost to any of them.
+	const FVector Location = Graph.GetNodeLocation(NodeId);
+	float Heuristic = UE_MAX_FLT;
+	for (const FNavigationSpatialGrid* Grid : PointTypeGrids)
+	{
+		// The grids may be from an older graph with other nodes. Leaving a goal out could overestimate, so fall back
+		// to no heuristic at all.
+		const int32 NearestGoal = Grid->FindNearest(Location);
+		if (!Graph.IsValidNode(NearestGoal))
+		{
+			return 0.0f;
+		}
+		Heuristic = FMath::Min(Heuristic, Graph.Distance(NodeId, NearestGoal));
+	}
+	if (!NodeGrid.IsEmpty())
+	{
+		Heuristic = FMath::Min(Heuristic, Graph.Distance(NodeId, NodeGrid.FindNearest(Location)));
+	}
+	return Heuristic == UE_MAX_FLT ? 0.0f : Heuristic;
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavigationSpatialGrid.h"
+
+class FNavigationGraph;
+class FNavigationSpatialIndex;
+enum class EPointType : uint8;
+
+/**
+ * The set of nodes that a multi-goal search may stop at: every node whose point type is in a bitmask, plus an explicit
+ * list of nodes. Also gives the search its heuristic, the straight line distance to the nearest goal, which never
+ * overestimates the path cost to any of them.
+ */
+class AGP_API FNavigationGoalSet
+{
+public:
+
+	/**
+	 * @return The bit of a point type in a point type mask.
+	 */
+	static uint32 GetPointTypeBit(EPointType PointType)
+	{
+		return 1u << static_cast<uint32>(PointType);
+	}
+
+	/**
+	 * Will make every node of the point type a goal.
+	 * @param PointType The point type to add.
+	 * @param SpatialIndex The spatial indices of the graph, whose grid of the point type is used for the heuristic. It is
+	 * kept alive for as long as this goal set is, so the goal set stays valid after the graph snapshot is replaced.
+	 */
+	void AddPointType(EPointType PointType, const TSharedRef<const FNavigationSpatialIndex, ESPMode::ThreadSafe>& SpatialIndex);
+
+	/**
+	 * Will make each of the given nodes a goal, replacing any nodes set before.
+	 * @param Graph The graph that the node ids belong to.
+	 * @param NodeIds The ids of the goal nodes. Invalid ids are ignored.
+	 */
+	void SetNodes(const FNavigationGraph& Graph, TConstArrayView<int32> NodeIds);
+
+	bool IsEmpty() const
+	{
+		return PointTypeGrids.IsEmpty() && NodeGrid.IsEmpty();
+	}
+
+	bool IsGoal(const FNavigationGraph& Graph, int32 NodeId) const;
+
+	/**
+	 * @return The straight line distance from the node to the nearest goal.
+	 */
+	float GetHeuristic(const FNavigationGraph& Graph, int32 NodeId) const;
+
+private:
+
+	uint32 PointTypeMask = 0;
+	// Point into the SpatialIndices.
+	TArray<const FNavigationSpatialGrid*, TInlineAllocator<4>> PointTypeGrids;
+	TArray<TSharedRef<const FNavigationSpatialIndex, ESPMode::ThreadSafe>, TInlineAllocator<1>> SpatialIndices;
+	// Indexed by node id, set for the explicitly listed goal nodes.
+	TBitArray<> GoalNodes;
+	FNavigationSpatialGrid NodeGrid;
+};
@@ -0,0 +1,150 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationGraph.h"
+
+#include "BakedNavigationGraph.h"
+#include "NavigationNode.h"
+
+FNavigationGraph::FNavigationGraph(const FNavigationGraph& Other)
+{
+	*this = Other;
+}
+
+FNavigationGraph& FNavigationGraph::operator=(const FNavigationGraph& Other)
+{
+	if (this == &Other)
+	{
+		return *this;
+	}
+
+	// The views of everything but the costs point into the shared topology or the baked graph, so they stay valid.
+	Version = Other.Version;
+	LayoutVersion = Other.LayoutVersion;
+	Topology = Other.Topology;
+	BakedGraph = Other.BakedGraph;
+	EdgeCostStorage = Other.EdgeCostStorage;
+	PositionsX = Other.PositionsX;
+	PositionsY = Other.PositionsY;
+	PositionsZ = Other.PositionsZ;
+	NodeTypes = Other.NodeTypes;
+	EdgeOffsets = Other.EdgeOffsets;
+	EdgeTargets = Other.EdgeTargets;
+	EdgeCosts = Other.EdgeCosts.GetData() == Other.EdgeCostStorage.GetData() ? TConstArrayView<float>(EdgeCostStorage) : Other.EdgeCosts;
+	ReverseEdgeOffsets = Other.ReverseEdgeOffsets;
+	ReverseEdgeSources = Other.ReverseEdgeSources;
+	ReverseEdgeForwardIds = Other.ReverseEdgeForwardIds;
+	return *this;
+}
+
+void FNavigationGraph::Build(TConstArrayView<FVector> Locations, TConstArrayView<EPointType> InNodeTypes, TConstArrayView<TArray<int32>> Connections)
+{
+	check(Locations.Num() == InNodeTypes.Num() && Locations.Num() == Connections.Num());
+	const int32 NumNodes = Locations.Num();
+	BakedGraph.Reset();
+	// Copies of this graph may still be using the old topology, so the new one is built separately.
+	const TSharedRef<FTopology, ESPMode::ThreadSafe> NewTopology = MakeShared<FTopology, ESPMode::ThreadSafe>();
+
+	NewTopology->PositionsX.SetNumUninitialized(NumNodes);
+	NewTopology->PositionsY.SetNumUninitialized(NumNodes);
+	NewTopology->PositionsZ.SetNumUninitialized(NumNodes);
+	NewTopology->NodeTypes.Reset(NumNodes);
+	NewTopology->NodeTypes.Append(InNodeTypes.GetData(), NumNodes);
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		const FVector3f Location(Locations[NodeId]);
+		NewTopology->PositionsX[NodeId] = Location.X;
+		NewTopology->PositionsY[NodeId] = Location.Y;
+		NewTopology->PositionsZ[NodeId] = Location.Z;
+	}
+
+	int32 NumEdges = 0;
+	for (const TArray<int32>& NodeConnections : Connections)
+	{
+		NumEdges += NodeConnections.Num();
+	}
+
+	TArray<int32>& OutEdgeOffsets = NewTopology->EdgeOffsets;
+	TArray<int32>& OutEdgeTargets = NewTopology->EdgeTargets;
+	OutEdgeOffsets.SetNumUninitialized(NumNodes + 1);
+	OutEdgeTargets.Reset(NumEdges);
+	EdgeCostStorage.Reset(NumEdges);
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		OutEdgeOffsets[NodeId] = OutEdgeTargets.Num();
+		for (const int32 TargetId : Connections[NodeId])
+		{
+			// Skip anything that isn't a real connection to another node.
+			if (TargetId == NodeId || !NewTopology->NodeTypes.IsValidIndex(TargetId)) continue;
+			bool bDuplicate = false;
+			for (int32 EdgeId = OutEdgeOffsets[NodeId]; EdgeId < OutEdgeTargets.Num(); ++EdgeId)
+			{
+				bDuplicate |= OutEdgeTargets[EdgeId] == TargetId;
+			}
+			if (bDuplicate) continue;
+
+			OutEdgeTargets.Add(TargetId);
+			EdgeCostStorage.Add(static_cast<float>(FVector::Distance(Locations[NodeId], Locations[TargetId])));
+		}
+	}
+	OutEdgeOffsets[NumNodes] = OutEdgeTargets.Num();
+
+	// Bucket the edges by their target to build the reverse CSR: count, prefix sum, then scatter.
+	TArray<int32>& OutReverseEdgeOffsets = NewTopology->ReverseEdgeOffsets;
+	OutReverseEdgeOffsets.SetNumZeroed(NumNodes + 1);
+	for (const int32 TargetId : OutEdgeTargets)
+	{
+		++OutReverseEdgeOffsets[TargetId + 1];
+	}
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		OutReverseEdgeOffsets[NodeId + 1] += OutReverseEdgeOffsets[NodeId];
+	}
+	NewTopology->ReverseEdgeSources.SetNumUninitialized(OutEdgeTargets.Num());
+	NewTopology->ReverseEdgeForwardIds.SetNumUninitialized(OutEdgeTargets.Num());
+	TArray<int32> NextReverseEdge(OutReverseEdgeOffsets.GetData(), NumNodes);
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		for (int32 EdgeId = OutEdgeOffsets[NodeId]; EdgeId < OutEdgeOffsets[NodeId + 1]; ++EdgeId)
+		{
+			const int32 ReverseEdgeId = NextReverseEdge[OutEdgeTargets[EdgeId]]++;
+			NewTopology->ReverseEdgeSources[ReverseEdgeId] = NodeId;
+			NewTopology->ReverseEdgeForwardIds[ReverseEdgeId] = EdgeId;
+		}
+	}
+
+	Topology = NewTopology;
+	BindStorage();
+}
+
+void FNavigationGraph::InitFromBaked(const TSharedRef<const FBakedNavigationGraph, ESPMode::ThreadSafe>& InBakedGraph)
+{
+	Topology.Reset();
+	EdgeCostStorage.Empty();
+	BakedGraph = InBakedGraph;
+
+	PositionsX = InBakedGraph->GetSection<float>(FBakedNavigationGraph::ESection::PositionsX);
+	PositionsY = InBakedGraph->GetSection<float>(FBakedNavigationGraph::ESection::PositionsY);
+	PositionsZ = InBakedGraph->GetSection<float>(FBakedNavigationGraph::ESection::PositionsZ);
+	NodeTypes = InBakedGraph->GetSection<EPointType>(FBakedNavigationGraph::ESection::NodeTypes);
+	EdgeOffsets = InBakedGraph->GetSection<int32>(FBakedNavigationGraph::ESection::EdgeOffsets);
+	EdgeTargets = InBakedGraph->GetSection<int32>(FBakedNavigationGraph::ESection::EdgeTargets);
+	EdgeCosts = InBakedGraph->GetSection<float>(FBakedNavigationGraph::ESection::EdgeCosts);
+	ReverseEdgeOffsets = InBakedGraph->GetSection<int32>(FBakedNavigationGraph::ESection::ReverseEdgeOffsets);
+	ReverseEdgeSources = InBakedGraph->GetSection<int32>(FBakedNavigationGraph::ESection::ReverseEdgeSources);
+	ReverseEdgeForwardIds = InBakedGraph->GetSection<int32>(FBakedNavigationGraph::ESection::ReverseEdgeForwardIds);
+}
+
+void FNavigationGraph::BindStorage()
+{
+	PositionsX = Topology->PositionsX;
+	PositionsY = Topology->PositionsY;
+	PositionsZ = Topology->PositionsZ;
+	NodeTypes = Topology->NodeTypes;
+	EdgeOffsets = Topology->EdgeOffsets;
+	EdgeTargets = Topology->EdgeTargets;
+	EdgeCosts = EdgeCostStorage;
+	ReverseEdgeOffsets = Topology->ReverseEdgeOffsets;
+	ReverseEdgeSources = Topology->ReverseEdgeSources;
+	ReverseEdgeForwardIds = Topology->ReverseEdgeForwardIds;
+}
@@ -0,0 +1,254 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EPointType : uint8;
+class FBakedNavigationGraph;
+
+/**
+ * A flattened, read-only snapshot of the navigation node graph. Nodes are identified by dense int32 ids, positions
+ * are stored as structure of arrays and the connections are stored in compressed sparse row (CSR) form: the outgoing
+ * edges of node N are the edge ids in the range [GetEdgeBegin(N), GetEdgeEnd(N)). The cost of every edge is computed
+ * once when the graph is built so searches never have to touch the ANavigationNode actors. The incoming edges of
+ * every node are stored in a second, reverse CSR so searches can also run backwards from a goal.
+ *
+ * The arrays are either owned by the graph or point straight into a baked navigation graph that was loaded from disk,
+ * which the graph keeps alive. The nodes, their positions and the edges never change once the graph is built, so copies
+ * share them and only have their own edge costs, which SetEdgeCost changes.
+ */
+class AGP_API FNavigationGraph
+{
+public:
+
+	FNavigationGraph() = default;
+	FNavigationGraph(const FNavigationGraph& Other);
+	FNavigationGraph& operator=(const FNavigationGraph& Other);
+
+	/**
+	 * Will build the graph from the given node data. Null connections, self connections and duplicate connections are
+	 * ignored.
+	 * @param Locations The world location of each node.
+	 * @param NodeTypes The point type of each node. Must be the same length as Locations.
+	 * @param Connections The ids of the nodes that each node is connected to. Must be the same length as Locations.
+	 */
+	void Build(TConstArrayView<FVector> Locations, TConstArrayView<EPointType> NodeTypes, TConstArrayView<TArray<int32>> Connections);
+
+	/**
+	 * Will point the graph at the arrays of a baked navigation graph, without copying or parsing them.
+	 */
+	void InitFromBaked(const TSharedRef<const FBakedNavigationGraph, ESPMode::ThreadSafe>& InBakedGraph);
+
+	/**
+	 * The version of the navigation data that this snapshot was built from. Changes whenever the connectivity or the
+	 * costs of the graph change, so anything derived from a snapshot can tell when it has gone stale.
+	 */
+	uint32 GetVersion() const
+	{
+		return Version;
+	}
+
+	void SetVersion(uint32 InVersion)
+	{
+		Version = InVersion;
+	}
+
+	/**
+	 * The version of the snapshot that this one was copied from with SetEdgeCost, or the same as GetVersion if it was
+	 * built. Snapshots with the same layout version have the same nodes and edges, and every edge costs at least as
+	 * much as it did when the graph was built, so lower bounds on the path costs of one hold for all of them.
+	 */
+	uint32 GetLayoutVersion() const
+	{
+		return LayoutVersion;
+	}
+
+	void SetLayoutVersion(uint32 InLayoutVersion)
+	{
+		LayoutVersion = InLayoutVersion;
+	}
+
+	int32 GetNumNodes() const
+	{
+		return NodeTypes.Num();
+	}
+
+	int32 GetNumEdges() const
+	{
+		return EdgeTargets.Num();
+	}
+
+	bool IsValidNode(int32 NodeId) const
+	{
+		return NodeTypes.IsValidIndex(NodeId);
+	}
+
+	FVector GetNodeLocation(int32 NodeId) const
+	{
+		return FVector(PositionsX[NodeId], PositionsY[NodeId], PositionsZ[NodeId]);
+	}
+
+	EPointType GetNodeType(int32 NodeId) const
+	{
+		return NodeTypes[NodeId];
+	}
+
+	int32 GetEdgeBegin(int32 NodeId) const
+	{
+		return EdgeOffsets[NodeId];
+	}
+
+	int32 GetEdgeEnd(int32 NodeId) const
+	{
+		return EdgeOffsets[NodeId + 1];
+	}
+
+	int32 GetEdgeTarget(int32 EdgeId) const
+	{
+		return EdgeTargets[EdgeId];
+	}
+
+	float GetEdgeCost(int32 EdgeId) const
+	{
+		return EdgeCosts[EdgeId];
+	}
+
+	/**
+	 * Will change the cost of an edge. Only for making a modified copy of a snapshot before it is shared, as the
+	 * searches expect the snapshots they are given to never change. UE_MAX_FLT blocks the edge.
+	 */
+	void SetEdgeCost(int32 EdgeId, float Cost)
+	{
+		if (EdgeCosts.GetData() != EdgeCostStorage.GetData())
+		{
+			// The costs still belong to the baked graph, which is read only.
+			EdgeCostStorage = EdgeCosts;
+			EdgeCosts = EdgeCostStorage;
+		}
+		EdgeCostStorage[EdgeId] = Cost;
+	}
+
+	/**
+	 * @return true if the edge has been blocked with SetEdgeCost. Searches must skip blocked edges rather than add
+	 * their cost, so a blocked edge can never end up in a path.
+	 */
+	bool IsEdgeBlocked(int32 EdgeId) const
+	{
+		return EdgeCosts[EdgeId] >= UE_MAX_FLT;
+	}
+
+	/**
+	 * The incoming edges of node N are the reverse edge ids in the range [GetReverseEdgeBegin(N), GetReverseEdgeEnd(N)).
+	 */
+	int32 GetReverseEdgeBegin(int32 NodeId) const
+	{
+		return ReverseEdgeOffsets[NodeId];
+	}
+
+	int32 GetReverseEdgeEnd(int32 NodeId) const
+	{
+		return ReverseEdgeOffsets[NodeId + 1];
+	}
+
+	/**
+	 * @return The id of the forward edge that a reverse edge mirrors. Its source is GetReverseEdgeSource.
+	 */
+	int32 GetReverseEdgeForwardId(int32 ReverseEdgeId) const
+	{
+		return ReverseEdgeForwardIds[ReverseEdgeId];
+	}
+
+	int32 GetReverseEdgeSource(int32 ReverseEdgeId) const
+	{
+		return ReverseEdgeSources[ReverseEdgeId];
+	}
+
+	float GetReverseEdgeCost(int32 ReverseEdgeId) const
+	{
+		return EdgeCosts[ReverseEdgeForwardIds[ReverseEdgeId]];
+	}
+
+	bool IsReverseEdgeBlocked(int32 ReverseEdgeId) const
+	{
+		return IsEdgeBlocked(ReverseEdgeForwardIds[ReverseEdgeId]);
+	}
+
+	/**
+	 * @return The squared straight line distance between the node and the location.
+	 */
+	float DistanceSquared(int32 NodeId, const FVector& Location) const
+	{
+		const float DX = PositionsX[NodeId] - static_cast<float>(Location.X);
+		const float DY = PositionsY[NodeId] - static_cast<float>(Location.Y);
+		const float DZ = PositionsZ[NodeId] - static_cast<float>(Location.Z);
+		return DX * DX + DY * DY + DZ * DZ;
+	}
+
+	/**
+	 * @return The straight line distance between two nodes.
+	 */
+	float Distance(int32 NodeA, int32 NodeB) const
+	{
+		const float DX = PositionsX[NodeA] - PositionsX[NodeB];
+		const float DY = PositionsY[NodeA] - PositionsY[NodeB];
+		const float DZ = PositionsZ[NodeA] - PositionsZ[NodeB];
+		return FMath::Sqrt(DX * DX + DY * DY + DZ * DZ);
+	}
+
+	TConstArrayView<float> GetPositionsX() const { return PositionsX; }
+	TConstArrayView<float> GetPositionsY() const { return PositionsY; }
+	TConstArrayView<float> GetPositionsZ() const { return PositionsZ; }
+
+private:
+
+	friend class FBakedNavigationGraph;
+
+	/**
+	 * The arrays of a graph that was built rather than loaded, apart from the edge costs. Never changed once built, so
+	 * it is shared by every copy of the graph.
+	 */
+	struct FTopology
+	{
+		TArray<float> PositionsX;
+		TArray<float> PositionsY;
+		TArray<float> PositionsZ;
+		TArray<EPointType> NodeTypes;
+		TArray<int32> EdgeOffsets;
+		TArray<int32> EdgeTargets;
+		TArray<int32> ReverseEdgeOffsets;
+		TArray<int32> ReverseEdgeSources;
+		TArray<int32> ReverseEdgeForwardIds;
+	};
+
+	/**
+	 * Will point every array at the Topology and the EdgeCostStorage.
+	 */
+	void BindStorage();
+
+	uint32 Version = 0;
+	uint32 LayoutVersion = 0;
+
+	TSharedPtr<const FTopology, ESPMode::ThreadSafe> Topology;
+	// The edge costs of a graph that was built, and of a loaded graph once they have been changed.
+	TArray<float> EdgeCostStorage;
+	// Keeps the memory that the arrays point into alive when the graph was loaded.
+	TSharedPtr<const FBakedNavigationGraph, ESPMode::ThreadSafe> BakedGraph;
+
+	TConstArrayView<float> PositionsX;
+	TConstArrayView<float> PositionsY;
+	TConstArrayView<float> PositionsZ;
+	TConstArrayView<EPointType> NodeTypes;
+
+	// NumNodes + 1 offsets into the EdgeTargets and EdgeCosts arrays.
+	TConstArrayView<int32> EdgeOffsets;
+	TConstArrayView<int32> EdgeTargets;
+	TConstArrayView<float> EdgeCosts;
+
+	// NumNodes + 1 offsets into the ReverseEdgeSources and ReverseEdgeForwardIds arrays.
+	TConstArrayView<int32> ReverseEdgeOffsets;
+	TConstArrayView<int32> ReverseEdgeSources;
+	TConstArrayView<int32> ReverseEdgeForwardIds;
+};
+
+typedef TSharedPtr<const FNavigationGraph, ESPMode::ThreadSafe> FNavigationGraphPtr;
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationGraphDebugComponent.h"
+
+#include "NavigationGraph.h"
+#include "NavigationNode.h"
+
+namespace
+{
+	constexpr float NodePointSize = 12.0f;
+	constexpr float EdgeThickness = 5.0f;
+
+	FLinearColor GetPointTypeColor(EPointType PointType)
+	{
+		switch (PointType)
+		{
+		case EPointType::Cover:
+			return FLinearColor(FColor::Cyan);
+		case EPointType::SpawnPoint:
+			return FLinearColor(FColor::Yellow);
+		case EPointType::EscapePoint:
+			return FLinearColor(FColor::Magenta);
+		default:
+			return FLinearColor(FColor::Blue);
+		}
+	}
+}
+
+UNavigationGraphDebugComponent::UNavigationGraphDebugComponent()
+{
+	// The graph can cover the whole level, so don't spend time working out tight bounds for it.
+	bCalculateAccurateBounds = false;
+}
+
+void UNavigationGraphDebugComponent::DrawGraph(const FNavigationGraph& Graph)
+{
+	Flush();
+
+	TArray<FBatchedLine> Lines;
+	Lines.Reserve(Graph.GetNumEdges());
+	for (int32 NodeId = 0; NodeId < Graph.GetNumNodes(); ++NodeId)
+	{
+		const FVector NodeLocation = Graph.GetNodeLocation(NodeId);
+		BatchedPoints.Emplace(NodeLocation, GetPointTypeColor(Graph.GetNodeType(NodeId)), NodePointSize, 0.0f, SDPG_World);
+
+		for (int32 EdgeId = Graph.GetEdgeBegin(NodeId); EdgeId < Graph.GetEdgeEnd(NodeId); ++EdgeId)
+		{
+			const int32 TargetId = Graph.GetEdgeTarget(EdgeId);
+			bool bTwoWay = false;
+			for (int32 ReturnEdgeId = Graph.GetEdgeBegin(TargetId); ReturnEdgeId < Graph.GetEdgeEnd(TargetId) && !bTwoWay; ++ReturnEdgeId)
+			{
+				bTwoWay = Graph.GetEdgeTarget(ReturnEdgeId) == NodeId;
+			}
+
+			const FColor Color = Graph.GetEdgeCost(EdgeId) == UE_MAX_FLT ? FColor(128, 128, 128) : bTwoWay ? FColor::Green : FColor::Red;
+			Lines.Emplace(NodeLocation, Graph.GetNodeLocation(TargetId), FLinearColor(Color), 0.0f, EdgeThickness, SDPG_World);
+		}
+	}
+	// Lines with no life time stay until the next flush.
+	DrawLines(Lines);
+	DrawnGraphVersion = Graph.GetVersion();
+}
+
+void UNavigationGraphDebugComponent::ClearGraph()
+{
+	Flush();
+	DrawnGraphVersion = 0;
+}
@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/LineBatchComponent.h"
+#include "NavigationGraphDebugComponent.generated.h"
+
+class FNavigationGraph;
+
+/**
+ * Draws a whole navigation graph as one batch of lines and points, straight from the flattened graph. The batch stays
+ * on screen until the graph is drawn again, so it only needs to be rebuilt when the graph changes. Owned by the
+ * pathfinding subsystem, which draws the graph while the AGP.Pathfinding.DrawGraph console variable is set.
+ *
+ * Nodes are drawn as points coloured by their point type. Edges that go both ways are green, edges that only go one
+ * way are red and edges that are blocked by the runtime changes are grey.
+ */
+UCLASS()
+class AGP_API UNavigationGraphDebugComponent : public ULineBatchComponent
+{
+	GENERATED_BODY()
+
+public:
+
+	UNavigationGraphDebugComponent();
+
+	/**
+	 * Will replace whatever was drawn before with the graph.
+	 */
+	void DrawGraph(const FNavigationGraph& Graph);
+
+	/**
+	 * Will remove the graph from the screen.
+	 */
+	void ClearGraph();
+
+	/**
+	 * @return The version of the graph that is on screen, or 0 if nothing is.
+	 */
+	uint32 GetDrawnGraphVersion() const
+	{
+		return DrawnGraphVersion;
+	}
+
+private:
+
+	uint32 DrawnGraphVersion = 0;
+};
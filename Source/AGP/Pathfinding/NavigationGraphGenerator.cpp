@@ -0,0 +1,256 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationGraphGenerator.h"
+
+#include "NavigationNode.h"
+#include "PathfindingStats.h"
+#include "Components/BoxComponent.h"
+#if WITH_EDITOR
+#include "Async/ParallelFor.h"
+#include "NavigationSystem.h"
+#include "ScopedTransaction.h"
+#endif
+
+#define LOCTEXT_NAMESPACE "NavigationGraphGenerator"
+
+ANavigationGraphGenerator::ANavigationGraphGenerator()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	// Only the nodes it makes are needed by the game.
+	bIsEditorOnlyActor = true;
+
+	GenerationBounds = CreateDefaultSubobject<UBoxComponent>(TEXT("Generation Bounds"));
+	GenerationBounds->SetBoxExtent(FVector(2000.0f, 2000.0f, 500.0f));
+	GenerationBounds->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetRootComponent(GenerationBounds);
+}
+
+#if WITH_EDITOR
+
+namespace
+{
+	// The number of traces or sweeps that each worker takes at a time.
+	constexpr int32 TraceBatchSize = 64;
+}
+
+void ANavigationGraphGenerator::Generate()
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const FBox Box = GenerationBounds->CalcBounds(GenerationBounds->GetComponentTransform()).GetBox();
+	const int32 NumCellsX = FMath::Max(1, FMath::FloorToInt32(Box.GetSize().X / Spacing));
+	const int32 NumCellsY = FMath::Max(1, FMath::FloorToInt32(Box.GetSize().Y / Spacing));
+
+	TArray<FNodeSample> Samples;
+	if (Sampling == ENavigationGraphSampling::NavMesh)
+	{
+		SampleNavMesh(Box, NumCellsX, NumCellsY, Samples);
+	}
+	else
+	{
+		SampleWalkableSurface(Box, NumCellsX, NumCellsY, Samples);
+	}
+	const TArray<FIntPoint> Connections = ConnectSamples(NumCellsX, NumCellsY, Samples);
+	const double TraceTime = FPlatformTime::Seconds();
+
+	// Everything below is one undo step, including clearing the nodes of the last generation.
+	const FScopedTransaction Transaction(LOCTEXT("GenerateNavigationGraph", "Generate Navigation Graph"));
+	ClearGenerated();
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	GeneratedNodes.Reserve(Samples.Num());
+	for (const FNodeSample& Sample : Samples)
+	{
+		ANavigationNode* Node = World->SpawnActor<ANavigationNode>(Sample.FloorLocation + FVector(0.0f, 0.0f, NodeHeight), FRotator::ZeroRotator, SpawnParameters);
+		Node->SetFolderPath(TEXT("NavigationNodes"));
+		GeneratedNodes.Add(Node);
+	}
+	// Every connection goes both ways, so there are no one way mistakes to find later.
+	for (const FIntPoint& Connection : Connections)
+	{
+		GeneratedNodes[Connection.X]->ConnectedNodes.Add(GeneratedNodes[Connection.Y]);
+		GeneratedNodes[Connection.Y]->ConnectedNodes.Add(GeneratedNodes[Connection.X]);
+	}
+
+	UE_LOG(LogPathfinding, Display, TEXT("Generated %d navigation nodes with %d connections: %.1f ms of traces and %.1f ms spawning the nodes."),
+		GeneratedNodes.Num(), Connections.Num(), (TraceTime - StartTime) * 1000.0, (FPlatformTime::Seconds() - TraceTime) * 1000.0)
+}
+
+void ANavigationGraphGenerator::ClearGenerated()
+{
+	const FScopedTransaction Transaction(LOCTEXT("ClearNavigationGraph", "Clear Generated Navigation Graph"));
+	Modify();
+	for (ANavigationNode* Node : GeneratedNodes)
+	{
+		if (IsValid(Node))
+		{
+			GetWorld()->EditorDestroyActor(Node, true);
+		}
+	}
+	GeneratedNodes.Empty();
+}
+
+void ANavigationGraphGenerator::SampleWalkableSurface(const FBox& Box, int32 NumCellsX, int32 NumCellsY, TArray<FNodeSample>& OutSamples) const
+{
+	const UWorld* World = GetWorld();
+	const float MinFloorNormalZ = FMath::Cos(FMath::DegreesToRadians(MaxSlope));
+	const FCollisionShape AgentShape = FCollisionShape::MakeCapsule(AgentRadius, AgentHalfHeight);
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(NavigationGraphGeneratorSample), false, this);
+
+	// Each worker traces whole columns, top to bottom, so every cell's floors come out in order.
+	TArray<TArray<FVector, TInlineAllocator<4>>> CellFloors;
+	CellFloors.SetNum(NumCellsX * NumCellsY);
+	ParallelFor(TEXT("NavigationGraphGenerator.Sample"), CellFloors.Num(), TraceBatchSize, [&](int32 Cell)
+	{
+		FVector TraceStart = GetCellTop(Box, Cell % NumCellsX, Cell / NumCellsX);
+		const FVector TraceEnd(TraceStart.X, TraceStart.Y, Box.Min.Z);
+		FHitResult Hit;
+		for (int32 Trace = 0; Trace < MaxFloors * 4 && CellFloors[Cell].Num() < MaxFloors; ++Trace)
+		{
+			if (!World->LineTraceSingleByChannel(Hit, TraceStart, TraceEnd, TraceChannel, QueryParams))
+			{
+				break;
+			}
+			if (Hit.bStartPenetrating)
+			{
+				// Started inside a thick floor. Move further down and try again.
+				TraceStart.Z -= AgentHalfHeight;
+				continue;
+			}
+
+			// Stand the agent on the floor, lifted by a step so that small bumps under it don't count as blocking it.
+			const FVector AgentCenter = Hit.ImpactPoint + FVector(0.0f, 0.0f, AgentHalfHeight + MaxStepHeight);
+			if (Hit.ImpactNormal.Z >= MinFloorNormalZ
+				&& !World->OverlapBlockingTestByChannel(AgentCenter, FQuat::Identity, TraceChannel, AgentShape, QueryParams))
+			{
+				CellFloors[Cell].Add(Hit.ImpactPoint);
+			}
+			// A floor closer underneath than the agent is tall has no room to stand in, so start below that.
+			TraceStart.Z = Hit.ImpactPoint.Z - AgentHalfHeight * 2.0f;
+		}
+	});
+
+	for (int32 Cell = 0; Cell < CellFloors.Num(); ++Cell)
+	{
+		for (const FVector& Floor : CellFloors[Cell])
+		{
+			OutSamples.Add({Floor, Cell});
+		}
+	}
+}
+
+void ANavigationGraphGenerator::SampleNavMesh(const FBox& Box, int32 NumCellsX, int32 NumCellsY, TArray<FNodeSample>& OutSamples) const
+{
+	const UNavigationSystemV1* NavigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (!NavigationSystem)
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("There is no navigation system in this level to sample the navigation mesh of."))
+		return;
+	}
+
+	// Projecting onto the navigation mesh is cheap and not safe off the game thread, so it isn't spread over workers.
+	const FVector QueryExtent(Spacing * 0.5f, Spacing * 0.5f, Box.GetExtent().Z);
+	for (int32 Cell = 0; Cell < NumCellsX * NumCellsY; ++Cell)
+	{
+		const FVector CellCenter = GetCellTop(Box, Cell % NumCellsX, Cell / NumCellsX) - FVector(0.0f, 0.0f, Box.GetExtent().Z);
+		FNavLocation Projected;
+		if (NavigationSystem->ProjectPointToNavigation(CellCenter, Projected, QueryExtent))
+		{
+			OutSamples.Add({Projected.Location, Cell});
+		}
+	}
+}
+
+TArray<FIntPoint> ANavigationGraphGenerator::ConnectSamples(int32 NumCellsX, int32 NumCellsY, TConstArrayView<FNodeSample> Samples) const
+{
+	// The samples are in cell order, so each cell's samples are a range of them.
+	TArray<int32> CellOffsets;
+	CellOffsets.SetNumZeroed(NumCellsX * NumCellsY + 1);
+	for (const FNodeSample& Sample : Samples)
+	{
+		++CellOffsets[Sample.Cell + 1];
+	}
+	for (int32 Cell = 0; Cell < NumCellsX * NumCellsY; ++Cell)
+	{
+		CellOffsets[Cell + 1] += CellOffsets[Cell];
+	}
+
+	// Pair every sample with the samples in the neighbouring cells ahead of it, so each pair is only made once, and
+	// only keep the pairs close enough in height to walk between.
+	const float MaxRise = FMath::Tan(FMath::DegreesToRadians(MaxSlope));
+	TArray<FIntPoint, TInlineAllocator<4>> NeighbourOffsets = {FIntPoint(1, 0), FIntPoint(0, 1)};
+	if (bConnectDiagonals)
+	{
+		NeighbourOffsets.Append({FIntPoint(1, 1), FIntPoint(1, -1)});
+	}
+	TArray<FIntPoint> Candidates;
+	for (int32 SampleIndex = 0; SampleIndex < Samples.Num(); ++SampleIndex)
+	{
+		const FNodeSample& Sample = Samples[SampleIndex];
+		const FIntPoint CellCoordinates(Sample.Cell % NumCellsX, Sample.Cell / NumCellsX);
+		for (const FIntPoint& Offset : NeighbourOffsets)
+		{
+			const FIntPoint Neighbour = CellCoordinates + Offset;
+			if (Neighbour.X < 0 || Neighbour.X >= NumCellsX || Neighbour.Y < 0 || Neighbour.Y >= NumCellsY) continue;
+
+			const int32 NeighbourCell = Neighbour.Y * NumCellsX + Neighbour.X;
+			for (int32 OtherIndex = CellOffsets[NeighbourCell]; OtherIndex < CellOffsets[NeighbourCell + 1]; ++OtherIndex)
+			{
+				const FVector& From = Sample.FloorLocation;
+				const FVector& To = Samples[OtherIndex].FloorLocation;
+				if (FMath::Abs(From.Z - To.Z) <= MaxStepHeight + FVector::Dist2D(From, To) * MaxRise)
+				{
+					Candidates.Emplace(SampleIndex, OtherIndex);
+				}
+			}
+		}
+	}
+
+	const UWorld* World = GetWorld();
+	const FCollisionShape AgentShape = FCollisionShape::MakeCapsule(AgentRadius, AgentHalfHeight);
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(NavigationGraphGeneratorConnect), false, this);
+	const FVector AgentLift(0.0f, 0.0f, AgentHalfHeight + MaxStepHeight);
+	TArray<bool> bWalkable;
+	bWalkable.SetNumZeroed(Candidates.Num());
+	ParallelFor(TEXT("NavigationGraphGenerator.Connect"), Candidates.Num(), TraceBatchSize, [&](int32 CandidateIndex)
+	{
+		const FVector& From = Samples[Candidates[CandidateIndex].X].FloorLocation;
+		const FVector& To = Samples[Candidates[CandidateIndex].Y].FloorLocation;
+		if (World->SweepTestByChannel(From + AgentLift, To + AgentLift, FQuat::Identity, TraceChannel, AgentShape, QueryParams))
+		{
+			return;
+		}
+
+		// There has to be floor under the middle of the way too, or the agent would walk off a ledge.
+		const FVector Middle = (From + To) * 0.5f;
+		const float Drop = FMath::Abs(From.Z - To.Z) * 0.5f + MaxStepHeight;
+		bWalkable[CandidateIndex] = World->LineTraceTestByChannel(Middle + FVector(0.0f, 0.0f, MaxStepHeight), Middle - FVector(0.0f, 0.0f, Drop),
+			TraceChannel, QueryParams);
+	});
+
+	TArray<FIntPoint> Connections;
+	for (int32 CandidateIndex = 0; CandidateIndex < Candidates.Num(); ++CandidateIndex)
+	{
+		if (bWalkable[CandidateIndex])
+		{
+			Connections.Add(Candidates[CandidateIndex]);
+		}
+	}
+	return Connections;
+}
+
+FVector ANavigationGraphGenerator::GetCellTop(const FBox& Box, int32 CellX, int32 CellY) const
+{
+	return FVector(Box.Min.X + (CellX + 0.5f) * Spacing, Box.Min.Y + (CellY + 0.5f) * Spacing, Box.Max.Z);
+}
+
+#endif
+
+#undef LOCTEXT_NAMESPACE
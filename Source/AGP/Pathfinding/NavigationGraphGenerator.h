@@ -0,0 +1,158 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "NavigationGraphGenerator.generated.h"
+
+class ANavigationNode;
+class UBoxComponent;
+
+/**
+ * Where the navigation graph generator looks for the places to put nodes.
+ */
+UENUM()
+enum class ENavigationGraphSampling : uint8
+{
+	// Traces down through the bounds for floors that are flat enough and have room for the agent, on every storey.
+	WalkableSurface,
+	// Projects the grid onto the navigation mesh, one node per grid cell.
+	NavMesh
+};
+
+/**
+ * An editor tool that fills its bounds with navigation nodes and connects them, instead of placing and wiring the
+ * nodes by hand. Place it in the level, size the box around the walkable area and press Generate.
+ *
+ * The nodes are placed on a grid with Spacing between them. Neighbouring nodes, including diagonal ones, are connected
+ * in both directions if the agent's capsule can sweep from one to the other and there is floor under the middle of the
+ * way. The traces and sweeps are run in batches across the worker threads and the nodes are spawned and wired in one
+ * transaction, so one undo takes the whole generation back. Generating again replaces the nodes that the last
+ * generation made and leaves the hand placed nodes alone. Every generated node is a Normal point, so the cover, spawn
+ * and escape points still have to be set by hand.
+ */
+UCLASS(hidecategories = (Collision, Physics, Rendering, Input, HLOD, Cooking, Replication, Networking))
+class AGP_API ANavigationGraphGenerator : public AActor
+{
+	GENERATED_BODY()
+
+public:
+
+	ANavigationGraphGenerator();
+
+#if WITH_EDITOR
+	/**
+	 * Will replace the nodes made by the last generation with new ones that fill the bounds.
+	 */
+	UFUNCTION(CallInEditor, Category = "Navigation Graph")
+	void Generate();
+
+	/**
+	 * Will delete the nodes made by the last generation.
+	 */
+	UFUNCTION(CallInEditor, Category = "Navigation Graph")
+	void ClearGenerated();
+#endif
+
+protected:
+
+	/**
+	 * The area to fill with nodes.
+	 */
+	UPROPERTY(VisibleAnywhere)
+	UBoxComponent* GenerationBounds;
+
+	UPROPERTY(EditAnywhere, Category = "Navigation Graph")
+	ENavigationGraphSampling Sampling = ENavigationGraphSampling::WalkableSurface;
+
+	/**
+	 * The distance between neighbouring nodes.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Navigation Graph", meta = (ClampMin = "50", Units = "Centimeters"))
+	float Spacing = 300.0f;
+
+	/**
+	 * The most floors, one above the other, that the walkable surface sampling looks for in each grid cell.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Navigation Graph", meta = (EditCondition = "Sampling == ENavigationGraphSampling::WalkableSurface", ClampMin = "1", ClampMax = "16"))
+	int32 MaxFloors = 4;
+
+	/**
+	 * How high above the floor the nodes are placed.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Navigation Graph", meta = (ClampMin = "0", Units = "Centimeters"))
+	float NodeHeight = 50.0f;
+
+	/**
+	 * The size of the capsule of the characters that walk the graph.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Navigation Graph", meta = (ClampMin = "1", Units = "Centimeters"))
+	float AgentRadius = 42.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Navigation Graph", meta = (ClampMin = "1", Units = "Centimeters"))
+	float AgentHalfHeight = 96.0f;
+
+	/**
+	 * The highest step that the characters can walk up. The sweeps between nodes are raised by this much so that
+	 * steps and bumps don't cut the connections.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Navigation Graph", meta = (ClampMin = "0", Units = "Centimeters"))
+	float MaxStepHeight = 45.0f;
+
+	/**
+	 * The steepest floor that the characters can walk on.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Navigation Graph", meta = (ClampMin = "0", ClampMax = "89", Units = "Degrees"))
+	float MaxSlope = 44.0f;
+
+	/**
+	 * The channel that the floor traces and the agent sweeps are made on.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Navigation Graph")
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Pawn;
+
+	/**
+	 * If true, diagonal neighbours are connected as well as the ones next to each other.
+	 */
+	UPROPERTY(EditAnywhere, Category = "Navigation Graph")
+	bool bConnectDiagonals = true;
+
+	/**
+	 * The nodes made by the last generation.
+	 */
+	UPROPERTY(VisibleAnywhere, Category = "Navigation Graph")
+	TArray<ANavigationNode*> GeneratedNodes;
+
+private:
+
+#if WITH_EDITOR
+	/**
+	 * A place for a node: the floor that was found, and the grid cell it was found in.
+	 */
+	struct FNodeSample
+	{
+		FVector FloorLocation;
+		int32 Cell;
+	};
+
+	/**
+	 * Will find the floors in every grid cell with batches of traces on the worker threads.
+	 */
+	void SampleWalkableSurface(const FBox& Box, int32 NumCellsX, int32 NumCellsY, TArray<FNodeSample>& OutSamples) const;
+	/**
+	 * Will project the centre of every grid cell onto the navigation mesh.
+	 */
+	void SampleNavMesh(const FBox& Box, int32 NumCellsX, int32 NumCellsY, TArray<FNodeSample>& OutSamples) const;
+	/**
+	 * Will find which of the pairs of samples in neighbouring cells the agent can walk between, with batches of sweeps
+	 * on the worker threads.
+	 * @return The pairs of sample indices to connect.
+	 */
+	TArray<FIntPoint> ConnectSamples(int32 NumCellsX, int32 NumCellsY, TConstArrayView<FNodeSample> Samples) const;
+	/**
+	 * @return The location in the world of the centre of a grid cell, at the top of the bounds.
+	 */
+	FVector GetCellTop(const FBox& Box, int32 CellX, int32 CellY) const;
+#endif
+};
@@ -0,0 +1,354 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationHierarchy.h"
+
+#include "NavigationGraph.h"
+#include "NavigationSearchWorkspace.h"
+#include "Algo/Reverse.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+	// Roughly how many nodes should end up in each cluster.
+	constexpr float NodesPerCluster = 64.0f;
+	constexpr int32 MaxClustersPerAxis = 256;
+}
+
+void FNavigationHierarchy::Build(const FNavigationGraph& Graph)
+{
+	const int32 NumNodes = Graph.GetNumNodes();
+	GraphVersion = Graph.GetVersion();
+	const TSharedRef<FLayout, ESPMode::ThreadSafe> NewLayout = MakeShared<FLayout, ESPMode::ThreadSafe>();
+	Layout = NewLayout;
+	EntranceCosts.Reset();
+	if (NumNodes == 0)
+	{
+		return;
+	}
+
+	// Only split the level across the ground. Levels are rarely tall enough for the height to be worth clustering.
+	FBox2f Bounds(ForceInit);
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		Bounds += FVector2f(Graph.GetPositionsX()[NodeId], Graph.GetPositionsY()[NodeId]);
+	}
+	const FVector2f Extent = Bounds.GetSize();
+	const double TargetClusters = FMath::Max(1.0, NumNodes / NodesPerCluster);
+	float ClusterSize = FMath::Max(1.0f, static_cast<float>(FMath::Sqrt(FMath::Max(Extent.X, 1.0f) * FMath::Max(Extent.Y, 1.0f) / TargetClusters)));
+	ClusterSize = FMath::Max3(ClusterSize, Extent.X / (MaxClustersPerAxis - 1), Extent.Y / (MaxClustersPerAxis - 1));
+	NewLayout->ClusterSize = ClusterSize;
+	NewLayout->Origin = Bounds.Min;
+	NewLayout->Dimensions = FIntPoint(FMath::FloorToInt32(Extent.X / ClusterSize) + 1, FMath::FloorToInt32(Extent.Y / ClusterSize) + 1);
+	const int32 NumClusters = NewLayout->Dimensions.X * NewLayout->Dimensions.Y;
+
+	// Counting sort of the nodes by the cluster they are in.
+	TArray<int32>& NodeClusters = NewLayout->NodeClusters;
+	TArray<int32>& ClusterNodeOffsets = NewLayout->ClusterNodeOffsets;
+	TArray<int32>& ClusterNodes = NewLayout->ClusterNodes;
+	NodeClusters.SetNumUninitialized(NumNodes);
+	ClusterNodeOffsets.Init(0, NumClusters + 1);
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		NodeClusters[NodeId] = NewLayout->GetClusterIndex(Graph.GetNodeLocation(NodeId));
+		++ClusterNodeOffsets[NodeClusters[NodeId] + 1];
+	}
+	for (int32 ClusterIndex = 0; ClusterIndex < NumClusters; ++ClusterIndex)
+	{
+		ClusterNodeOffsets[ClusterIndex + 1] += ClusterNodeOffsets[ClusterIndex];
+	}
+	ClusterNodes.SetNumUninitialized(NumNodes);
+	TArray<int32> NextClusterNode(ClusterNodeOffsets.GetData(), NumClusters);
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		ClusterNodes[NextClusterNode[NodeClusters[NodeId]]++] = NodeId;
+	}
+
+	// Any node with an edge to or from another cluster is an entrance. Blocked edges still count, so the entrances
+	// stay the same whatever the costs are and only the costs between them need rebuilding when the costs change.
+	NewLayout->NodeEntranceIndices.Init(INDEX_NONE, NumNodes);
+	NewLayout->ClusterEntrances.SetNum(NumClusters);
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		const int32 ClusterIndex = NodeClusters[NodeId];
+		bool bEntrance = false;
+		for (int32 EdgeId = Graph.GetEdgeBegin(NodeId); EdgeId < Graph.GetEdgeEnd(NodeId) && !bEntrance; ++EdgeId)
+		{
+			bEntrance = NodeClusters[Graph.GetEdgeTarget(EdgeId)] != ClusterIndex;
+		}
+		for (int32 EdgeId = Graph.GetReverseEdgeBegin(NodeId); EdgeId < Graph.GetReverseEdgeEnd(NodeId) && !bEntrance; ++EdgeId)
+		{
+			bEntrance = NodeClusters[Graph.GetReverseEdgeSource(EdgeId)] != ClusterIndex;
+		}
+		if (bEntrance)
+		{
+			NewLayout->NodeEntranceIndices[NodeId] = NewLayout->ClusterEntrances[ClusterIndex].Add(NodeId);
+		}
+	}
+
+	// Each cluster only writes its own costs so they can all be built at once.
+	EntranceCosts.SetNum(NumClusters);
+	TArray<FNavigationSearchWorkspace> Workspaces;
+	ParallelForWithTaskContext(Workspaces, NumClusters, [this, &Graph](FNavigationSearchWorkspace& Workspace, int32 ClusterIndex)
+	{
+		EntranceCosts[ClusterIndex] = BuildEntranceCosts(Graph, Workspace, ClusterIndex);
+	});
+}
+
+void FNavigationHierarchy::RebuildClusters(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, TConstArrayView<int32> ChangedNodes)
+{
+	const TArray<int32>& NodeClusters = Layout->NodeClusters;
+	check(Graph.GetNumNodes() == NodeClusters.Num());
+	GraphVersion = Graph.GetVersion();
+
+	TBitArray<> DirtyClusters(false, EntranceCosts.Num());
+	for (const int32 NodeId : ChangedNodes)
+	{
+		if (NodeClusters.IsValidIndex(NodeId))
+		{
+			DirtyClusters[NodeClusters[NodeId]] = true;
+		}
+	}
+	// The old costs of the dirty clusters may still be shared with other copies, so they are replaced rather than
+	// rebuilt in place.
+	for (TConstSetBitIterator<> It(DirtyClusters); It; ++It)
+	{
+		EntranceCosts[It.GetIndex()] = BuildEntranceCosts(Graph, Workspace, It.GetIndex());
+	}
+}
+
+int32 FNavigationHierarchy::GetNumEntrances() const
+{
+	int32 NumEntrances = 0;
+	for (const TArray<int32>& Entrances : Layout->ClusterEntrances)
+	{
+		NumEntrances += Entrances.Num();
+	}
+	return NumEntrances;
+}
+
+int32 FNavigationHierarchy::FLayout::GetClusterIndex(const FVector& Location) const
+{
+	const int32 X = FMath::Clamp(FMath::FloorToInt32((static_cast<float>(Location.X) - Origin.X) / ClusterSize), 0, Dimensions.X - 1);
+	const int32 Y = FMath::Clamp(FMath::FloorToInt32((static_cast<float>(Location.Y) - Origin.Y) / ClusterSize), 0, Dimensions.Y - 1);
+	return Y * Dimensions.X + X;
+}
+
+TSharedRef<const FNavigationHierarchy::FEntranceCosts, ESPMode::ThreadSafe> FNavigationHierarchy::BuildEntranceCosts(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 ClusterIndex) const
+{
+	const TArray<int32>& Entrances = Layout->ClusterEntrances[ClusterIndex];
+	const int32 NumEntrances = Entrances.Num();
+	const TSharedRef<FEntranceCosts, ESPMode::ThreadSafe> Costs = MakeShared<FEntranceCosts, ESPMode::ThreadSafe>();
+	Costs->SetNumUninitialized(NumEntrances * NumEntrances);
+	for (int32 FromIndex = 0; FromIndex < NumEntrances; ++FromIndex)
+	{
+		SearchCluster(Graph, Workspace, Entrances[FromIndex], INDEX_NONE, ENavigationSearchDirection::Forward);
+		for (int32 ToIndex = 0; ToIndex < NumEntrances; ++ToIndex)
+		{
+			(*Costs)[FromIndex * NumEntrances + ToIndex] = Workspace.GetGScore(Entrances[ToIndex]);
+		}
+	}
+	return Costs;
+}
+
+void FNavigationHierarchy::SearchCluster(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 SourceNode, int32 TargetNode, ENavigationSearchDirection Direction) const
+{
+	const TArray<int32>& NodeClusters = Layout->NodeClusters;
+	const int32 ClusterIndex = NodeClusters[SourceNode];
+	Workspace.BeginSearch(Graph.GetNumNodes());
+	FNavigationOpenSet& OpenSet = Workspace.GetOpenSet();
+	Workspace.Visit(SourceNode, TargetNode == INDEX_NONE ? 0.0f : Graph.Distance(SourceNode, TargetNode));
+	Workspace.SetGScore(SourceNode, 0.0f);
+	OpenSet.Push(SourceNode, Workspace.GetHScore(SourceNode));
+
+	const auto Relax = [&](int32 CurrentNode, int32 ConnectedNode, float TentativeGScore)
+	{
+		if (NodeClusters[ConnectedNode] != ClusterIndex) return;
+		if (!Workspace.IsVisited(ConnectedNode))
+		{
+			Workspace.Visit(ConnectedNode, TargetNode == INDEX_NONE ? 0.0f : Graph.Distance(ConnectedNode, TargetNode));
+		}
+		if (TentativeGScore < Workspace.GetGScore(ConnectedNode))
+		{
+			Workspace.SetCameFrom(ConnectedNode, CurrentNode);
+			Workspace.SetGScore(ConnectedNode, TentativeGScore);
+			OpenSet.Push(ConnectedNode, TentativeGScore + Workspace.GetHScore(ConnectedNode));
+		}
+	};
+
+	while (!OpenSet.IsEmpty())
+	{
+		const int32 CurrentNode = Workspace.ExpandNext();
+		if (CurrentNode == TargetNode)
+		{
+			return;
+		}
+
+		const float CurrentGScore = Workspace.GetGScore(CurrentNode);
+		if (Direction == ENavigationSearchDirection::Forward)
+		{
+			for (int32 EdgeId = Graph.GetEdgeBegin(CurrentNode); EdgeId < Graph.GetEdgeEnd(CurrentNode); ++EdgeId)
+			{
+				if (Graph.IsEdgeBlocked(EdgeId)) continue;
+				Relax(CurrentNode, Graph.GetEdgeTarget(EdgeId), CurrentGScore + Graph.GetEdgeCost(EdgeId));
+			}
+		}
+		else
+		{
+			for (int32 EdgeId = Graph.GetReverseEdgeBegin(CurrentNode); EdgeId < Graph.GetReverseEdgeEnd(CurrentNode); ++EdgeId)
+			{
+				if (Graph.IsReverseEdgeBlocked(EdgeId)) continue;
+				Relax(CurrentNode, Graph.GetReverseEdgeSource(EdgeId), CurrentGScore + Graph.GetReverseEdgeCost(EdgeId));
+			}
+		}
+	}
+}
+
+bool FNavigationHierarchy::FindRoute(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 StartNode, int32 EndNode, TArray<int32>& OutRoute) const
+{
+	OutRoute.Reset();
+	const TArray<int32>& NodeClusters = Layout->NodeClusters;
+	if (!Graph.IsValidNode(StartNode) || !Graph.IsValidNode(EndNode) || NodeClusters.Num() != Graph.GetNumNodes())
+	{
+		return false;
+	}
+
+	// Connect the start and the end to the entrances of their clusters, and to each other if they share a cluster.
+	const int32 StartCluster = NodeClusters[StartNode];
+	const int32 EndCluster = NodeClusters[EndNode];
+	TArray<float, TInlineAllocator<32>> StartCosts;
+	TArray<float, TInlineAllocator<32>> EndCosts;
+	SearchCluster(Graph, Workspace, StartNode, INDEX_NONE, ENavigationSearchDirection::Forward);
+	for (const int32 Entrance : Layout->ClusterEntrances[StartCluster])
+	{
+		StartCosts.Add(Workspace.GetGScore(Entrance));
+	}
+	const float DirectCost = StartCluster == EndCluster ? Workspace.GetGScore(EndNode) : UE_MAX_FLT;
+	SearchCluster(Graph, Workspace, EndNode, INDEX_NONE, ENavigationSearchDirection::Reverse);
+	for (const int32 Entrance : Layout->ClusterEntrances[EndCluster])
+	{
+		EndCosts.Add(Workspace.GetGScore(Entrance));
+	}
+
+	// A* over the start, the end and the entrances.
+	Workspace.BeginSearch(Graph.GetNumNodes());
+	FNavigationOpenSet& OpenSet = Workspace.GetOpenSet();
+	Workspace.Visit(StartNode, Graph.Distance(StartNode, EndNode));
+	Workspace.SetGScore(StartNode, 0.0f);
+	OpenSet.Push(StartNode, Workspace.GetHScore(StartNode));
+
+	const auto Relax = [&](int32 CurrentNode, int32 ConnectedNode, float TentativeGScore)
+	{
+		if (!Workspace.IsVisited(ConnectedNode))
+		{
+			Workspace.Visit(ConnectedNode, Graph.Distance(ConnectedNode, EndNode));
+		}
+		if (TentativeGScore < Workspace.GetGScore(ConnectedNode))
+		{
+			Workspace.SetCameFrom(ConnectedNode, CurrentNode);
+			Workspace.SetGScore(ConnectedNode, TentativeGScore);
+			OpenSet.Push(ConnectedNode, TentativeGScore + Workspace.GetHScore(ConnectedNode));
+		}
+	};
+
+	while (!OpenSet.IsEmpty())
+	{
+		const int32 CurrentNode = Workspace.ExpandNext();
+		if (CurrentNode == EndNode)
+		{
+			for (int32 NodeId = EndNode; NodeId != INDEX_NONE; NodeId = Workspace.GetCameFrom(NodeId))
+			{
+				OutRoute.Add(NodeId);
+			}
+			Algo::Reverse(OutRoute);
+			return true;
+		}
+
+		const float CurrentGScore = Workspace.GetGScore(CurrentNode);
+		if (CurrentNode == StartNode)
+		{
+			const TArray<int32>& StartEntrances = Layout->ClusterEntrances[StartCluster];
+			for (int32 EntranceIndex = 0; EntranceIndex < StartEntrances.Num(); ++EntranceIndex)
+			{
+				if (StartCosts[EntranceIndex] != UE_MAX_FLT)
+				{
+					Relax(CurrentNode, StartEntrances[EntranceIndex], StartCosts[EntranceIndex]);
+				}
+			}
+			if (DirectCost != UE_MAX_FLT)
+			{
+				Relax(CurrentNode, EndNode, DirectCost);
+			}
+		}
+
+		const int32 EntranceIndex = Layout->NodeEntranceIndices[CurrentNode];
+		if (EntranceIndex == INDEX_NONE) continue;
+
+		// Across the cluster to its other entrances.
+		const int32 ClusterIndex = NodeClusters[CurrentNode];
+		const TArray<int32>& Entrances = Layout->ClusterEntrances[ClusterIndex];
+		const FEntranceCosts& Costs = *EntranceCosts[ClusterIndex];
+		const int32 NumEntrances = Entrances.Num();
+		for (int32 ToIndex = 0; ToIndex < NumEntrances; ++ToIndex)
+		{
+			const float Cost = Costs[EntranceIndex * NumEntrances + ToIndex];
+			if (ToIndex != EntranceIndex && Cost != UE_MAX_FLT)
+			{
+				Relax(CurrentNode, Entrances[ToIndex], CurrentGScore + Cost);
+			}
+		}
+		// Out of the cluster into the entrances of its neighbours.
+		for (int32 EdgeId = Graph.GetEdgeBegin(CurrentNode); EdgeId < Graph.GetEdgeEnd(CurrentNode); ++EdgeId)
+		{
+			if (NodeClusters[Graph.GetEdgeTarget(EdgeId)] != ClusterIndex && !Graph.IsEdgeBlocked(EdgeId))
+			{
+				Relax(CurrentNode, Graph.GetEdgeTarget(EdgeId), CurrentGScore + Graph.GetEdgeCost(EdgeId));
+			}
+		}
+		// Across the last cluster to the end.
+		if (ClusterIndex == EndCluster && EndCosts[EntranceIndex] != UE_MAX_FLT)
+		{
+			Relax(CurrentNode, EndNode, CurrentGScore + EndCosts[EntranceIndex]);
+		}
+	}
+
+	return false;
+}
+
+bool FNavigationHierarchy::RefineStep(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 FromNode, int32 ToNode, TArray<int32>& OutNodes) const
+{
+	const TArray<int32>& NodeClusters = Layout->NodeClusters;
+	if (!Graph.IsValidNode(FromNode) || !Graph.IsValidNode(ToNode) || NodeClusters.Num() != Graph.GetNumNodes())
+	{
+		return false;
+	}
+
+	if (NodeClusters[FromNode] != NodeClusters[ToNode])
+	{
+		// Steps between clusters are always a single edge. The route may have been found on an older snapshot, so check
+		// that the edge hasn't been blocked since.
+		for (int32 EdgeId = Graph.GetEdgeBegin(FromNode); EdgeId < Graph.GetEdgeEnd(FromNode); ++EdgeId)
+		{
+			if (Graph.GetEdgeTarget(EdgeId) == ToNode && !Graph.IsEdgeBlocked(EdgeId))
+			{
+				OutNodes.Add(ToNode);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	SearchCluster(Graph, Workspace, FromNode, ToNode, ENavigationSearchDirection::Forward);
+	if (!Workspace.IsVisited(ToNode) || Workspace.GetGScore(ToNode) == UE_MAX_FLT)
+	{
+		return false;
+	}
+
+	const int32 FirstIndex = OutNodes.Num();
+	for (int32 NodeId = ToNode; NodeId != FromNode; NodeId = Workspace.GetCameFrom(NodeId))
+	{
+		OutNodes.Add(NodeId);
+	}
+	Algo::Reverse(OutNodes.GetData() + FirstIndex, OutNodes.Num() - FirstIndex);
+	return true;
+}
@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavigationSearch.h"
+
+class FNavigationGraph;
+class FNavigationSearchWorkspace;
+
+/**
+ * The abstract graph for hierarchical pathfinding (HPA*). The nodes are split into clusters by a 2D grid over their
+ * locations. Any node with an edge to or from another cluster is an entrance of its cluster, and the path costs
+ * between the entrances of each cluster, staying inside the cluster, are precomputed. A query searches only over the
+ * entrances, which gives the rough route across the map, and each step of that route is refined into real nodes with
+ * a small search inside one cluster when it is needed.
+ *
+ * Each cluster only depends on its own nodes and edges, so a change to the edge costs only has to rebuild the costs of
+ * the clusters it touches. Copies share the clusters and the costs of every cluster they haven't rebuilt, so copying
+ * the hierarchy before RebuildClusters costs one pointer per cluster.
+ */
+class AGP_API FNavigationHierarchy
+{
+public:
+
+	/**
+	 * Will split the nodes of the graph into clusters and precompute the entrance costs of every cluster in parallel.
+	 * @param Graph The graph to build the hierarchy for.
+	 */
+	void Build(const FNavigationGraph& Graph);
+
+	/**
+	 * Will rebuild the entrance costs of only the clusters that contain one of the ChangedNodes. The graph must have
+	 * the same nodes and edges, in the same locations, as the graph that the hierarchy was built from.
+	 * @param Graph The changed graph.
+	 * @param Workspace The scratch memory for the searches.
+	 * @param ChangedNodes Both ends of every edge that was added, removed or changed cost.
+	 */
+	void RebuildClusters(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, TConstArrayView<int32> ChangedNodes);
+
+	/**
+	 * @return The version of the graph that the hierarchy was built from.
+	 */
+	uint32 GetGraphVersion() const
+	{
+		return GraphVersion;
+	}
+
+	int32 GetNumClusters() const
+	{
+		return EntranceCosts.Num();
+	}
+
+	/**
+	 * @return The total number of entrances over all of the clusters.
+	 */
+	int32 GetNumEntrances() const;
+
+	/**
+	 * Will find the route between two nodes over the abstract graph. Consecutive nodes of the route are either in the
+	 * same cluster, and need refining with RefineStep, or are joined by a single edge.
+	 * @param Graph The graph that the hierarchy was built from.
+	 * @param Workspace The scratch memory for the searches.
+	 * @param StartNode The node id that the route will start at.
+	 * @param EndNode The node id that the route will end at.
+	 * @param OutRoute Will be filled with the node ids of the route, from the StartNode to the EndNode.
+	 * @return true if a route was found.
+	 */
+	bool FindRoute(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 StartNode, int32 EndNode, TArray<int32>& OutRoute) const;
+
+	/**
+	 * Will turn one step of a route into the real nodes along it.
+	 * @param Graph The graph that the hierarchy was built from.
+	 * @param Workspace The scratch memory for the search.
+	 * @param FromNode The node id that the step starts at.
+	 * @param ToNode The node id that the step ends at.
+	 * @param OutNodes The node ids after the FromNode, up to and including the ToNode, will be added to this.
+	 * @return false if the step can no longer be walked, such as when the edge between two clusters has been blocked.
+	 */
+	bool RefineStep(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 FromNode, int32 ToNode, TArray<int32>& OutNodes) const;
+
+private:
+
+	/**
+	 * The clusters and their entrances. These only depend on the nodes and edges of the graph, not on the edge costs,
+	 * so every copy of the hierarchy made for a change of costs shares them.
+	 */
+	struct FLayout
+	{
+		FVector2f Origin = FVector2f::ZeroVector;
+		float ClusterSize = 1.0f;
+		FIntPoint Dimensions = FIntPoint::ZeroValue;
+		TArray<int32> NodeClusters;
+		// The index of each node in the entrances of its cluster, or INDEX_NONE if it isn't an entrance.
+		TArray<int32> NodeEntranceIndices;
+		// NumClusters + 1 offsets into ClusterNodes. The nodes of cluster C are in the range [ClusterNodeOffsets[C], ClusterNodeOffsets[C + 1]).
+		TArray<int32> ClusterNodeOffsets;
+		TArray<int32> ClusterNodes;
+		TArray<TArray<int32>> ClusterEntrances;
+
+		int32 GetClusterIndex(const FVector& Location) const;
+	};
+
+	// NumEntrances * NumEntrances path costs of one cluster, row major by the entrance the path starts at. UE_MAX_FLT if
+	// one entrance can't be reached from another without leaving the cluster.
+	typedef TArray<float> FEntranceCosts;
+
+	/**
+	 * Will find the path costs between the entrances of the cluster.
+	 */
+	TSharedRef<const FEntranceCosts, ESPMode::ThreadSafe> BuildEntranceCosts(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 ClusterIndex) const;
+
+	/**
+	 * Will run Dijkstra's algorithm, or A* if there is a TargetNode, from the SourceNode without leaving its cluster.
+	 * The path costs found are left in the workspace.
+	 */
+	void SearchCluster(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 SourceNode, int32 TargetNode, ENavigationSearchDirection Direction) const;
+
+	uint32 GraphVersion = 0;
+	TSharedRef<const FLayout, ESPMode::ThreadSafe> Layout = MakeShared<FLayout, ESPMode::ThreadSafe>();
+	// The entrance costs of each cluster. Copies share the costs of the clusters that they haven't rebuilt.
+	TArray<TSharedPtr<const FEntranceCosts, ESPMode::ThreadSafe>> EntranceCosts;
+};
@@ -0,0 +1,150 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationLandmarks.h"
+
+#include "BakedNavigationGraph.h"
+#include "NavigationGraph.h"
+#include "NavigationSearch.h"
+#include "NavigationSearchWorkspace.h"
+
+namespace
+{
+	/**
+	 * Will quantise one landmark's distances, rounding down, into every NumLandmarks-th entry of OutQuantised.
+	 * @return The size of one step.
+	 */
+	float QuantiseDistances(TConstArrayView<float> Distances, int32 NumLandmarks, uint16* OutQuantised)
+	{
+		float MaxDistance = 0.0f;
+		for (const float Distance : Distances)
+		{
+			if (Distance != UE_MAX_FLT)
+			{
+				MaxDistance = FMath::Max(MaxDistance, Distance);
+			}
+		}
+
+		const float Scale = FMath::Max(MaxDistance / (MAX_uint16 - 1), UE_KINDA_SMALL_NUMBER);
+		for (int32 NodeId = 0; NodeId < Distances.Num(); ++NodeId)
+		{
+			OutQuantised[NodeId * NumLandmarks] = Distances[NodeId] == UE_MAX_FLT ? MAX_uint16
+				: static_cast<uint16>(FMath::Min(FMath::FloorToInt32(Distances[NodeId] / Scale), MAX_uint16 - 1));
+		}
+		return Scale;
+	}
+}
+
+void FNavigationLandmarks::Build(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 NumLandmarks)
+{
+	const int32 NumNodes = Graph.GetNumNodes();
+	GraphVersion = Graph.GetLayoutVersion();
+	BakedGraph.Reset();
+	Storage = FStorage();
+	if (NumNodes == 0 || NumLandmarks <= 0)
+	{
+		BindStorage();
+		return;
+	}
+
+	// Farthest point selection. Start from the node furthest from an arbitrary node, then keep adding the node whose
+	// distance to its nearest landmark is largest. Nodes that no landmark reaches yet count as infinitely far so
+	// every separate part of the graph gets a landmark before any part gets a second one.
+	TArray<TArray<float>> FromDistances;
+	TArray<float> NearestLandmarkDistances;
+	NearestLandmarkDistances.Init(UE_MAX_FLT, NumNodes);
+	int32 NextLandmark = FNavigationSearch::FindFurthestNodeByPathDistance(Graph, Workspace, 0);
+	while (NextLandmark != INDEX_NONE && Storage.LandmarkNodes.Num() < NumLandmarks)
+	{
+		Storage.LandmarkNodes.Add(NextLandmark);
+		TArray<float>& Distances = FromDistances.AddDefaulted_GetRef();
+		Distances.Init(UE_MAX_FLT, NumNodes);
+		FNavigationSearch::Dijkstra(Graph, Workspace, MakeArrayView(&NextLandmark, 1), [&Distances, &Workspace](int32 NodeId)
+		{
+			Distances[NodeId] = Workspace.GetGScore(NodeId);
+		});
+
+		NextLandmark = INDEX_NONE;
+		float FurthestDistance = 0.0f;
+		for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+		{
+			NearestLandmarkDistances[NodeId] = FMath::Min(NearestLandmarkDistances[NodeId], Distances[NodeId]);
+			if (NearestLandmarkDistances[NodeId] > FurthestDistance)
+			{
+				FurthestDistance = NearestLandmarkDistances[NodeId];
+				NextLandmark = NodeId;
+			}
+		}
+	}
+
+	const int32 NumPicked = Storage.LandmarkNodes.Num();
+	Storage.FromLandmarkScales.SetNumUninitialized(NumPicked);
+	Storage.ToLandmarkScales.SetNumUninitialized(NumPicked);
+	Storage.FromLandmark.SetNumUninitialized(NumNodes * NumPicked);
+	Storage.ToLandmark.SetNumUninitialized(NumNodes * NumPicked);
+
+	TArray<float> ToDistances;
+	for (int32 LandmarkIndex = 0; LandmarkIndex < NumPicked; ++LandmarkIndex)
+	{
+		Storage.FromLandmarkScales[LandmarkIndex] = QuantiseDistances(FromDistances[LandmarkIndex], NumPicked, Storage.FromLandmark.GetData() + LandmarkIndex);
+
+		// The distances to the landmark come from searching backwards along the edges.
+		ToDistances.Init(UE_MAX_FLT, NumNodes);
+		FNavigationSearch::Dijkstra(Graph, Workspace, MakeArrayView(&Storage.LandmarkNodes[LandmarkIndex], 1), [&ToDistances, &Workspace](int32 NodeId)
+		{
+			ToDistances[NodeId] = Workspace.GetGScore(NodeId);
+		}, ENavigationSearchDirection::Reverse);
+		Storage.ToLandmarkScales[LandmarkIndex] = QuantiseDistances(ToDistances, NumPicked, Storage.ToLandmark.GetData() + LandmarkIndex);
+	}
+
+	BindStorage();
+}
+
+void FNavigationLandmarks::InitFromBaked(const TSharedRef<const FBakedNavigationGraph, ESPMode::ThreadSafe>& InBakedGraph, uint32 InGraphVersion)
+{
+	GraphVersion = InGraphVersion;
+	Storage = FStorage();
+	BakedGraph = InBakedGraph;
+
+	LandmarkNodes = InBakedGraph->GetSection<int32>(FBakedNavigationGraph::ESection::LandmarkNodes);
+	FromLandmarkScales = InBakedGraph->GetSection<float>(FBakedNavigationGraph::ESection::FromLandmarkScales);
+	ToLandmarkScales = InBakedGraph->GetSection<float>(FBakedNavigationGraph::ESection::ToLandmarkScales);
+	FromLandmark = InBakedGraph->GetSection<uint16>(FBakedNavigationGraph::ESection::FromLandmark);
+	ToLandmark = InBakedGraph->GetSection<uint16>(FBakedNavigationGraph::ESection::ToLandmark);
+}
+
+void FNavigationLandmarks::BindStorage()
+{
+	LandmarkNodes = Storage.LandmarkNodes;
+	FromLandmarkScales = Storage.FromLandmarkScales;
+	ToLandmarkScales = Storage.ToLandmarkScales;
+	FromLandmark = Storage.FromLandmark;
+	ToLandmark = Storage.ToLandmark;
+}
+
+float FNavigationLandmarks::GetHeuristic(int32 NodeId, int32 EndNode) const
+{
+	const int32 NumPicked = LandmarkNodes.Num();
+	const uint16* NodeFrom = FromLandmark.GetData() + NodeId * NumPicked;
+	const uint16* NodeTo = ToLandmark.GetData() + NodeId * NumPicked;
+	const uint16* EndFrom = FromLandmark.GetData() + EndNode * NumPicked;
+	const uint16* EndTo = ToLandmark.GetData() + EndNode * NumPicked;
+
+	// Each stored value Q means the real distance is in [Q, Q + 1) steps, so subtracting one extra step keeps both
+	// bounds from overestimating.
+	float Heuristic = 0.0f;
+	for (int32 LandmarkIndex = 0; LandmarkIndex < NumPicked; ++LandmarkIndex)
+	{
+		if (EndFrom[LandmarkIndex] != Unreachable && NodeFrom[LandmarkIndex] != Unreachable)
+		{
+			const int32 Steps = static_cast<int32>(EndFrom[LandmarkIndex]) - NodeFrom[LandmarkIndex] - 1;
+			Heuristic = FMath::Max(Heuristic, Steps * FromLandmarkScales[LandmarkIndex]);
+		}
+		if (NodeTo[LandmarkIndex] != Unreachable && EndTo[LandmarkIndex] != Unreachable)
+		{
+			const int32 Steps = static_cast<int32>(NodeTo[LandmarkIndex]) - EndTo[LandmarkIndex] - 1;
+			Heuristic = FMath::Max(Heuristic, Steps * ToLandmarkScales[LandmarkIndex]);
+		}
+	}
+	return Heuristic;
+}
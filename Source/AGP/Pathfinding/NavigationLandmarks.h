@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FBakedNavigationGraph;
+class FNavigationGraph;
+class FNavigationSearchWorkspace;
+
+/**
+ * The ALT (A*, landmarks and the triangle inequality) heuristic. A few landmark nodes are chosen spread out across the
+ * graph and the path distance from and to each of them is stored for every node. For any landmark L the path cost from
+ * V to T is at least d(L, T) - d(L, V) and at least d(V, L) - d(T, L), which is a much tighter bound than the straight
+ * line distance on maps where paths have to take long detours.
+ *
+ * The distances are quantised to 16 bits per landmark. They are rounded down when stored and the bound takes off one
+ * step of slack so that it still never overestimates.
+ *
+ * The tables are either built or point straight into a baked navigation graph that was loaded from disk.
+ */
+class AGP_API FNavigationLandmarks
+{
+public:
+
+	FNavigationLandmarks() = default;
+	UE_NONCOPYABLE(FNavigationLandmarks);
+
+	/**
+	 * Will pick the landmarks with farthest point selection, each new landmark being the node furthest by path distance
+	 * from all of the landmarks picked so far, and then store the distances from and to each of them.
+	 * @param Graph The graph to build the landmarks for.
+	 * @param Workspace The scratch memory for the searches.
+	 * @param NumLandmarks The number of landmarks to pick. Fewer are picked if the graph is too small.
+	 */
+	void Build(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 NumLandmarks);
+
+	/**
+	 * Will point the landmarks at the tables of a baked navigation graph, without copying them.
+	 * @param InBakedGraph The baked graph to use the tables of. It is kept alive for as long as the landmarks are.
+	 * @param InGraphVersion The layout version of the graph that was loaded from the same baked graph.
+	 */
+	void InitFromBaked(const TSharedRef<const FBakedNavigationGraph, ESPMode::ThreadSafe>& InBakedGraph, uint32 InGraphVersion);
+
+	/**
+	 * @return The layout version of the graph that the landmarks were built from. The bounds stay valid for every
+	 * snapshot with the same layout version, as the runtime changes to the graph only ever make edges more expensive.
+	 */
+	uint32 GetGraphVersion() const
+	{
+		return GraphVersion;
+	}
+
+	int32 GetNumLandmarks() const
+	{
+		return LandmarkNodes.Num();
+	}
+
+	TConstArrayView<int32> GetLandmarkNodes() const
+	{
+		return LandmarkNodes;
+	}
+
+	/**
+	 * @return The number of bytes used by the distance tables, whether they were built or loaded.
+	 */
+	SIZE_T GetAllocatedSize() const
+	{
+		return (FromLandmark.Num() + ToLandmark.Num()) * sizeof(uint16);
+	}
+
+	/**
+	 * @return A lower bound on the path cost from the node to the end node.
+	 */
+	float GetHeuristic(int32 NodeId, int32 EndNode) const;
+
+private:
+
+	// Stored for nodes that can't reach, or can't be reached from, a landmark.
+	static constexpr uint16 Unreachable = MAX_uint16;
+
+	friend class FBakedNavigationGraph;
+
+	/**
+	 * The tables of landmarks that were built rather than loaded.
+	 */
+	struct FStorage
+	{
+		TArray<int32> LandmarkNodes;
+		TArray<float> FromLandmarkScales;
+		TArray<float> ToLandmarkScales;
+		TArray<uint16> FromLandmark;
+		TArray<uint16> ToLandmark;
+	};
+
+	/**
+	 * Will point every table at the Storage.
+	 */
+	void BindStorage();
+
+	uint32 GraphVersion = 0;
+	FStorage Storage;
+	// Keeps the memory that the tables point into alive when the landmarks were loaded.
+	TSharedPtr<const FBakedNavigationGraph, ESPMode::ThreadSafe> BakedGraph;
+
+	TConstArrayView<int32> LandmarkNodes;
+	// The size of one step of the quantised distances of each landmark.
+	TConstArrayView<float> FromLandmarkScales;
+	TConstArrayView<float> ToLandmarkScales;
+	// NumNodes * NumLandmarks entries, with the landmarks of each node next to each other.
+	TConstArrayView<uint16> FromLandmark;
+	TConstArrayView<uint16> ToLandmark;
+};
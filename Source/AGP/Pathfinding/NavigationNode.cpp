@@ -6,9 +6,14 @@
 // Sets default values
 ANavigationNode::ANavigationNode()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+#if WITH_EDITOR
+	// Only ticks in the editor viewports, to draw the connections while they are being edited. Once the game begins
+	// the pathfinding subsystem draws the whole graph in one batch instead, see AGP.Pathfinding.DrawGraph.
 	PrimaryActorTick.bCanEverTick = true;
 	PrimaryActorTick.bStartWithTickEnabled = true;
+#else
+	PrimaryActorTick.bCanEverTick = false;
+#endif
 
 	LocationComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Location Component"));
 	SetRootComponent(LocationComponent);
@@ -19,7 +24,7 @@ ANavigationNode::ANavigationNode()
 void ANavigationNode::BeginPlay()
 {
 	Super::BeginPlay();
-	
+	SetActorTickEnabled(false);
 }
 
 // Called every frame
@@ -27,6 +32,7 @@ void ANavigationNode::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
+#if WITH_EDITOR && ENABLE_DRAW_DEBUG
 	FColor SphereColor = FColor::Blue;
 	if (ConnectedNodes.Contains(this))
 	{
@@ -48,6 +54,7 @@ void ANavigationNode::Tick(float DeltaTime)
 				LineColor, false, -1, 0, 5.0f);
 		}
 	}
+#endif
 }
 
 bool ANavigationNode::ShouldTickIfViewportsOnly() const
@@ -11,7 +11,8 @@ enum class EPointType : uint8
 	Normal      UMETA(DisplayName = "Normal"), 
 	Cover       UMETA(DisplayName = "Cover"), 
 	SpawnPoint  UMETA(DisplayName = "Spawn Point"), 
-	EscapePoint UMETA(DisplayName = "Escape Point") 
+	EscapePoint UMETA(DisplayName = "Escape Point"),
+	MAX         UMETA(Hidden)
 };
 	
 UCLASS()
@@ -20,6 +21,7 @@ class AGP_API ANavigationNode : public AActor
 	GENERATED_BODY()
 
 	friend class UPathfindingSubsystem;
+	friend class ANavigationGraphGenerator;
 	friend class SubSystemAI;
 	
 public:	
@@ -44,4 +46,10 @@ public:
 private:
 	UPROPERTY(EditAnywhere)
 	EPointType NodeType = EPointType::Normal;
+
+	/**
+	 * The index of this node in the UPathfindingSubsystem's Nodes array. Assigned when the subsystem populates its
+	 * nodes so that searches can use compact ids instead of hashing actor pointers.
+	 */
+	int32 NodeIndex = INDEX_NONE;
 };
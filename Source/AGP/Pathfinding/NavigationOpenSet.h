@@ -0,0 +1,191 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * The open set used by the A* search. It is an indexed binary min-heap of node ids ordered by their FScore.
+ * Every node id remembers where it currently sits in the heap so that checking if a node is in the open set and
+ * lowering the FScore of a node that is already in there (decrease-key) are O(1) and O(log V) instead of the
+ * linear searches that a plain TArray needs.
+ *
+ * The key type only needs operator< and operator<=, so searches with compound keys can use it too.
+ */
+template <typename KeyType>
+class TNavigationOpenSet
+{
+public:
+
+	/**
+	 * Empties the open set and makes sure it can hold node ids in the range [0, NumNodes). Only the nodes that were
+	 * still in the open set are touched so this does not cost O(NumNodes) unless the graph has grown.
+	 * @param NumNodes The number of nodes in the graph that is being searched.
+	 */
+	void Reset(int32 NumNodes)
+	{
+		for (const FEntry& Entry : Heap)
+		{
+			HeapIndices[Entry.NodeId] = INDEX_NONE;
+		}
+		Heap.Reset();
+		if (HeapIndices.Num() < NumNodes)
+		{
+			const int32 NumAdded = NumNodes - HeapIndices.Num();
+			HeapIndices.Reserve(NumNodes);
+			for (int32 i = 0; i < NumAdded; ++i)
+			{
+				HeapIndices.Add(INDEX_NONE);
+			}
+			Heap.Reserve(NumNodes);
+		}
+	}
+
+	bool IsEmpty() const
+	{
+		return Heap.IsEmpty();
+	}
+
+	int32 Num() const
+	{
+		return Heap.Num();
+	}
+
+	bool Contains(int32 NodeId) const
+	{
+		return HeapIndices[NodeId] != INDEX_NONE;
+	}
+
+	/**
+	 * Will add the node to the open set or, if it is already in there, update its position for the new key.
+	 * @param NodeId The id of the node to add or update.
+	 * @param Key The FScore of the node.
+	 */
+	void Push(int32 NodeId, KeyType Key)
+	{
+		int32 HeapIndex = HeapIndices[NodeId];
+		if (HeapIndex == INDEX_NONE)
+		{
+			HeapIndex = Heap.Add({Key, NodeId});
+			HeapIndices[NodeId] = HeapIndex;
+			SiftUp(HeapIndex);
+		}
+		else if (Key < Heap[HeapIndex].Key)
+		{
+			Heap[HeapIndex].Key = Key;
+			SiftUp(HeapIndex);
+		}
+		else
+		{
+			Heap[HeapIndex].Key = Key;
+			SiftDown(HeapIndex);
+		}
+	}
+
+	/**
+	 * @return The key of the node that would be returned by Pop. The open set must not be empty.
+	 */
+	KeyType TopKey() const
+	{
+		return Heap[0].Key;
+	}
+
+	/**
+	 * Removes the node with the lowest key from the open set. The open set must not be empty.
+	 * @return The id of the node with the lowest key.
+	 */
+	int32 Pop()
+	{
+		const int32 NodeId = Heap[0].NodeId;
+		HeapIndices[NodeId] = INDEX_NONE;
+		const FEntry Last = Heap.Pop(false);
+		if (!Heap.IsEmpty())
+		{
+			Heap[0] = Last;
+			HeapIndices[Last.NodeId] = 0;
+			SiftDown(0);
+		}
+		return NodeId;
+	}
+
+	/**
+	 * Removes the node from the open set if it is in there.
+	 */
+	void Remove(int32 NodeId)
+	{
+		const int32 HeapIndex = HeapIndices[NodeId];
+		if (HeapIndex == INDEX_NONE)
+		{
+			return;
+		}
+
+		HeapIndices[NodeId] = INDEX_NONE;
+		const FEntry Last = Heap.Pop(false);
+		if (HeapIndex < Heap.Num())
+		{
+			Heap[HeapIndex] = Last;
+			HeapIndices[Last.NodeId] = HeapIndex;
+			SiftUp(HeapIndex);
+			SiftDown(HeapIndices[Last.NodeId]);
+		}
+	}
+
+private:
+
+	struct FEntry
+	{
+		KeyType Key;
+		int32 NodeId;
+	};
+
+	void SiftUp(int32 HeapIndex)
+	{
+		const FEntry Entry = Heap[HeapIndex];
+		while (HeapIndex > 0)
+		{
+			const int32 ParentIndex = (HeapIndex - 1) / 2;
+			if (Heap[ParentIndex].Key <= Entry.Key)
+			{
+				break;
+			}
+			Heap[HeapIndex] = Heap[ParentIndex];
+			HeapIndices[Heap[HeapIndex].NodeId] = HeapIndex;
+			HeapIndex = ParentIndex;
+		}
+		Heap[HeapIndex] = Entry;
+		HeapIndices[Entry.NodeId] = HeapIndex;
+	}
+
+	void SiftDown(int32 HeapIndex)
+	{
+		const FEntry Entry = Heap[HeapIndex];
+		const int32 Count = Heap.Num();
+		while (true)
+		{
+			int32 ChildIndex = 2 * HeapIndex + 1;
+			if (ChildIndex >= Count)
+			{
+				break;
+			}
+			if (ChildIndex + 1 < Count && Heap[ChildIndex + 1].Key < Heap[ChildIndex].Key)
+			{
+				++ChildIndex;
+			}
+			if (Entry.Key <= Heap[ChildIndex].Key)
+			{
+				break;
+			}
+			Heap[HeapIndex] = Heap[ChildIndex];
+			HeapIndices[Heap[HeapIndex].NodeId] = HeapIndex;
+			HeapIndex = ChildIndex;
+		}
+		Heap[HeapIndex] = Entry;
+		HeapIndices[Entry.NodeId] = HeapIndex;
+	}
+
+	TArray<FEntry> Heap;
+	// The position of each node id inside the Heap array or INDEX_NONE if it is not in the open set.
+	TArray<int32> HeapIndices;
+};
+
+typedef TNavigationOpenSet<float> FNavigationOpenSet;
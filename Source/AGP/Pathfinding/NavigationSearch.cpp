@@ -0,0 +1,352 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationSearch.h"
+
+#include "NavigationGoalSet.h"
+#include "NavigationGraph.h"
+#include "NavigationLandmarks.h"
+#include "NavigationSearchWorkspace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+bool FNavigationSearch::FindPath(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath,
+	const FNavigationLandmarks* Landmarks)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FNavigationSearch::FindPath);
+	OutPath.Reset();
+	if (!Graph.IsValidNode(StartNode) || !Graph.IsValidNode(EndNode))
+	{
+		return false;
+	}
+
+	// Every node starts as unvisited so the GScores, HScores and CameFrom of a node are only calculated when the
+	// search first reaches it.
+	Workspace.BeginSearch(Graph.GetNumNodes());
+	FNavigationOpenSet& OpenSet = Workspace.GetOpenSet();
+
+	// Both heuristics never overestimate, so neither does the larger of the two.
+	const auto Heuristic = [&Graph, Landmarks, EndNode](int32 NodeId)
+	{
+		const float StraightLineDistance = Graph.Distance(NodeId, EndNode);
+		return Landmarks ? FMath::Max(StraightLineDistance, Landmarks->GetHeuristic(NodeId, EndNode)) : StraightLineDistance;
+	};
+
+	// Setup the start nodes G and H score.
+	Workspace.Visit(StartNode, Heuristic(StartNode));
+	Workspace.SetGScore(StartNode, 0.0f);
+	OpenSet.Push(StartNode, Workspace.GetHScore(StartNode));
+
+	while (!OpenSet.IsEmpty())
+	{
+		// Remove the node with the lowest FScore from the OpenSet.
+		const int32 CurrentNode = Workspace.ExpandNext();
+
+		if (CurrentNode == EndNode)
+		{
+			// Then we have found the path so reconstruct it and get the positions of each of the nodes in the path.
+			ReconstructPath(Graph, Workspace, EndNode, OutPath);
+			return true;
+		}
+
+		const float CurrentGScore = Workspace.GetGScore(CurrentNode);
+		for (int32 EdgeId = Graph.GetEdgeBegin(CurrentNode); EdgeId < Graph.GetEdgeEnd(CurrentNode); ++EdgeId)
+		{
+			if (Graph.IsEdgeBlocked(EdgeId)) continue;
+			const int32 ConnectedNode = Graph.GetEdgeTarget(EdgeId);
+			const float TentativeGScore = CurrentGScore + Graph.GetEdgeCost(EdgeId);
+			if (!Workspace.IsVisited(ConnectedNode))
+			{
+				Workspace.Visit(ConnectedNode, Heuristic(ConnectedNode));
+			}
+
+			// Then update this nodes scores and came from if the tentative g score is lower than the current g score.
+			if (TentativeGScore < Workspace.GetGScore(ConnectedNode))
+			{
+				Workspace.SetCameFrom(ConnectedNode, CurrentNode);
+				Workspace.SetGScore(ConnectedNode, TentativeGScore);
+				// Then add connected node to the open set, or move it up the heap if it is already in there.
+				OpenSet.Push(ConnectedNode, TentativeGScore + Workspace.GetHScore(ConnectedNode));
+			}
+		}
+	}
+
+	// If we get here, then no path has been found.
+	return false;
+}
+
+bool FNavigationSearch::FindPathBidirectional(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FNavigationSearch::FindPathBidirectional);
+	OutPath.Reset();
+	if (!Graph.IsValidNode(StartNode) || !Graph.IsValidNode(EndNode))
+	{
+		return false;
+	}
+
+	FNavigationSearchWorkspace& ForwardWorkspace = Workspace;
+	FNavigationSearchWorkspace& ReverseWorkspace = Workspace.GetReverseWorkspace();
+	ForwardWorkspace.BeginSearch(Graph.GetNumNodes());
+	ReverseWorkspace.BeginSearch(Graph.GetNumNodes());
+	FNavigationOpenSet& ForwardOpenSet = ForwardWorkspace.GetOpenSet();
+	FNavigationOpenSet& ReverseOpenSet = ReverseWorkspace.GetOpenSet();
+
+	// The forward potential is the average of the distance left to the end and minus the distance from the start,
+	// shifted so it is zero at the end. The reverse potential mirrors it, so the two always add up to the distance
+	// between the ends. Both are consistent, which keeps the keys of either side lower bounds.
+	const float EndsDistance = Graph.Distance(StartNode, EndNode);
+	const auto ForwardPotential = [&Graph, StartNode, EndNode, EndsDistance](int32 NodeId)
+	{
+		return 0.5f * (Graph.Distance(NodeId, EndNode) - Graph.Distance(NodeId, StartNode) + EndsDistance);
+	};
+	const auto ReversePotential = [&ForwardPotential, EndsDistance](int32 NodeId)
+	{
+		return EndsDistance - ForwardPotential(NodeId);
+	};
+
+	ForwardWorkspace.Visit(StartNode, ForwardPotential(StartNode));
+	ForwardWorkspace.SetGScore(StartNode, 0.0f);
+	ForwardOpenSet.Push(StartNode, ForwardWorkspace.GetHScore(StartNode));
+	ReverseWorkspace.Visit(EndNode, ReversePotential(EndNode));
+	ReverseWorkspace.SetGScore(EndNode, 0.0f);
+	ReverseOpenSet.Push(EndNode, ReverseWorkspace.GetHScore(EndNode));
+
+	// The cost of the shortest path found so far and the node where its two halves meet.
+	float BestPathCost = StartNode == EndNode ? 0.0f : UE_MAX_FLT;
+	int32 MeetingNode = StartNode == EndNode ? StartNode : INDEX_NONE;
+
+	while (!ForwardOpenSet.IsEmpty() && !ReverseOpenSet.IsEmpty())
+	{
+		// Any path that hasn't been found yet costs at least the sum of the lowest keys less the sum of the potentials.
+		if (ForwardOpenSet.TopKey() + ReverseOpenSet.TopKey() >= BestPathCost + EndsDistance)
+		{
+			break;
+		}
+
+		// Expand the side with the smaller frontier, which keeps the two searches about the same size.
+		const bool bForward = ForwardOpenSet.Num() <= ReverseOpenSet.Num();
+		FNavigationSearchWorkspace& ThisWorkspace = bForward ? ForwardWorkspace : ReverseWorkspace;
+		const FNavigationSearchWorkspace& OtherWorkspace = bForward ? ReverseWorkspace : ForwardWorkspace;
+		const int32 CurrentNode = ThisWorkspace.ExpandNext();
+		const float CurrentGScore = ThisWorkspace.GetGScore(CurrentNode);
+
+		const auto Relax = [&](int32 ConnectedNode, float EdgeCost)
+		{
+			const float TentativeGScore = CurrentGScore + EdgeCost;
+			if (!ThisWorkspace.IsVisited(ConnectedNode))
+			{
+				ThisWorkspace.Visit(ConnectedNode, bForward ? ForwardPotential(ConnectedNode) : ReversePotential(ConnectedNode));
+			}
+			if (TentativeGScore < ThisWorkspace.GetGScore(ConnectedNode))
+			{
+				ThisWorkspace.SetCameFrom(ConnectedNode, CurrentNode);
+				ThisWorkspace.SetGScore(ConnectedNode, TentativeGScore);
+				ThisWorkspace.GetOpenSet().Push(ConnectedNode, TentativeGScore + ThisWorkspace.GetHScore(ConnectedNode));
+
+				// If the other side has already reached the node then the two halves make a whole path.
+				const float PathCost = TentativeGScore + OtherWorkspace.GetGScore(ConnectedNode);
+				if (PathCost < BestPathCost)
+				{
+					BestPathCost = PathCost;
+					MeetingNode = ConnectedNode;
+				}
+			}
+		};
+
+		if (bForward)
+		{
+			for (int32 EdgeId = Graph.GetEdgeBegin(CurrentNode); EdgeId < Graph.GetEdgeEnd(CurrentNode); ++EdgeId)
+			{
+				if (Graph.IsEdgeBlocked(EdgeId)) continue;
+				Relax(Graph.GetEdgeTarget(EdgeId), Graph.GetEdgeCost(EdgeId));
+			}
+		}
+		else
+		{
+			for (int32 ReverseEdgeId = Graph.GetReverseEdgeBegin(CurrentNode); ReverseEdgeId < Graph.GetReverseEdgeEnd(CurrentNode); ++ReverseEdgeId)
+			{
+				if (Graph.IsReverseEdgeBlocked(ReverseEdgeId)) continue;
+				Relax(Graph.GetReverseEdgeSource(ReverseEdgeId), Graph.GetReverseEdgeCost(ReverseEdgeId));
+			}
+		}
+	}
+
+	if (MeetingNode == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// The path is stored from the end back to the start: the backward half, from the end to the node before the
+	// meeting node, goes first and then the forward half, from the meeting node back to the start.
+	int32 ReverseLength = 0;
+	for (int32 NodeId = ReverseWorkspace.GetCameFrom(MeetingNode); NodeId != INDEX_NONE; NodeId = ReverseWorkspace.GetCameFrom(NodeId))
+	{
+		++ReverseLength;
+	}
+	int32 ForwardLength = 0;
+	for (int32 NodeId = MeetingNode; NodeId != INDEX_NONE; NodeId = ForwardWorkspace.GetCameFrom(NodeId))
+	{
+		++ForwardLength;
+	}
+
+	OutPath.SetNumUninitialized(ReverseLength + ForwardLength);
+	int32 PathIndex = ReverseLength - 1;
+	for (int32 NodeId = ReverseWorkspace.GetCameFrom(MeetingNode); NodeId != INDEX_NONE; NodeId = ReverseWorkspace.GetCameFrom(NodeId))
+	{
+		OutPath[PathIndex--] = Graph.GetNodeLocation(NodeId);
+	}
+	PathIndex = ReverseLength;
+	for (int32 NodeId = MeetingNode; NodeId != INDEX_NONE; NodeId = ForwardWorkspace.GetCameFrom(NodeId))
+	{
+		OutPath[PathIndex++] = Graph.GetNodeLocation(NodeId);
+	}
+	return true;
+}
+
+int32 FNavigationSearch::FindPathToAnyGoal(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 StartNode, const FNavigationGoalSet& Goals, TArray<FVector>& OutPath)
+{
+	TArray<FNavigationGoalCandidate> FoundGoals;
+	FindNearestGoals(Graph, Workspace, StartNode, Goals, 1, FoundGoals);
+	if (FoundGoals.IsEmpty())
+	{
+		OutPath.Reset();
+		return INDEX_NONE;
+	}
+	ReconstructPath(Graph, Workspace, FoundGoals[0].NodeId, OutPath);
+	return FoundGoals[0].NodeId;
+}
+
+void FNavigationSearch::FindNearestGoals(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 StartNode, const FNavigationGoalSet& Goals, int32 MaxGoals, TArray<FNavigationGoalCandidate>& OutGoals)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FNavigationSearch::FindNearestGoals);
+	OutGoals.Reset();
+	if (!Graph.IsValidNode(StartNode) || Goals.IsEmpty() || MaxGoals <= 0)
+	{
+		return;
+	}
+
+	Workspace.BeginSearch(Graph.GetNumNodes());
+	FNavigationOpenSet& OpenSet = Workspace.GetOpenSet();
+
+	Workspace.Visit(StartNode, Goals.GetHeuristic(Graph, StartNode));
+	Workspace.SetGScore(StartNode, 0.0f);
+	OpenSet.Push(StartNode, Workspace.GetHScore(StartNode));
+
+	while (!OpenSet.IsEmpty())
+	{
+		const int32 CurrentNode = Workspace.ExpandNext();
+		const float CurrentGScore = Workspace.GetGScore(CurrentNode);
+
+		// The heuristic is consistent so goals leave the open set in order of their path cost.
+		if (Goals.IsGoal(Graph, CurrentNode))
+		{
+			OutGoals.Add({CurrentNode, CurrentGScore});
+			if (OutGoals.Num() >= MaxGoals)
+			{
+				return;
+			}
+		}
+
+		for (int32 EdgeId = Graph.GetEdgeBegin(CurrentNode); EdgeId < Graph.GetEdgeEnd(CurrentNode); ++EdgeId)
+		{
+			if (Graph.IsEdgeBlocked(EdgeId)) continue;
+			const int32 ConnectedNode = Graph.GetEdgeTarget(EdgeId);
+			const float TentativeGScore = CurrentGScore + Graph.GetEdgeCost(EdgeId);
+			if (!Workspace.IsVisited(ConnectedNode))
+			{
+				Workspace.Visit(ConnectedNode, Goals.GetHeuristic(Graph, ConnectedNode));
+			}
+			if (TentativeGScore < Workspace.GetGScore(ConnectedNode))
+			{
+				Workspace.SetCameFrom(ConnectedNode, CurrentNode);
+				Workspace.SetGScore(ConnectedNode, TentativeGScore);
+				OpenSet.Push(ConnectedNode, TentativeGScore + Workspace.GetHScore(ConnectedNode));
+			}
+		}
+	}
+}
+
+void FNavigationSearch::Dijkstra(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, TConstArrayView<int32> SourceNodes, TFunctionRef<void(int32 NodeId)> OnSettled,
+	ENavigationSearchDirection Direction)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FNavigationSearch::Dijkstra);
+	Workspace.BeginSearch(Graph.GetNumNodes());
+	FNavigationOpenSet& OpenSet = Workspace.GetOpenSet();
+	for (const int32 SourceNode : SourceNodes)
+	{
+		if (!Graph.IsValidNode(SourceNode)) continue;
+		Workspace.Visit(SourceNode, 0.0f);
+		Workspace.SetGScore(SourceNode, 0.0f);
+		OpenSet.Push(SourceNode, 0.0f);
+	}
+
+	const auto Relax = [&Workspace, &OpenSet](int32 CurrentNode, int32 ConnectedNode, float TentativeGScore)
+	{
+		if (!Workspace.IsVisited(ConnectedNode))
+		{
+			Workspace.Visit(ConnectedNode, 0.0f);
+		}
+		if (TentativeGScore < Workspace.GetGScore(ConnectedNode))
+		{
+			Workspace.SetCameFrom(ConnectedNode, CurrentNode);
+			Workspace.SetGScore(ConnectedNode, TentativeGScore);
+			OpenSet.Push(ConnectedNode, TentativeGScore);
+		}
+	};
+
+	while (!OpenSet.IsEmpty())
+	{
+		// Nodes leave the open set in order of their path distance.
+		const int32 CurrentNode = Workspace.ExpandNext();
+		OnSettled(CurrentNode);
+
+		const float CurrentGScore = Workspace.GetGScore(CurrentNode);
+		if (Direction == ENavigationSearchDirection::Forward)
+		{
+			for (int32 EdgeId = Graph.GetEdgeBegin(CurrentNode); EdgeId < Graph.GetEdgeEnd(CurrentNode); ++EdgeId)
+			{
+				if (Graph.IsEdgeBlocked(EdgeId)) continue;
+				Relax(CurrentNode, Graph.GetEdgeTarget(EdgeId), CurrentGScore + Graph.GetEdgeCost(EdgeId));
+			}
+		}
+		else
+		{
+			for (int32 EdgeId = Graph.GetReverseEdgeBegin(CurrentNode); EdgeId < Graph.GetReverseEdgeEnd(CurrentNode); ++EdgeId)
+			{
+				if (Graph.IsReverseEdgeBlocked(EdgeId)) continue;
+				Relax(CurrentNode, Graph.GetReverseEdgeSource(EdgeId), CurrentGScore + Graph.GetReverseEdgeCost(EdgeId));
+			}
+		}
+	}
+}
+
+int32 FNavigationSearch::FindFurthestNodeByPathDistance(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 SourceNode)
+{
+	if (!Graph.IsValidNode(SourceNode))
+	{
+		return INDEX_NONE;
+	}
+
+	// The last node to be settled is the furthest away.
+	int32 FurthestNode = SourceNode;
+	Dijkstra(Graph, Workspace, MakeArrayView(&SourceNode, 1), [&FurthestNode](int32 NodeId)
+	{
+		FurthestNode = NodeId;
+	});
+	return FurthestNode;
+}
+
+void FNavigationSearch::ReconstructPath(const FNavigationGraph& Graph, const FNavigationSearchWorkspace& Workspace, int32 EndNode, TArray<FVector>& OutPath)
+{
+	// Count the steps first so that the path is only allocated once.
+	int32 PathLength = 0;
+	for (int32 NextNode = EndNode; NextNode != INDEX_NONE; NextNode = Workspace.GetCameFrom(NextNode))
+	{
+		++PathLength;
+	}
+
+	OutPath.Reset(PathLength);
+	for (int32 NextNode = EndNode; NextNode != INDEX_NONE; NextNode = Workspace.GetCameFrom(NextNode))
+	{
+		OutPath.Push(Graph.GetNodeLocation(NextNode));
+	}
+}
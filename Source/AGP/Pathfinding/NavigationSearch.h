@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FNavigationGoalSet;
+class FNavigationGraph;
+class FNavigationLandmarks;
+class FNavigationSearchWorkspace;
+
+/**
+ * A goal node reached by a multi-goal search and the cost of the shortest path to it.
+ */
+struct FNavigationGoalCandidate
+{
+	int32 NodeId = INDEX_NONE;
+	float PathCost = 0.0f;
+};
+
+/**
+ * Which way a search follows the edges of the graph.
+ */
+enum class ENavigationSearchDirection : uint8
+{
+	// Along the edges, measuring the distance from the source nodes.
+	Forward,
+	// Against the edges, measuring the distance to the source nodes.
+	Reverse
+};
+
+/**
+ * The search algorithms that run on an FNavigationGraph. They only read the graph and write to the workspace they
+ * are given so several searches can run at the same time as long as each one has its own workspace.
+ */
+struct AGP_API FNavigationSearch
+{
+	/**
+	 * Will find the shortest path between two nodes using A* with a straight line distance heuristic, tightened with
+	 * the landmark heuristic if landmarks are given.
+	 * @param Graph The graph to search.
+	 * @param Workspace The scratch memory for the search.
+	 * @param StartNode The node id that the path will start at.
+	 * @param EndNode The node id that the path will end at.
+	 * @param OutPath Will be filled with the node locations along the path, in reverse order. Empty if there is no path.
+	 * @param Landmarks Optional landmarks that were built from the same graph.
+	 * @return true if a path was found.
+	 */
+	static bool FindPath(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath,
+		const FNavigationLandmarks* Landmarks = nullptr);
+
+	/**
+	 * Will find the shortest path between two nodes with a bidirectional A* search: one search forwards from the
+	 * StartNode and one backwards, over the incoming edges, from the EndNode, taking turns until they meet. Both use
+	 * the average of the straight line distances to either end (balanced potentials), which keeps the two searches
+	 * consistent with each other so the search can stop as soon as neither side can find anything shorter. Expands
+	 * fewer nodes than FindPath on long paths. The backward search uses the reverse workspace of the Workspace, so the
+	 * total number of nodes expanded is the sum of the two.
+	 * @param Graph The graph to search.
+	 * @param Workspace The scratch memory for the search.
+	 * @param StartNode The node id that the path will start at.
+	 * @param EndNode The node id that the path will end at.
+	 * @param OutPath Will be filled with the node locations along the path, in reverse order. Empty if there is no path.
+	 * @return true if a path was found.
+	 */
+	static bool FindPathBidirectional(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath);
+
+	/**
+	 * Will find the shortest path from the StartNode to whichever goal node is cheapest to reach, using A* with the
+	 * straight line distance to the nearest goal as the heuristic.
+	 * @param Graph The graph to search.
+	 * @param Workspace The scratch memory for the search.
+	 * @param StartNode The node id that the path will start at.
+	 * @param Goals The nodes that the path may end at.
+	 * @param OutPath Will be filled with the node locations along the path, in reverse order. Empty if there is no path.
+	 * @return The goal node that the path ends at, or INDEX_NONE if no goal can be reached.
+	 */
+	static int32 FindPathToAnyGoal(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 StartNode, const FNavigationGoalSet& Goals, TArray<FVector>& OutPath);
+
+	/**
+	 * Will find the MaxGoals goal nodes that are cheapest to reach from the StartNode with a single A* search. The
+	 * search carries on past the first goal, so scoring several candidates doesn't need a search for each one. The path
+	 * to each candidate can be read back with ReconstructPath until the workspace is used again.
+	 * @param Graph The graph to search.
+	 * @param Workspace The scratch memory for the search.
+	 * @param StartNode The node id that the paths start at.
+	 * @param Goals The nodes that can be candidates.
+	 * @param MaxGoals The maximum number of candidates to find.
+	 * @param OutGoals Will be filled with up to MaxGoals candidates, sorted from cheapest to most expensive.
+	 */
+	static void FindNearestGoals(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 StartNode, const FNavigationGoalSet& Goals, int32 MaxGoals, TArray<FNavigationGoalCandidate>& OutGoals);
+
+	/**
+	 * Will run Dijkstra's algorithm out from the SourceNodes over the whole graph. When it returns, the GScore and
+	 * CameFrom of every reachable node are left in the workspace. In the Reverse direction the CameFrom of a node is
+	 * the next node on its shortest path to the nearest source node.
+	 * @param Graph The graph to search.
+	 * @param Workspace The scratch memory for the search.
+	 * @param SourceNodes The node ids that start with a distance of zero.
+	 * @param OnSettled Called with each node id as soon as its shortest distance is known, in order of distance.
+	 * @param Direction Whether to follow the edges forwards or backwards.
+	 */
+	static void Dijkstra(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, TConstArrayView<int32> SourceNodes, TFunctionRef<void(int32 NodeId)> OnSettled,
+		ENavigationSearchDirection Direction = ENavigationSearchDirection::Forward);
+
+	/**
+	 * Will run Dijkstra's algorithm out from the SourceNode and find the node that takes the longest path to reach.
+	 * Nodes that cannot be reached from the SourceNode are ignored.
+	 * @param Graph The graph to search.
+	 * @param Workspace The scratch memory for the search.
+	 * @param SourceNode The node id that the path distances are measured from.
+	 * @return The id of the reachable node with the largest path distance or INDEX_NONE if the SourceNode is invalid.
+	 */
+	static int32 FindFurthestNodeByPathDistance(const FNavigationGraph& Graph, FNavigationSearchWorkspace& Workspace, int32 SourceNode);
+
+	/**
+	 * Will follow the CameFrom entries of the workspace back from the EndNode and write the node locations, in
+	 * reverse order, into OutPath.
+	 */
+	static void ReconstructPath(const FNavigationGraph& Graph, const FNavigationSearchWorkspace& Workspace, int32 EndNode, TArray<FVector>& OutPath);
+};
@@ -0,0 +1,55 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationSearchWorkspace.h"
+
+void FNavigationSearchWorkspace::BeginSearch(int32 NumNodes)
+{
+	if (Generations.Num() < NumNodes)
+	{
+		// Only happens the first time the workspace is used or if the graph has grown since.
+		Generations.SetNumZeroed(NumNodes);
+		GScores.SetNumUninitialized(NumNodes);
+		HScores.SetNumUninitialized(NumNodes);
+		CameFrom.SetNumUninitialized(NumNodes);
+	}
+
+	++Generation;
+	if (Generation == 0)
+	{
+		// The generation counter wrapped around so stamps from ~4 billion searches ago would look current again.
+		FMemory::Memzero(Generations.GetData(), Generations.Num() * sizeof(uint32));
+		Generation = 1;
+	}
+
+	OpenSet.Reset(NumNodes);
+	NumExpanded = 0;
+	PeakOpenSetSize = 0;
+}
+
+FNavigationSearchWorkspace& FNavigationSearchWorkspace::GetReverseWorkspace()
+{
+	if (!ReverseWorkspace)
+	{
+		ReverseWorkspace = MakeUnique<FNavigationSearchWorkspace>();
+	}
+	return *ReverseWorkspace;
+}
+
+TUniquePtr<FNavigationSearchWorkspace> FNavigationSearchWorkspacePool::Acquire()
+{
+	{
+		FScopeLock Lock(&CriticalSection);
+		if (!FreeWorkspaces.IsEmpty())
+		{
+			return FreeWorkspaces.Pop(false);
+		}
+	}
+	return MakeUnique<FNavigationSearchWorkspace>();
+}
+
+void FNavigationSearchWorkspacePool::Release(TUniquePtr<FNavigationSearchWorkspace>&& Workspace)
+{
+	FScopeLock Lock(&CriticalSection);
+	FreeWorkspaces.Add(MoveTemp(Workspace));
+}
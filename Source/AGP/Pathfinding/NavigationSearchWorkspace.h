@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavigationOpenSet.h"
+
+/**
+ * The per-node scratch memory that a search needs (GScores, HScores, CameFrom and the open set), stored in flat
+ * arrays indexed by node id. Instead of clearing the arrays before every search, each node is stamped with the
+ * generation of the search that last wrote to it, so anything stamped with an older generation reads as unvisited.
+ * Once the arrays have grown to the size of the graph a search does not allocate any memory.
+ *
+ * A workspace must only be used by one search at a time. Use FNavigationSearchWorkspacePool to get one per thread.
+ */
+class AGP_API FNavigationSearchWorkspace
+{
+public:
+
+	/**
+	 * Starts a new search over a graph with NumNodes nodes. All nodes become unvisited and the open set is emptied.
+	 */
+	void BeginSearch(int32 NumNodes);
+
+	bool IsVisited(int32 NodeId) const
+	{
+		return Generations[NodeId] == Generation;
+	}
+
+	/**
+	 * Marks the node as visited by the current search with an infinite GScore, the given HScore and no CameFrom.
+	 */
+	void Visit(int32 NodeId, float HScore)
+	{
+		Generations[NodeId] = Generation;
+		GScores[NodeId] = UE_MAX_FLT;
+		HScores[NodeId] = HScore;
+		CameFrom[NodeId] = INDEX_NONE;
+	}
+
+	float GetGScore(int32 NodeId) const
+	{
+		return IsVisited(NodeId) ? GScores[NodeId] : UE_MAX_FLT;
+	}
+
+	// The following accessors are only valid for nodes that have been visited by the current search.
+	float GetHScore(int32 NodeId) const { return HScores[NodeId]; }
+	int32 GetCameFrom(int32 NodeId) const { return CameFrom[NodeId]; }
+	void SetGScore(int32 NodeId, float GScore) { GScores[NodeId] = GScore; }
+	void SetCameFrom(int32 NodeId, int32 FromNodeId) { CameFrom[NodeId] = FromNodeId; }
+
+	FNavigationOpenSet& GetOpenSet()
+	{
+		return OpenSet;
+	}
+
+	/**
+	 * Pops the node with the lowest key from the open set and counts it as expanded.
+	 */
+	int32 ExpandNext()
+	{
+		++NumExpanded;
+		PeakOpenSetSize = FMath::Max(PeakOpenSetSize, OpenSet.Num());
+		return OpenSet.Pop();
+	}
+
+	/**
+	 * @return The number of nodes that the current search has taken out of the open set.
+	 */
+	int32 GetNumExpanded() const
+	{
+		return NumExpanded;
+	}
+
+	/**
+	 * @return The largest that the open set of the current search has been before a node was expanded.
+	 */
+	int32 GetPeakOpenSetSize() const
+	{
+		return PeakOpenSetSize;
+	}
+
+	/**
+	 * @return A second workspace owned by this one, for the backward half of a bidirectional search. Created the first
+	 * time it is asked for.
+	 */
+	FNavigationSearchWorkspace& GetReverseWorkspace();
+
+private:
+
+	TArray<uint32> Generations;
+	TArray<float> GScores;
+	TArray<float> HScores;
+	TArray<int32> CameFrom;
+	FNavigationOpenSet OpenSet;
+	uint32 Generation = 0;
+	int32 NumExpanded = 0;
+	int32 PeakOpenSetSize = 0;
+	TUniquePtr<FNavigationSearchWorkspace> ReverseWorkspace;
+};
+
+/**
+ * A thread safe pool of search workspaces. Each concurrent search takes its own workspace out of the pool and returns
+ * it when it is done, so the pool ends up with one workspace per thread that has searched at the same time.
+ */
+class AGP_API FNavigationSearchWorkspacePool
+{
+public:
+
+	/**
+	 * Gives a workspace back to the pool when it goes out of scope.
+	 */
+	class FScopedWorkspace
+	{
+	public:
+		explicit FScopedWorkspace(FNavigationSearchWorkspacePool& InPool)
+			: Pool(InPool), Workspace(InPool.Acquire())
+		{
+		}
+
+		~FScopedWorkspace()
+		{
+			Pool.Release(MoveTemp(Workspace));
+		}
+
+		FNavigationSearchWorkspace& Get() const
+		{
+			return *Workspace;
+		}
+
+	private:
+		FNavigationSearchWorkspacePool& Pool;
+		TUniquePtr<FNavigationSearchWorkspace> Workspace;
+	};
+
+	TUniquePtr<FNavigationSearchWorkspace> Acquire();
+	void Release(TUniquePtr<FNavigationSearchWorkspace>&& Workspace);
+
+private:
+
+	FCriticalSection CriticalSection;
+	TArray<TUniquePtr<FNavigationSearchWorkspace>> FreeWorkspaces;
+};
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavigationGraph.h"
+
+class FContractionHierarchy;
+class FNavigationDistanceFields;
+class FNavigationHierarchy;
+class FNavigationLandmarks;
+class FNavigationSpatialIndex;
+class FNextHopTable;
+
+/**
+ * Everything that a path query reads for one version of the navigation graph: the graph itself, the spatial indices
+ * over its nodes and whichever structures have been precomputed from it. A snapshot is never changed once it has been
+ * published, so a worker holds on to the one that was current when its query was made while the game thread moves on
+ * to newer ones. The parts that haven't changed between two versions are shared by their snapshots.
+ *
+ * The precomputed structures may have been built for an older version of the graph, so each one is only used while
+ * its version matches the Graph.
+ */
+struct FNavigationSnapshot
+{
+	FNavigationGraphPtr Graph;
+	TSharedPtr<const FNavigationSpatialIndex, ESPMode::ThreadSafe> SpatialIndex;
+	TSharedPtr<const FNavigationDistanceFields, ESPMode::ThreadSafe> DistanceFields;
+	TSharedPtr<const FNextHopTable, ESPMode::ThreadSafe> NextHopTable;
+	TSharedPtr<const FNavigationLandmarks, ESPMode::ThreadSafe> Landmarks;
+	TSharedPtr<const FContractionHierarchy, ESPMode::ThreadSafe> ContractionHierarchy;
+	TSharedPtr<const FNavigationHierarchy, ESPMode::ThreadSafe> NavigationHierarchy;
+};
+
+typedef TSharedPtr<const FNavigationSnapshot, ESPMode::ThreadSafe> FNavigationSnapshotPtr;
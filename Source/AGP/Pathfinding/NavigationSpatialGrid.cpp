@@ -0,0 +1,288 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationSpatialGrid.h"
+
+#include "NavigationGraph.h"
+
+namespace
+{
+	// Roughly how many nodes should end up in each cell.
+	constexpr float NodesPerCell = 2.0f;
+	constexpr int32 MaxCellsPerAxis = 1024;
+}
+
+void FNavigationSpatialGrid::Build(const FNavigationGraph& Graph, TConstArrayView<int32> InNodeIds)
+{
+	CellStarts.Reset();
+	NodeIds.Reset();
+	ItemsX.Reset();
+	ItemsY.Reset();
+	ItemsZ.Reset();
+	Dimensions = FIntVector::ZeroValue;
+
+	const int32 NumItems = InNodeIds.Num();
+	if (NumItems == 0)
+	{
+		return;
+	}
+
+	FBox3f Bounds(ForceInit);
+	for (const int32 NodeId : InNodeIds)
+	{
+		Bounds += FVector3f(Graph.GetNodeLocation(NodeId));
+	}
+	const FVector3f Extent = Bounds.GetSize();
+	const float Extents[3] = {Extent.X, Extent.Y, Extent.Z};
+
+	// Pick the cell size so that there are about NodesPerCell nodes in each cell. Axes that are thinner than a cell,
+	// such as the height of a mostly flat level, are left out and only get a single layer of cells.
+	const double TargetCells = FMath::Max(1.0, static_cast<double>(NumItems) / NodesPerCell);
+	bool bUseAxis[3] = {true, true, true};
+	for (int32 Iteration = 0; Iteration < 3; ++Iteration)
+	{
+		double Volume = 1.0;
+		int32 NumAxes = 0;
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			if (bUseAxis[Axis])
+			{
+				Volume *= FMath::Max(Extents[Axis], 1.0f);
+				++NumAxes;
+			}
+		}
+		if (NumAxes == 0) break;
+
+		CellSize = FMath::Max(1.0f, static_cast<float>(FMath::Pow(Volume / TargetCells, 1.0 / NumAxes)));
+		bool bChanged = false;
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			if (bUseAxis[Axis] && Extents[Axis] < CellSize)
+			{
+				bUseAxis[Axis] = false;
+				bChanged = true;
+			}
+		}
+		if (!bChanged) break;
+	}
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		CellSize = FMath::Max(CellSize, Extents[Axis] / (MaxCellsPerAxis - 1));
+	}
+
+	Origin = Bounds.Min;
+	Dimensions = FIntVector(
+		FMath::FloorToInt32(Extent.X / CellSize) + 1,
+		FMath::FloorToInt32(Extent.Y / CellSize) + 1,
+		FMath::FloorToInt32(Extent.Z / CellSize) + 1);
+	const int32 NumCells = Dimensions.X * Dimensions.Y * Dimensions.Z;
+
+	// Counting sort of the nodes by the cell they are in.
+	TArray<int32> ItemCells;
+	ItemCells.SetNumUninitialized(NumItems);
+	CellStarts.SetNumZeroed(NumCells + 1);
+	for (int32 Item = 0; Item < NumItems; ++Item)
+	{
+		const FIntVector Cell = GetCellCoordinates(FVector3f(Graph.GetNodeLocation(InNodeIds[Item])));
+		ItemCells[Item] = GetCellIndex(Cell.X, Cell.Y, Cell.Z);
+		++CellStarts[ItemCells[Item] + 1];
+	}
+	for (int32 CellIndex = 0; CellIndex < NumCells; ++CellIndex)
+	{
+		CellStarts[CellIndex + 1] += CellStarts[CellIndex];
+	}
+
+	NodeIds.SetNumUninitialized(NumItems);
+	ItemsX.SetNumUninitialized(NumItems);
+	ItemsY.SetNumUninitialized(NumItems);
+	ItemsZ.SetNumUninitialized(NumItems);
+	TArray<int32> CellCursors(CellStarts.GetData(), NumCells);
+	for (int32 Item = 0; Item < NumItems; ++Item)
+	{
+		const int32 SortedItem = CellCursors[ItemCells[Item]]++;
+		const FVector3f Location(Graph.GetNodeLocation(InNodeIds[Item]));
+		NodeIds[SortedItem] = InNodeIds[Item];
+		ItemsX[SortedItem] = Location.X;
+		ItemsY[SortedItem] = Location.Y;
+		ItemsZ[SortedItem] = Location.Z;
+	}
+}
+
+FIntVector FNavigationSpatialGrid::GetCellCoordinates(const FVector3f& Location) const
+{
+	const FVector3f Local = (Location - Origin) / CellSize;
+	return FIntVector(
+		FMath::Clamp(FMath::FloorToInt32(Local.X), 0, Dimensions.X - 1),
+		FMath::Clamp(FMath::FloorToInt32(Local.Y), 0, Dimensions.Y - 1),
+		FMath::Clamp(FMath::FloorToInt32(Local.Z), 0, Dimensions.Z - 1));
+}
+
+template <typename VisitorType>
+bool FNavigationSpatialGrid::ForEachCellInRing(const FIntVector& Centre, int32 Ring, VisitorType&& Visitor) const
+{
+	const int32 MinX = FMath::Max(Centre.X - Ring, 0);
+	const int32 MaxX = FMath::Min(Centre.X + Ring, Dimensions.X - 1);
+	const int32 MinY = FMath::Max(Centre.Y - Ring, 0);
+	const int32 MaxY = FMath::Min(Centre.Y + Ring, Dimensions.Y - 1);
+	const int32 MinZ = FMath::Max(Centre.Z - Ring, 0);
+	const int32 MaxZ = FMath::Min(Centre.Z + Ring, Dimensions.Z - 1);
+	bool bVisitedAny = false;
+	for (int32 Z = MinZ; Z <= MaxZ; ++Z)
+	{
+		const bool bZOnRing = FMath::Abs(Z - Centre.Z) == Ring;
+		for (int32 Y = MinY; Y <= MaxY; ++Y)
+		{
+			if (bZOnRing || FMath::Abs(Y - Centre.Y) == Ring)
+			{
+				// The whole row is on the surface of the ring.
+				for (int32 X = MinX; X <= MaxX; ++X)
+				{
+					Visitor(GetCellIndex(X, Y, Z));
+					bVisitedAny = true;
+				}
+			}
+			else
+			{
+				// Only the two ends of the row are on the surface of the ring.
+				if (Centre.X - Ring >= 0)
+				{
+					Visitor(GetCellIndex(Centre.X - Ring, Y, Z));
+					bVisitedAny = true;
+				}
+				if (Ring > 0 && Centre.X + Ring < Dimensions.X)
+				{
+					Visitor(GetCellIndex(Centre.X + Ring, Y, Z));
+					bVisitedAny = true;
+				}
+			}
+		}
+	}
+	return bVisitedAny;
+}
+
+int32 FNavigationSpatialGrid::FindNearest(const FVector& Location) const
+{
+	if (IsEmpty())
+	{
+		return INDEX_NONE;
+	}
+
+	const FVector3f QueryLocation(Location);
+	const FIntVector Centre = GetCellCoordinates(QueryLocation);
+	int32 BestItem = INDEX_NONE;
+	float BestDistanceSquared = MAX_flt;
+	const int32 MaxRing = Dimensions.GetMax();
+	for (int32 Ring = 0; Ring <= MaxRing; ++Ring)
+	{
+		const bool bRingInsideGrid = ForEachCellInRing(Centre, Ring, [&](int32 CellIndex)
+		{
+			for (int32 Item = CellStarts[CellIndex]; Item < CellStarts[CellIndex + 1]; ++Item)
+			{
+				const float ItemDistanceSquared = DistanceSquared(Item, QueryLocation);
+				if (ItemDistanceSquared < BestDistanceSquared)
+				{
+					BestDistanceSquared = ItemDistanceSquared;
+					BestItem = Item;
+				}
+			}
+		});
+
+		// Every cell in the next ring is at least Ring cells away from the query location so nothing in there can beat
+		// a node that is already this close. Once a ring is completely outside of the grid every cell has been visited.
+		const float RingDistance = Ring * CellSize;
+		if (!bRingInsideGrid || (BestItem != INDEX_NONE && BestDistanceSquared <= RingDistance * RingDistance))
+		{
+			break;
+		}
+	}
+
+	return NodeIds[BestItem];
+}
+
+void FNavigationSpatialGrid::FindKNearest(const FVector& Location, int32 K, TArray<int32>& OutNodeIds) const
+{
+	OutNodeIds.Reset();
+	K = FMath::Min(K, Num());
+	if (K <= 0)
+	{
+		return;
+	}
+
+	// A max-heap of the best candidates so far with the furthest one at the top.
+	const auto FurtherFirst = [](const FCandidate& A, const FCandidate& B)
+	{
+		return A.DistanceSquared > B.DistanceSquared;
+	};
+	TArray<FCandidate, TInlineAllocator<32>> Candidates;
+	Candidates.Reserve(K);
+
+	const FVector3f QueryLocation(Location);
+	const FIntVector Centre = GetCellCoordinates(QueryLocation);
+	const int32 MaxRing = Dimensions.GetMax();
+	for (int32 Ring = 0; Ring <= MaxRing; ++Ring)
+	{
+		const bool bRingInsideGrid = ForEachCellInRing(Centre, Ring, [&](int32 CellIndex)
+		{
+			for (int32 Item = CellStarts[CellIndex]; Item < CellStarts[CellIndex + 1]; ++Item)
+			{
+				const float ItemDistanceSquared = DistanceSquared(Item, QueryLocation);
+				if (Candidates.Num() < K)
+				{
+					Candidates.HeapPush({ItemDistanceSquared, Item}, FurtherFirst);
+				}
+				else if (ItemDistanceSquared < Candidates.HeapTop().DistanceSquared)
+				{
+					Candidates.HeapPopDiscard(FurtherFirst, false);
+					Candidates.HeapPush({ItemDistanceSquared, Item}, FurtherFirst);
+				}
+			}
+		});
+
+		const float RingDistance = Ring * CellSize;
+		if (!bRingInsideGrid || (Candidates.Num() == K && Candidates.HeapTop().DistanceSquared <= RingDistance * RingDistance))
+		{
+			break;
+		}
+	}
+
+	Candidates.Sort([](const FCandidate& A, const FCandidate& B)
+	{
+		return A.DistanceSquared < B.DistanceSquared;
+	});
+	OutNodeIds.Reserve(Candidates.Num());
+	for (const FCandidate& Candidate : Candidates)
+	{
+		OutNodeIds.Add(NodeIds[Candidate.Item]);
+	}
+}
+
+void FNavigationSpatialGrid::FindInRadius(const FVector& Location, float Radius, TArray<int32>& OutNodeIds) const
+{
+	OutNodeIds.Reset();
+	if (IsEmpty() || Radius < 0.0f)
+	{
+		return;
+	}
+
+	const FVector3f QueryLocation(Location);
+	const float RadiusSquared = Radius * Radius;
+	const FIntVector MinCell = GetCellCoordinates(QueryLocation - FVector3f(Radius));
+	const FIntVector MaxCell = GetCellCoordinates(QueryLocation + FVector3f(Radius));
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+			{
+				const int32 CellIndex = GetCellIndex(X, Y, Z);
+				for (int32 Item = CellStarts[CellIndex]; Item < CellStarts[CellIndex + 1]; ++Item)
+				{
+					if (DistanceSquared(Item, QueryLocation) <= RadiusSquared)
+					{
+						OutNodeIds.Add(NodeIds[Item]);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FNavigationGraph;
+
+/**
+ * A uniform grid over a set of nodes of an FNavigationGraph that answers exact nearest, k-nearest and radius queries
+ * without looking at every node. The nodes are sorted by cell and their positions are copied next to their ids so a
+ * query only reads the cells around the query location.
+ */
+class AGP_API FNavigationSpatialGrid
+{
+public:
+
+	/**
+	 * Will build the grid over the given nodes of the graph. Any previous contents are thrown away.
+	 * @param Graph The graph that the node ids belong to.
+	 * @param NodeIds The ids of the nodes to put in the grid.
+	 */
+	void Build(const FNavigationGraph& Graph, TConstArrayView<int32> NodeIds);
+
+	bool IsEmpty() const
+	{
+		return NodeIds.IsEmpty();
+	}
+
+	int32 Num() const
+	{
+		return NodeIds.Num();
+	}
+
+	/**
+	 * @param Location The location to search around.
+	 * @return The id of the node closest to the Location or INDEX_NONE if the grid is empty.
+	 */
+	int32 FindNearest(const FVector& Location) const;
+
+	/**
+	 * Will find the K nodes closest to the Location.
+	 * @param Location The location to search around.
+	 * @param K The maximum number of nodes to find.
+	 * @param OutNodeIds Will be filled with up to K node ids, sorted from closest to furthest.
+	 */
+	void FindKNearest(const FVector& Location, int32 K, TArray<int32>& OutNodeIds) const;
+
+	/**
+	 * Will find all of the nodes within the Radius of the Location.
+	 * @param Location The centre of the search.
+	 * @param Radius The maximum distance of the nodes from the Location.
+	 * @param OutNodeIds Will be filled with the node ids in no particular order.
+	 */
+	void FindInRadius(const FVector& Location, float Radius, TArray<int32>& OutNodeIds) const;
+
+private:
+
+	struct FCandidate
+	{
+		float DistanceSquared;
+		int32 Item;
+	};
+
+	FIntVector GetCellCoordinates(const FVector3f& Location) const;
+
+	int32 GetCellIndex(int32 X, int32 Y, int32 Z) const
+	{
+		return (Z * Dimensions.Y + Y) * Dimensions.X + X;
+	}
+
+	float DistanceSquared(int32 Item, const FVector3f& Location) const
+	{
+		const float DX = ItemsX[Item] - Location.X;
+		const float DY = ItemsY[Item] - Location.Y;
+		const float DZ = ItemsZ[Item] - Location.Z;
+		return DX * DX + DY * DY + DZ * DZ;
+	}
+
+	/**
+	 * Calls Visitor for every cell whose Chebyshev distance from the Centre cell is exactly Ring.
+	 * @return false if the ring lies completely outside of the grid, in which case no cell was visited.
+	 */
+	template <typename VisitorType>
+	bool ForEachCellInRing(const FIntVector& Centre, int32 Ring, VisitorType&& Visitor) const;
+
+	FVector3f Origin = FVector3f::ZeroVector;
+	float CellSize = 1.0f;
+	FIntVector Dimensions = FIntVector::ZeroValue;
+
+	// NumCells + 1 offsets into the item arrays. The items of cell C are in the range [CellStarts[C], CellStarts[C + 1]).
+	TArray<int32> CellStarts;
+	TArray<int32> NodeIds;
+	TArray<float> ItemsX;
+	TArray<float> ItemsY;
+	TArray<float> ItemsZ;
+};
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationSpatialIndex.h"
+
+#include "NavigationGraph.h"
+
+void FNavigationSpatialIndex::Build(const FNavigationGraph& Graph)
+{
+	LayoutVersion = Graph.GetLayoutVersion();
+
+	TArray<FVector> Locations;
+	TArray<int32> NodeIds;
+	TArray<int32> PointTypeNodeIds[static_cast<int32>(EPointType::MAX)];
+	Locations.Reserve(Graph.GetNumNodes());
+	NodeIds.Reserve(Graph.GetNumNodes());
+	for (int32 NodeId = 0; NodeId < Graph.GetNumNodes(); ++NodeId)
+	{
+		Locations.Add(Graph.GetNodeLocation(NodeId));
+		NodeIds.Add(NodeId);
+		PointTypeNodeIds[static_cast<int32>(Graph.GetNodeType(NodeId))].Add(NodeId);
+	}
+	NodeGrid.Build(Graph, NodeIds);
+	NodeFurthestTree.Build(Locations, NodeIds);
+	for (int32 PointType = 0; PointType < static_cast<int32>(EPointType::MAX); ++PointType)
+	{
+		PointTypeGrids[PointType].Build(Graph, PointTypeNodeIds[PointType]);
+	}
+}
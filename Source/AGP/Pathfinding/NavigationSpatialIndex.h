@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+#include "FurthestPointTree.h"
+#include "NavigationNode.h"
+#include "NavigationSpatialGrid.h"
+
+class FNavigationGraph;
+
+/**
+ * The spatial indices over the nodes of a graph that the nearest and furthest node lookups use: a grid over every
+ * node, a grid over the nodes of each EPointType and a tree for the furthest node. They only depend on where the nodes
+ * are and what type they are, so one spatial index is shared by every snapshot with the same layout version. It is
+ * never changed once it is built, so any thread can query it.
+ */
+class AGP_API FNavigationSpatialIndex
+{
+public:
+
+	/**
+	 * Will build the indices over every node of the graph.
+	 * @param Graph The graph to build the indices for.
+	 */
+	void Build(const FNavigationGraph& Graph);
+
+	/**
+	 * @return The layout version of the graph that the indices were built from.
+	 */
+	uint32 GetLayoutVersion() const
+	{
+		return LayoutVersion;
+	}
+
+	/**
+	 * @return A spatial index over all of the nodes in the graph for nearest, k-nearest and radius queries.
+	 */
+	const FNavigationSpatialGrid& GetNodeGrid() const
+	{
+		return NodeGrid;
+	}
+
+	/**
+	 * @return A spatial index over only the nodes of the given point type.
+	 */
+	const FNavigationSpatialGrid& GetNodeGrid(EPointType PointType) const
+	{
+		return PointTypeGrids[static_cast<int32>(PointType)];
+	}
+
+	/**
+	 * @return A bounding volume tree for finding the node furthest away from a location.
+	 */
+	const FFurthestPointTree& GetFurthestTree() const
+	{
+		return NodeFurthestTree;
+	}
+
+private:
+
+	uint32 LayoutVersion = 0;
+	FNavigationSpatialGrid NodeGrid;
+	TStaticArray<FNavigationSpatialGrid, static_cast<int32>(EPointType::MAX)> PointTypeGrids;
+	FFurthestPointTree NodeFurthestTree;
+};
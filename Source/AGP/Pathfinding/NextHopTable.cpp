@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NextHopTable.h"
+
+#include "NavigationGraph.h"
+#include "NavigationSearch.h"
+#include "NavigationSearchWorkspace.h"
+#include "Algo/Reverse.h"
+#include "Async/ParallelFor.h"
+
+void FNextHopTable::Build(const FNavigationGraph& Graph)
+{
+	check(Graph.GetNumNodes() < NoPath);
+	NumNodes = Graph.GetNumNodes();
+	GraphVersion = Graph.GetVersion();
+	const int64 NumPairs = static_cast<int64>(NumNodes) * NumNodes;
+	NextHops.SetNumUninitialized(NumPairs);
+	Distances.SetNumUninitialized(NumPairs);
+	DistanceScales.SetNumUninitialized(NumNodes);
+
+	struct FBuildContext
+	{
+		FNavigationSearchWorkspace Workspace;
+		TArray<int32> SettledOrder;
+	};
+	TArray<FBuildContext> Contexts;
+	ParallelForWithTaskContext(Contexts, NumNodes, [this, &Graph](FBuildContext& Context, int32 StartNode)
+	{
+		FNavigationSearchWorkspace& Workspace = Context.Workspace;
+		Context.SettledOrder.Reset(NumNodes);
+		FNavigationSearch::Dijkstra(Graph, Workspace, MakeArrayView(&StartNode, 1), [&Context](int32 NodeId)
+		{
+			Context.SettledOrder.Add(NodeId);
+		});
+
+		uint16* const RowNextHops = NextHops.GetData() + GetPairIndex(StartNode, 0);
+		uint16* const RowDistances = Distances.GetData() + GetPairIndex(StartNode, 0);
+		for (int32 EndNode = 0; EndNode < NumNodes; ++EndNode)
+		{
+			RowNextHops[EndNode] = NoPath;
+			RowDistances[EndNode] = NoPath;
+		}
+
+		// The furthest node is settled last. Quantise so that it just fits in 16 bits.
+		const float MaxDistance = Context.SettledOrder.IsEmpty() ? 0.0f : Workspace.GetGScore(Context.SettledOrder.Last());
+		const float Scale = FMath::Max(MaxDistance / (NoPath - 1), UE_KINDA_SMALL_NUMBER);
+		DistanceScales[StartNode] = Scale;
+
+		// Parents are always settled before their children so the first hop towards every node can be copied down
+		// from its parent in one pass.
+		for (const int32 NodeId : Context.SettledOrder)
+		{
+			const int32 Parent = Workspace.GetCameFrom(NodeId);
+			if (Parent == INDEX_NONE)
+			{
+				RowNextHops[NodeId] = static_cast<uint16>(NodeId);
+			}
+			else
+			{
+				RowNextHops[NodeId] = Parent == StartNode ? static_cast<uint16>(NodeId) : RowNextHops[Parent];
+			}
+			RowDistances[NodeId] = static_cast<uint16>(FMath::Min(FMath::CeilToInt32(Workspace.GetGScore(NodeId) / Scale), NoPath - 1));
+		}
+	});
+}
+
+bool FNextHopTable::FindPath(const FNavigationGraph& Graph, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath) const
+{
+	OutPath.Reset();
+	if (NextHops[GetPairIndex(StartNode, EndNode)] == NoPath)
+	{
+		return false;
+	}
+
+	OutPath.Add(Graph.GetNodeLocation(StartNode));
+	for (int32 CurrentNode = StartNode; CurrentNode != EndNode; )
+	{
+		CurrentNode = NextHops[GetPairIndex(CurrentNode, EndNode)];
+		OutPath.Add(Graph.GetNodeLocation(CurrentNode));
+	}
+
+	// The paths are consumed from the back so they are stored in reverse order.
+	Algo::Reverse(OutPath);
+	return true;
+}
+
+float FNextHopTable::GetDistance(int32 StartNode, int32 EndNode) const
+{
+	const uint16 Distance = Distances[GetPairIndex(StartNode, EndNode)];
+	return Distance == NoPath ? UE_MAX_FLT : Distance * DistanceScales[StartNode];
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FNavigationGraph;
+
+/**
+ * Precomputed shortest paths between every pair of nodes of a graph. For each (from, to) pair it stores the next
+ * node to step to on the way and the path distance, both as 16 bit values (the distances are quantised separately for
+ * each start node), so finding a path is just following the next hops with no search at all. Memory is 4 bytes per
+ * pair so this is only meant for small and medium graphs.
+ */
+class AGP_API FNextHopTable
+{
+public:
+
+	/**
+	 * Will run Dijkstra's algorithm from every node, in parallel, and fill the table.
+	 * @param Graph The graph to build the table for. Must have fewer than 65535 nodes.
+	 */
+	void Build(const FNavigationGraph& Graph);
+
+	/**
+	 * @return The number of bytes that the table of a graph with NumNodes nodes takes.
+	 */
+	static int64 GetRequiredSize(int32 NumNodes)
+	{
+		return static_cast<int64>(NumNodes) * NumNodes * (sizeof(uint16) + sizeof(uint16)) + NumNodes * sizeof(float);
+	}
+
+	/**
+	 * @return The version of the graph that the table was built from.
+	 */
+	uint32 GetGraphVersion() const
+	{
+		return GraphVersion;
+	}
+
+	/**
+	 * @return The number of bytes used by the table.
+	 */
+	SIZE_T GetAllocatedSize() const
+	{
+		return NextHops.GetAllocatedSize() + Distances.GetAllocatedSize() + DistanceScales.GetAllocatedSize();
+	}
+
+	/**
+	 * Will walk the next hops from the StartNode to the EndNode.
+	 * @param Graph The graph that the table was built from.
+	 * @param StartNode The node id that the path starts at.
+	 * @param EndNode The node id that the path ends at.
+	 * @param OutPath Will be filled with the node locations along the path, in reverse order. Empty if there is no path.
+	 * @return true if there is a path.
+	 */
+	bool FindPath(const FNavigationGraph& Graph, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath) const;
+
+	/**
+	 * @return The path distance from the StartNode to the EndNode, rounded up to the precision of the table, or
+	 * UE_MAX_FLT if there is no path.
+	 */
+	float GetDistance(int32 StartNode, int32 EndNode) const;
+
+private:
+
+	// Stored for pairs with no path.
+	static constexpr uint16 NoPath = MAX_uint16;
+
+	/**
+	 * @return The index of the (from, to) pair in the NextHops and Distances. Too big for an int32 past 46340 nodes.
+	 */
+	int64 GetPairIndex(int32 StartNode, int32 EndNode) const
+	{
+		return static_cast<int64>(StartNode) * NumNodes + EndNode;
+	}
+
+	int32 NumNodes = 0;
+	uint32 GraphVersion = 0;
+	// NumNodes * NumNodes entries, row major by the start node.
+	TArray64<uint16> NextHops;
+	TArray64<uint16> Distances;
+	// The size of one step of the quantised distances in each row.
+	TArray<float> DistanceScales;
+};
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathCache.h"
+
+FPathCache::FPathCache(int32 InCapacity)
+	: Entries(InCapacity), Capacity(InCapacity)
+{
+}
+
+bool FPathCache::Find(uint32 GraphVersion, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath)
+{
+	FScopeLock Lock(&CriticalSection);
+	if (!SyncVersion(GraphVersion))
+	{
+		++Misses;
+		return false;
+	}
+
+	if (const TArray<FVector>* CachedPath = Entries.FindAndTouch(MakeKey(StartNode, EndNode)))
+	{
+		++Hits;
+		OutPath = *CachedPath;
+		return true;
+	}
+
+	++Misses;
+	return false;
+}
+
+void FPathCache::Add(uint32 GraphVersion, int32 StartNode, int32 EndNode, const TArray<FVector>& Path)
+{
+	FScopeLock Lock(&CriticalSection);
+	if (SyncVersion(GraphVersion))
+	{
+		Entries.Add(MakeKey(StartNode, EndNode), Path);
+	}
+}
+
+void FPathCache::Empty()
+{
+	FScopeLock Lock(&CriticalSection);
+	Entries.Empty(Capacity);
+}
+
+FPathCacheStats FPathCache::GetStats() const
+{
+	FScopeLock Lock(&CriticalSection);
+	FPathCacheStats Stats;
+	Stats.Hits = Hits;
+	Stats.Misses = Misses;
+	Stats.NumEntries = Entries.Num();
+	return Stats;
+}
+
+bool FPathCache::SyncVersion(uint32 GraphVersion)
+{
+	if (GraphVersion < CachedGraphVersion)
+	{
+		return false;
+	}
+	if (GraphVersion > CachedGraphVersion)
+	{
+		Entries.Empty(Capacity);
+		CachedGraphVersion = GraphVersion;
+	}
+	return true;
+}
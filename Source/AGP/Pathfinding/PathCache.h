@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LruCache.h"
+
+/**
+ * The hit and miss counters of an FPathCache.
+ */
+struct FPathCacheStats
+{
+	uint64 Hits = 0;
+	uint64 Misses = 0;
+	int32 NumEntries = 0;
+
+	float GetHitRate() const
+	{
+		const uint64 Lookups = Hits + Misses;
+		return Lookups > 0 ? static_cast<float>(static_cast<double>(Hits) / Lookups) : 0.0f;
+	}
+};
+
+/**
+ * A thread safe, least recently used cache of node to node paths. Failed searches are cached too (as empty paths) so
+ * asking for an impossible path again doesn't repeat the search. Every entry belongs to one version of the navigation
+ * graph and the whole cache is thrown away as soon as it is used with a newer version. The versions only ever go up,
+ * so a worker that is still searching an older snapshot misses the cache and doesn't add to it, rather than throwing
+ * away the entries of the newer version.
+ */
+class AGP_API FPathCache
+{
+public:
+
+	explicit FPathCache(int32 InCapacity = 1024);
+
+	/**
+	 * @param GraphVersion The version of the graph the path is wanted for.
+	 * @param StartNode The node id that the path starts at.
+	 * @param EndNode The node id that the path ends at.
+	 * @param OutPath Will be set to the cached path, which is empty if it is known that there is no path.
+	 * @return true if the path was in the cache. Always false for a version older than the newest one seen.
+	 */
+	bool Find(uint32 GraphVersion, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath);
+
+	/**
+	 * Will store the result of a search. An empty path records that there is no path between the nodes. Ignored for a
+	 * version older than the newest one seen.
+	 */
+	void Add(uint32 GraphVersion, int32 StartNode, int32 EndNode, const TArray<FVector>& Path);
+
+	/**
+	 * Will throw away every entry. The counters are kept.
+	 */
+	void Empty();
+
+	FPathCacheStats GetStats() const;
+
+private:
+
+	static uint64 MakeKey(int32 StartNode, int32 EndNode)
+	{
+		return (static_cast<uint64>(static_cast<uint32>(StartNode)) << 32) | static_cast<uint32>(EndNode);
+	}
+
+	/**
+	 * Empties the cache if the graph version is newer than the one its entries belong to. Must be called with the lock
+	 * held.
+	 * @return false if the graph version is older than the entries, which must then be left alone.
+	 */
+	bool SyncVersion(uint32 GraphVersion);
+
+	mutable FCriticalSection CriticalSection;
+	TLruCache<uint64, TArray<FVector>> Entries;
+	int32 Capacity;
+	uint32 CachedGraphVersion = 0;
+	uint64 Hits = 0;
+	uint64 Misses = 0;
+};
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PathQuery.generated.h"
+
+class FNavigationGraph;
+class FNavigationHierarchy;
+
+/**
+ * The kinds of path that the UPathfindingSubsystem can be asked for. Each one matches one of the synchronous path
+ * functions on the subsystem.
+ */
+UENUM(BlueprintType)
+enum class EPathQueryKind : uint8
+{
+	// A path to the node nearest the TargetLocation. Same as GetPath.
+	Point,
+	// A path to a random node. Same as GetRandomPath.
+	Random,
+	// A path to the node furthest away from the TargetLocation. Same as GetPathAway.
+	Away,
+	// A path to the escape point with the shortest path. Same as GetExitPath.
+	Exit,
+	// A path to the spawn point with the shortest path. Same as GetSpawnPointPath.
+	SpawnPoint,
+	// A path to the cover node with the shortest path. Same as GetNearestCoverPath.
+	NearestCover
+};
+
+/**
+ * How the node furthest away from a location is chosen.
+ */
+UENUM(BlueprintType)
+enum class EFurthestNodeMode : uint8
+{
+	// The node with the largest straight line distance from the location.
+	StraightLine,
+	// The node that takes the longest path to reach from the node nearest the location.
+	PathDistance
+};
+
+/**
+ * Describes a single path that should be found by the UPathfindingSubsystem.
+ */
+struct FPathQuery
+{
+	EPathQueryKind Kind = EPathQueryKind::Point;
+	// The location that the path will start at.
+	FVector StartLocation = FVector::ZeroVector;
+	// Only used by the Point and Away kinds. See EPathQueryKind.
+	FVector TargetLocation = FVector::ZeroVector;
+	// Only used by the Away kind. How the node furthest away from the TargetLocation is chosen, as in GetPathAway.
+	EFurthestNodeMode FurthestNodeMode = EFurthestNodeMode::StraightLine;
+	// Whether node to node paths are searched for from both ends at once, which expands fewer nodes on long paths.
+	// Only used when the path isn't answered by a precomputed structure, and not by time sliced requests.
+	bool bBidirectional = false;
+};
+
+/**
+ * Identifies a path request that was submitted to the UPathfindingSubsystem. A default constructed handle is invalid.
+ */
+struct FPathRequestHandle
+{
+	uint32 Id = 0;
+
+	bool IsValid() const
+	{
+		return Id != 0;
+	}
+
+	void Invalidate()
+	{
+		Id = 0;
+	}
+};
+
+/**
+ * The rest of a hierarchical path that has not been refined into real nodes yet. Once the path that came with it has
+ * been walked, pass it to UPathfindingSubsystem::ContinuePath to get the next part.
+ */
+struct FPathContinuation
+{
+	// The snapshots that the route was found on.
+	TSharedPtr<const FNavigationGraph, ESPMode::ThreadSafe> Graph;
+	TSharedPtr<const FNavigationHierarchy, ESPMode::ThreadSafe> Hierarchy;
+	// The node ids of the route through the hierarchy, from the start to the end.
+	TArray<int32> Route;
+	// The index in the Route of the node that the next unrefined step ends at.
+	int32 NextStep = 0;
+
+	bool HasRemaining() const
+	{
+		return Hierarchy.IsValid() && Route.IsValidIndex(NextStep);
+	}
+
+	void Reset()
+	{
+		Graph.Reset();
+		Hierarchy.Reset();
+		Route.Reset();
+		NextStep = 0;
+	}
+};
+
+/**
+ * Called on the game thread when a requested path has been found. The path is empty if no path exists. If the path
+ * was found hierarchically it only goes part of the way and the continuation has the rest.
+ */
+DECLARE_DELEGATE_TwoParams(FOnPathComputed, const TArray<FVector>& /* Path */, const FPathContinuation& /* Continuation */);
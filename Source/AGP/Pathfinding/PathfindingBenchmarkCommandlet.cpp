@@ -0,0 +1,710 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathfindingBenchmarkCommandlet.h"
+
+#include "ContractionHierarchy.h"
+#include "DStarLitePlanner.h"
+#include "NavigationHierarchy.h"
+#include "NavigationLandmarks.h"
+#include "NavigationNode.h"
+#include "NavigationSearch.h"
+#include "NavigationSearchWorkspace.h"
+#include "NextHopTable.h"
+#include "PathfindingStats.h"
+#include "PathfindingSubsystem.h"
+#include "SyntheticNavigationGraph.h"
+#include "Dom/JsonObject.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeExit.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+namespace
+{
+	// Only the allocations made by the thread running a query are counted, so the workers don't add to it.
+	thread_local uint64 NumThreadAllocations = 0;
+
+	/**
+	 * Passes every call on to the allocator it wraps and counts the allocations made on each thread. Installed once by
+	 * Install and never removed, see there.
+	 */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+
+		/**
+		 * Will wrap GMalloc in a counting allocator, the first time it is called. The allocator is never swapped back or
+		 * deleted: a thread may have read GMalloc just before the swap, or still be inside the wrapper after it, and
+		 * both allocators hand every call to the same inner allocator, so blocks from either can be freed by the other.
+		 */
+		static void Install()
+		{
+			static FCountingMalloc* CountingMalloc = nullptr;
+			if (!CountingMalloc)
+			{
+				CountingMalloc = new FCountingMalloc(GMalloc);
+				GMalloc = CountingMalloc;
+			}
+		}
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			++NumThreadAllocations;
+			return InnerMalloc->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			++NumThreadAllocations;
+			return InnerMalloc->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			++NumThreadAllocations;
+			return InnerMalloc->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			++NumThreadAllocations;
+			return InnerMalloc->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			InnerMalloc->Free(Original);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return InnerMalloc->QuantizeSize(Count, Alignment);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return InnerMalloc->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual void Trim(bool bTrimThreadCaches) override
+		{
+			InnerMalloc->Trim(bTrimThreadCaches);
+		}
+
+		virtual void SetupTLSCachesOnCurrentThread() override
+		{
+			InnerMalloc->SetupTLSCachesOnCurrentThread();
+		}
+
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+		{
+			InnerMalloc->ClearAndDisableTLSCachesOnCurrentThread();
+		}
+
+		virtual void InitializeStatsMetadata() override
+		{
+			InnerMalloc->InitializeStatsMetadata();
+		}
+
+		virtual void UpdateStats() override
+		{
+			InnerMalloc->UpdateStats();
+		}
+
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override
+		{
+			InnerMalloc->GetAllocatorStats(OutStats);
+		}
+
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override
+		{
+			InnerMalloc->DumpAllocatorStats(Ar);
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return InnerMalloc->IsInternallyThreadSafe();
+		}
+
+		virtual bool ValidateHeap() override
+		{
+			return InnerMalloc->ValidateHeap();
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return InnerMalloc->GetDescriptiveName();
+		}
+
+	private:
+
+		explicit FCountingMalloc(FMalloc* InInnerMalloc)
+			: InnerMalloc(InInnerMalloc)
+		{
+		}
+
+		FMalloc* InnerMalloc;
+	};
+
+	/**
+	 * The measurements of every run of one kind of query.
+	 */
+	struct FQueryStats
+	{
+		explicit FQueryStats(const TCHAR* InName)
+			: Name(InName)
+		{
+		}
+
+		// Also the name of the trace scope that every run is made in.
+		const TCHAR* Name;
+		TArray<double> Microseconds;
+		int64 NumAllocations = 0;
+		int64 NumExpanded = 0;
+		bool bHasExpanded = false;
+		int32 NumFailed = 0;
+
+		/**
+		 * Will time the Query and count the allocations it makes, inside a trace scope with the Name of these stats so
+		 * that a memory trace can also show what it allocated.
+		 * @param Query Runs the query and returns whether it succeeded.
+		 */
+		void Measure(TFunctionRef<bool()> Query)
+		{
+			const uint64 StartAllocations = NumThreadAllocations;
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			bool bSucceeded;
+			{
+				TRACE_CPUPROFILER_EVENT_SCOPE_TEXT(Name);
+				bSucceeded = Query();
+			}
+			const uint64 EndCycles = FPlatformTime::Cycles64();
+			NumAllocations += NumThreadAllocations - StartAllocations;
+			Microseconds.Add(FPlatformTime::ToSeconds64(EndCycles - StartCycles) * 1000000.0);
+			if (!bSucceeded)
+			{
+				++NumFailed;
+			}
+		}
+
+		void AddExpanded(int32 Expanded)
+		{
+			NumExpanded += Expanded;
+			bHasExpanded = true;
+		}
+
+		TSharedRef<FJsonObject> ToJson()
+		{
+			Microseconds.Sort();
+			const int32 Count = Microseconds.Num();
+			const auto Percentile = [this, Count](double Fraction)
+			{
+				return Count > 0 ? Microseconds[FMath::Min(FMath::FloorToInt32(Fraction * Count), Count - 1)] : 0.0;
+			};
+			double Total = 0.0;
+			for (const double Time : Microseconds)
+			{
+				Total += Time;
+			}
+
+			const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			const double Divisor = FMath::Max(Count, 1);
+			Json->SetNumberField(TEXT("Count"), Count);
+			Json->SetNumberField(TEXT("Failed"), NumFailed);
+			Json->SetNumberField(TEXT("MeanUs"), Total / Divisor);
+			Json->SetNumberField(TEXT("P50Us"), Percentile(0.5));
+			Json->SetNumberField(TEXT("P90Us"), Percentile(0.9));
+			Json->SetNumberField(TEXT("P99Us"), Percentile(0.99));
+			Json->SetNumberField(TEXT("MaxUs"), Count > 0 ? Microseconds.Last() : 0.0);
+			Json->SetNumberField(TEXT("AllocationsPerQuery"), NumAllocations / Divisor);
+			if (bHasExpanded)
+			{
+				Json->SetNumberField(TEXT("ExpandedPerQuery"), NumExpanded / Divisor);
+			}
+			return Json;
+		}
+	};
+
+	/**
+	 * A* as GetPath ran it before its open set was an indexed heap: the scores are kept in maps and the open set is an
+	 * array that is scanned for the lowest FScore on every step. Only here as the baseline that the heap is measured
+	 * against.
+	 * @param OutNumExpanded Will be set to the number of nodes taken off the open set.
+	 * @return true if a path was found.
+	 */
+	bool FindPathLinearOpenSet(const FNavigationGraph& Graph, int32 StartNode, int32 EndNode, int32& OutNumExpanded)
+	{
+		OutNumExpanded = 0;
+		if (!Graph.IsValidNode(StartNode) || !Graph.IsValidNode(EndNode))
+		{
+			return false;
+		}
+
+		TArray<int32> OpenSet;
+		OpenSet.Add(StartNode);
+		TMap<int32, float> GScores, HScores;
+		TMap<int32, int32> CameFrom;
+		GScores.Add(StartNode, 0.0f);
+		HScores.Add(StartNode, Graph.Distance(StartNode, EndNode));
+		CameFrom.Add(StartNode, INDEX_NONE);
+
+		while (!OpenSet.IsEmpty())
+		{
+			int32 CurrentNode = OpenSet[0];
+			for (int32 i = 1; i < OpenSet.Num(); i++)
+			{
+				if (GScores[OpenSet[i]] + HScores[OpenSet[i]] < GScores[CurrentNode] + HScores[CurrentNode])
+				{
+					CurrentNode = OpenSet[i];
+				}
+			}
+			OpenSet.Remove(CurrentNode);
+			++OutNumExpanded;
+
+			if (CurrentNode == EndNode)
+			{
+				return true;
+			}
+
+			for (int32 EdgeId = Graph.GetEdgeBegin(CurrentNode); EdgeId < Graph.GetEdgeEnd(CurrentNode); ++EdgeId)
+			{
+				const int32 ConnectedNode = Graph.GetEdgeTarget(EdgeId);
+				const float TentativeGScore = GScores[CurrentNode] + Graph.GetEdgeCost(EdgeId);
+				if (!GScores.Contains(ConnectedNode))
+				{
+					GScores.Add(ConnectedNode, UE_MAX_FLT);
+					HScores.Add(ConnectedNode, Graph.Distance(ConnectedNode, EndNode));
+					CameFrom.Add(ConnectedNode, INDEX_NONE);
+				}
+				if (TentativeGScore < GScores[ConnectedNode])
+				{
+					CameFrom[ConnectedNode] = CurrentNode;
+					GScores[ConnectedNode] = TentativeGScore;
+					if (!OpenSet.Contains(ConnectedNode))
+					{
+						OpenSet.Add(ConnectedNode);
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	/**
+	 * @return The cost of a path, as the sum of the straight line distances between its nodes. The generated graphs give
+	 * every edge its length as its cost, so this is the cost that the searches minimised.
+	 */
+	float GetPathCost(TConstArrayView<FVector> Path)
+	{
+		float Cost = 0.0f;
+		for (int32 Index = 1; Index < Path.Num(); ++Index)
+		{
+			Cost += static_cast<float>(FVector::Distance(Path[Index - 1], Path[Index]));
+		}
+		return Cost;
+	}
+
+	/**
+	 * How the paths that one backend found compare with the ones that plain A* found for the same queries.
+	 */
+	struct FVerifyStats
+	{
+		// Paths of equal cost summed in a different order can differ in the last few bits of the float.
+		static constexpr float CostTolerance = 1.0e-4f;
+
+		int32 NumChecked = 0;
+		int32 NumMismatched = 0;
+		double MaxCostRatio = 1.0;
+
+		/**
+		 * @param bFound Whether the backend found a path.
+		 * @param Cost The cost of the path that the backend found.
+		 * @param bReferenceFound Whether A* found a path.
+		 * @param ReferenceCost The cost of the path that A* found.
+		 * @param bMayBeLonger If true, the backend only has to find a path that is no shorter than the A* one, rather
+		 * than one of the same cost.
+		 * @return true if the paths match.
+		 */
+		bool Check(bool bFound, float Cost, bool bReferenceFound, float ReferenceCost, bool bMayBeLonger)
+		{
+			++NumChecked;
+			bool bMatches = bFound == bReferenceFound;
+			if (bMatches && bFound)
+			{
+				const float Tolerance = FMath::Max(ReferenceCost, 1.0f) * CostTolerance;
+				bMatches = Cost >= ReferenceCost - Tolerance && (bMayBeLonger || Cost <= ReferenceCost + Tolerance);
+				if (ReferenceCost > 0.0f)
+				{
+					MaxCostRatio = FMath::Max(MaxCostRatio, static_cast<double>(Cost) / ReferenceCost);
+				}
+			}
+			if (!bMatches)
+			{
+				++NumMismatched;
+			}
+			return bMatches;
+		}
+
+		TSharedRef<FJsonObject> ToJson() const
+		{
+			const TSharedRef<FJsonObject> Json = MakeShared<FJsonObject>();
+			Json->SetNumberField(TEXT("Checked"), NumChecked);
+			Json->SetNumberField(TEXT("Mismatched"), NumMismatched);
+			Json->SetNumberField(TEXT("MaxCostRatio"), MaxCostRatio);
+			return Json;
+		}
+	};
+
+	/**
+	 * Will run the same random node to node queries through plain A* and through every other way that the subsystem
+	 * can answer them, and check that they agree on whether there is a path and on its cost. Hierarchical paths are
+	 * allowed to be longer, as the subsystem accepts that, but never shorter.
+	 * @param GraphPtr The graph to build the backends for and search.
+	 * @param Landmarks The landmarks built for the graph.
+	 * @param NumQueries The number of random queries to check.
+	 * @param Seed The seed of the random queries.
+	 * @param OutJson Will be given a field for each backend with its checked and mismatched counts.
+	 * @return The number of paths, over all of the backends, that didn't match.
+	 */
+	int32 VerifyBackends(const FNavigationGraphPtr& GraphPtr, const FNavigationLandmarks& Landmarks, int32 NumQueries, int32 Seed, FJsonObject& OutJson)
+	{
+		const FNavigationGraph& Graph = *GraphPtr;
+		FNavigationSearchWorkspace Workspace;
+		FNextHopTable NextHopTable;
+		NextHopTable.Build(Graph);
+		FContractionHierarchy ContractionHierarchy;
+		ContractionHierarchy.Build(Graph, Workspace);
+		FNavigationHierarchy NavigationHierarchy;
+		NavigationHierarchy.Build(Graph);
+		FDStarLitePlanner Planner;
+
+		FVerifyStats LandmarkStats;
+		FVerifyStats BidirectionalStats;
+		FVerifyStats NextHopStats;
+		FVerifyStats ContractionHierarchyStats;
+		FVerifyStats NavigationHierarchyStats;
+		FVerifyStats DStarLiteStats;
+		FRandomStream RandomStream(Seed);
+		TArray<FVector> Path;
+		TArray<int32> Route;
+		TArray<int32> PathNodes;
+
+		for (int32 Query = 0; Query < NumQueries; ++Query)
+		{
+			const int32 StartNode = RandomStream.RandHelper(Graph.GetNumNodes());
+			const int32 EndNode = RandomStream.RandHelper(Graph.GetNumNodes());
+			const bool bReferenceFound = FNavigationSearch::FindPath(Graph, Workspace, StartNode, EndNode, Path);
+			const float ReferenceCost = GetPathCost(Path);
+
+			const auto Check = [&](FVerifyStats& Stats, const TCHAR* Backend, bool bFound, bool bMayBeLonger)
+			{
+				const float Cost = GetPathCost(Path);
+				if (!Stats.Check(bFound, Cost, bReferenceFound, ReferenceCost, bMayBeLonger))
+				{
+					UE_LOG(LogPathfinding, Warning, TEXT("%s disagrees with A* from node %d to node %d: %s with cost %f, where A* %s with cost %f."),
+						Backend, StartNode, EndNode, bFound ? TEXT("found a path") : TEXT("found no path"), Cost,
+						bReferenceFound ? TEXT("found a path") : TEXT("found no path"), ReferenceCost)
+				}
+			};
+
+			if (Landmarks.GetNumLandmarks() > 0)
+			{
+				Check(LandmarkStats, TEXT("Landmark A*"), FNavigationSearch::FindPath(Graph, Workspace, StartNode, EndNode, Path, &Landmarks), false);
+			}
+			Check(BidirectionalStats, TEXT("Bidirectional A*"), FNavigationSearch::FindPathBidirectional(Graph, Workspace, StartNode, EndNode, Path), false);
+			Check(NextHopStats, TEXT("The next hop table"), NextHopTable.FindPath(Graph, StartNode, EndNode, Path), false);
+			Check(ContractionHierarchyStats, TEXT("The contraction hierarchy"), ContractionHierarchy.FindPath(Graph, Workspace, StartNode, EndNode, Path), false);
+
+			// Refine every step of the route, as the subsystem does a few steps at a time while the agent walks it.
+			bool bRouteFound = NavigationHierarchy.FindRoute(Graph, Workspace, StartNode, EndNode, Route);
+			PathNodes.Reset();
+			if (bRouteFound)
+			{
+				PathNodes.Add(Route[0]);
+				for (int32 RouteIndex = 1; RouteIndex < Route.Num() && bRouteFound; ++RouteIndex)
+				{
+					bRouteFound = NavigationHierarchy.RefineStep(Graph, Workspace, Route[RouteIndex - 1], Route[RouteIndex], PathNodes);
+				}
+			}
+			Path.Reset(PathNodes.Num());
+			for (const int32 NodeId : PathNodes)
+			{
+				Path.Add(Graph.GetNodeLocation(NodeId));
+			}
+			Check(NavigationHierarchyStats, TEXT("The navigation hierarchy"), bRouteFound, true);
+
+			Planner.Initialize(GraphPtr, MakeArrayView(&EndNode, 1));
+			Check(DStarLiteStats, TEXT("D* Lite"), Planner.FindPath(StartNode, Path), false);
+		}
+
+		if (Landmarks.GetNumLandmarks() > 0)
+		{
+			OutJson.SetObjectField(TEXT("AStarLandmarks"), LandmarkStats.ToJson());
+		}
+		OutJson.SetObjectField(TEXT("BidirectionalAStar"), BidirectionalStats.ToJson());
+		OutJson.SetObjectField(TEXT("NextHopTable"), NextHopStats.ToJson());
+		OutJson.SetObjectField(TEXT("ContractionHierarchy"), ContractionHierarchyStats.ToJson());
+		OutJson.SetObjectField(TEXT("NavigationHierarchy"), NavigationHierarchyStats.ToJson());
+		OutJson.SetObjectField(TEXT("DStarLite"), DStarLiteStats.ToJson());
+		return LandmarkStats.NumMismatched + BidirectionalStats.NumMismatched + NextHopStats.NumMismatched
+			+ ContractionHierarchyStats.NumMismatched + NavigationHierarchyStats.NumMismatched + DStarLiteStats.NumMismatched;
+	}
+
+	/**
+	 * Will find the same path distance Away queries through SolvePathBatch, which resolves them from the FPathQuery
+	 * as the async and time sliced requests do, and through the synchronous GetPathAway, and check that they agree.
+	 * @param PathfindingSubsystem The subsystem with the graph to search.
+	 * @param NumQueries The number of random queries to check.
+	 * @param Seed The seed of the random queries.
+	 * @param OutJson Will be given a field with the checked and mismatched counts.
+	 * @return The number of paths that didn't match.
+	 */
+	int32 VerifyAwayQueries(UPathfindingSubsystem& PathfindingSubsystem, int32 NumQueries, int32 Seed, FJsonObject& OutJson)
+	{
+		const FNavigationGraph& Graph = *PathfindingSubsystem.GetGraph();
+		FRandomStream RandomStream(Seed);
+		TArray<FPathQuery> Queries;
+		Queries.SetNum(NumQueries);
+		for (FPathQuery& Query : Queries)
+		{
+			Query.Kind = EPathQueryKind::Away;
+			Query.StartLocation = Graph.GetNodeLocation(RandomStream.RandHelper(Graph.GetNumNodes()));
+			Query.TargetLocation = Graph.GetNodeLocation(RandomStream.RandHelper(Graph.GetNumNodes()));
+			Query.FurthestNodeMode = EFurthestNodeMode::PathDistance;
+		}
+		TArray<TArray<FVector>> Paths;
+		Paths.SetNum(NumQueries);
+		PathfindingSubsystem.SolvePathBatch(Queries, Paths);
+
+		FVerifyStats Stats;
+		for (int32 Query = 0; Query < NumQueries; ++Query)
+		{
+			const TArray<FVector> ReferencePath = PathfindingSubsystem.GetPathAway(Queries[Query].StartLocation, Queries[Query].TargetLocation,
+				EFurthestNodeMode::PathDistance);
+			const float Cost = GetPathCost(Paths[Query]);
+			const float ReferenceCost = GetPathCost(ReferencePath);
+			if (!Stats.Check(!Paths[Query].IsEmpty(), Cost, !ReferencePath.IsEmpty(), ReferenceCost, false))
+			{
+				UE_LOG(LogPathfinding, Warning, TEXT("The Away query from %s away from %s has cost %f, where GetPathAway has cost %f."),
+					*Queries[Query].StartLocation.ToString(), *Queries[Query].TargetLocation.ToString(), Cost, ReferenceCost)
+			}
+		}
+		OutJson.SetObjectField(TEXT("AwayPathDistance"), Stats.ToJson());
+		return Stats.NumMismatched;
+	}
+
+	void ParseList(const FString& Params, const TCHAR* Name, const FString& Default, TArray<FString>& OutValues)
+	{
+		FString Value = Default;
+		FParse::Value(*Params, Name, Value);
+		Value.ParseIntoArray(OutValues, TEXT(","));
+	}
+}
+
+UPathfindingBenchmarkCommandlet::UPathfindingBenchmarkCommandlet()
+{
+	LogToConsole = true;
+}
+
+int32 UPathfindingBenchmarkCommandlet::Main(const FString& Params)
+{
+	TArray<FString> ShapeNames;
+	ParseList(Params, TEXT("Shapes="), TEXT("Grid,RandomGeometric,Maze"), ShapeNames);
+	TArray<FString> SizeNames;
+	ParseList(Params, TEXT("Sizes="), TEXT("100,1000,10000,100000,1000000"), SizeNames);
+	int32 NumQueries = 1000;
+	FParse::Value(*Params, TEXT("Queries="), NumQueries);
+	int32 Seed = 1;
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	// The linear open set is quadratic in the size of the frontier, so it is only run on the smaller graphs and for the
+	// first few queries of each.
+	int32 BaselineMaxNodes = 100000;
+	FParse::Value(*Params, TEXT("BaselineMaxNodes="), BaselineMaxNodes);
+	int32 NumBaselineQueries = 100;
+	FParse::Value(*Params, TEXT("BaselineQueries="), NumBaselineQueries);
+	// The landmarks are built here rather than by the subsystem, as they are off in the world settings by default.
+	int32 NumLandmarks = 8;
+	FParse::Value(*Params, TEXT("Landmarks="), NumLandmarks);
+	// Every backend is built for each graph of up to VerifyMaxNodes nodes and checked against A*. The next hop table
+	// is quadratic in the node count, which is what keeps this to the smaller graphs, and stores node ids in 16 bits.
+	const bool bVerify = FParse::Param(*Params, TEXT("Verify"));
+	int32 VerifyMaxNodes = 4096;
+	FParse::Value(*Params, TEXT("VerifyMaxNodes="), VerifyMaxNodes);
+	VerifyMaxNodes = FMath::Min(VerifyMaxNodes, 65534);
+	int32 NumVerifyQueries = 200;
+	FParse::Value(*Params, TEXT("VerifyQueries="), NumVerifyQueries);
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks/Pathfinding.json");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+
+	TArray<ESyntheticGraphShape> Shapes;
+	for (const FString& ShapeName : ShapeNames)
+	{
+		ESyntheticGraphShape Shape;
+		if (!FSyntheticNavigationGraph::ParseShape(ShapeName, Shape))
+		{
+			UE_LOG(LogPathfinding, Error, TEXT("Unknown graph shape %s."), *ShapeName)
+			return 1;
+		}
+		Shapes.Add(Shape);
+	}
+
+	// Every allocation goes through the counting allocator from here on.
+	FCountingMalloc::Install();
+
+	// The subsystem needs a world to live in, and the world picks up the project's world settings class.
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("PathfindingBenchmark"));
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	// Every way out of the benchmark, the early failures included, tears the world down again.
+	ON_SCOPE_EXIT
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+	};
+	UPathfindingSubsystem* PathfindingSubsystem = World->GetSubsystem<UPathfindingSubsystem>();
+	if (!PathfindingSubsystem)
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("Unable to find the PathfindingSubsystem"))
+		return 1;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> Results;
+	int32 NumMismatched = 0;
+	for (const ESyntheticGraphShape Shape : Shapes)
+	{
+		for (const FString& SizeName : SizeNames)
+		{
+			const int32 NumNodes = FCString::Atoi(*SizeName);
+			constexpr float Spacing = 200.0f;
+			const FSyntheticNavigationGraph GraphData = FSyntheticNavigationGraph::Generate(Shape, NumNodes, Seed, Spacing);
+			TRACE_BOOKMARK(TEXT("Benchmark %s with %d nodes"), FSyntheticNavigationGraph::GetShapeName(Shape), NumNodes);
+
+			const double BuildStartTime = FPlatformTime::Seconds();
+			PathfindingSubsystem->RebuildFromGraphData(GraphData.Locations, GraphData.NodeTypes, GraphData.Connections);
+			const double BuildSeconds = FPlatformTime::Seconds() - BuildStartTime;
+			const FNavigationGraph& Graph = *PathfindingSubsystem->GetGraph();
+
+			FQueryStats NearestNodeStats(TEXT("FindNearestNode"));
+			FQueryStats FurthestNodeStats(TEXT("FindFurthestNode"));
+			FQueryStats GetPathStats(TEXT("GetPath"));
+			FQueryStats AStarStats(TEXT("AStar"));
+			FQueryStats LandmarkStats(TEXT("AStarLandmarks"));
+			FQueryStats LinearOpenSetStats(TEXT("AStarLinearOpenSet"));
+			FQueryStats HeapOpenSetStats(TEXT("AStarHeapOpenSet"));
+			FQueryStats BidirectionalStats(TEXT("BidirectionalAStar"));
+			FQueryStats CoverPathStats(TEXT("GetNearestCoverPath"));
+			FQueryStats ExitPathStats(TEXT("GetExitPath"));
+			FNavigationSearchWorkspace Workspace;
+			FNavigationLandmarks Landmarks;
+			const double LandmarkStartTime = FPlatformTime::Seconds();
+			Landmarks.Build(Graph, Workspace, NumLandmarks);
+			const double LandmarkSeconds = FPlatformTime::Seconds() - LandmarkStartTime;
+			FRandomStream RandomStream(Seed);
+			TArray<FVector> Path;
+			const auto RandomLocation = [&RandomStream, &Graph, Spacing]()
+			{
+				const FVector Jitter(RandomStream.FRandRange(-0.5f, 0.5f) * Spacing, RandomStream.FRandRange(-0.5f, 0.5f) * Spacing, 0.0);
+				return Graph.GetNodeLocation(RandomStream.RandHelper(Graph.GetNumNodes())) + Jitter;
+			};
+
+			for (int32 Query = 0; Query < NumQueries; ++Query)
+			{
+				const FVector StartLocation = RandomLocation();
+				const FVector TargetLocation = RandomLocation();
+
+				NearestNodeStats.Measure([&]() { return PathfindingSubsystem->GetNearestNodeId(StartLocation) != INDEX_NONE; });
+				FurthestNodeStats.Measure([&]() { return PathfindingSubsystem->GetFurthestNodeId(StartLocation) != INDEX_NONE; });
+				GetPathStats.Measure([&]() { return !PathfindingSubsystem->GetPath(StartLocation, TargetLocation).IsEmpty(); });
+				CoverPathStats.Measure([&]() { return !PathfindingSubsystem->GetNearestCoverPath(StartLocation).IsEmpty(); });
+				ExitPathStats.Measure([&]() { return !PathfindingSubsystem->GetExitPath(StartLocation).IsEmpty(); });
+
+				// The raw searches, without the cache or the precomputed structures, for the number of nodes expanded.
+				const int32 StartNode = PathfindingSubsystem->GetNearestNodeId(StartLocation);
+				const int32 EndNode = PathfindingSubsystem->GetNearestNodeId(TargetLocation);
+				AStarStats.Measure([&]() { return FNavigationSearch::FindPath(Graph, Workspace, StartNode, EndNode, Path); });
+				AStarStats.AddExpanded(Workspace.GetNumExpanded());
+				if (Landmarks.GetNumLandmarks() > 0)
+				{
+					LandmarkStats.Measure([&]() { return FNavigationSearch::FindPath(Graph, Workspace, StartNode, EndNode, Path, &Landmarks); });
+					LandmarkStats.AddExpanded(Workspace.GetNumExpanded());
+				}
+				BidirectionalStats.Measure([&]() { return FNavigationSearch::FindPathBidirectional(Graph, Workspace, StartNode, EndNode, Path); });
+				BidirectionalStats.AddExpanded(Workspace.GetNumExpanded() + Workspace.GetReverseWorkspace().GetNumExpanded());
+
+				// The same queries with the open set before and after it became a heap.
+				if (Graph.GetNumNodes() <= BaselineMaxNodes && Query < NumBaselineQueries)
+				{
+					int32 NumExpanded = 0;
+					LinearOpenSetStats.Measure([&]() { return FindPathLinearOpenSet(Graph, StartNode, EndNode, NumExpanded); });
+					LinearOpenSetStats.AddExpanded(NumExpanded);
+					HeapOpenSetStats.Measure([&]() { return FNavigationSearch::FindPath(Graph, Workspace, StartNode, EndNode, Path); });
+					HeapOpenSetStats.AddExpanded(Workspace.GetNumExpanded());
+				}
+			}
+
+			const TSharedRef<FJsonObject> QueriesJson = MakeShared<FJsonObject>();
+			QueriesJson->SetObjectField(NearestNodeStats.Name, NearestNodeStats.ToJson());
+			QueriesJson->SetObjectField(FurthestNodeStats.Name, FurthestNodeStats.ToJson());
+			QueriesJson->SetObjectField(GetPathStats.Name, GetPathStats.ToJson());
+			QueriesJson->SetObjectField(AStarStats.Name, AStarStats.ToJson());
+			if (!LandmarkStats.Microseconds.IsEmpty())
+			{
+				QueriesJson->SetObjectField(LandmarkStats.Name, LandmarkStats.ToJson());
+			}
+			QueriesJson->SetObjectField(BidirectionalStats.Name, BidirectionalStats.ToJson());
+			if (!LinearOpenSetStats.Microseconds.IsEmpty())
+			{
+				QueriesJson->SetObjectField(LinearOpenSetStats.Name, LinearOpenSetStats.ToJson());
+				QueriesJson->SetObjectField(HeapOpenSetStats.Name, HeapOpenSetStats.ToJson());
+			}
+			QueriesJson->SetObjectField(CoverPathStats.Name, CoverPathStats.ToJson());
+			QueriesJson->SetObjectField(ExitPathStats.Name, ExitPathStats.ToJson());
+
+			const TSharedRef<FJsonObject> ResultJson = MakeShared<FJsonObject>();
+			ResultJson->SetStringField(TEXT("Shape"), FSyntheticNavigationGraph::GetShapeName(Shape));
+			ResultJson->SetNumberField(TEXT("Nodes"), Graph.GetNumNodes());
+			ResultJson->SetNumberField(TEXT("Edges"), Graph.GetNumEdges());
+			ResultJson->SetNumberField(TEXT("BuildMs"), BuildSeconds * 1000.0);
+			ResultJson->SetNumberField(TEXT("Landmarks"), Landmarks.GetNumLandmarks());
+			ResultJson->SetNumberField(TEXT("LandmarkBuildMs"), LandmarkSeconds * 1000.0);
+			ResultJson->SetObjectField(TEXT("Queries"), QueriesJson);
+			if (bVerify && Graph.GetNumNodes() <= VerifyMaxNodes)
+			{
+				const TSharedRef<FJsonObject> VerifyJson = MakeShared<FJsonObject>();
+				NumMismatched += VerifyBackends(PathfindingSubsystem->GetGraph(), Landmarks, NumVerifyQueries, Seed, *VerifyJson);
+				NumMismatched += VerifyAwayQueries(*PathfindingSubsystem, NumVerifyQueries, Seed, *VerifyJson);
+				ResultJson->SetObjectField(TEXT("Verify"), VerifyJson);
+			}
+			Results.Add(MakeShared<FJsonValueObject>(ResultJson));
+
+			UE_LOG(LogPathfinding, Display, TEXT("Benchmarked %s with %d nodes."), FSyntheticNavigationGraph::GetShapeName(Shape), Graph.GetNumNodes())
+		}
+	}
+
+	const TSharedRef<FJsonObject> RootJson = MakeShared<FJsonObject>();
+	RootJson->SetNumberField(TEXT("Seed"), Seed);
+	RootJson->SetNumberField(TEXT("QueriesPerGraph"), NumQueries);
+	RootJson->SetArrayField(TEXT("Results"), Results);
+
+	FString OutputJson;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutputJson);
+	FJsonSerializer::Serialize(RootJson, Writer);
+	if (!FFileHelper::SaveStringToFile(OutputJson, *OutputPath))
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("Unable to write the benchmark results to %s."), *OutputPath)
+		return 1;
+	}
+	UE_LOG(LogPathfinding, Display, TEXT("Wrote the benchmark results to %s."), *OutputPath)
+	if (NumMismatched > 0)
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("%d paths didn't match the cost of the A* path."), NumMismatched)
+		return 1;
+	}
+	return 0;
+}
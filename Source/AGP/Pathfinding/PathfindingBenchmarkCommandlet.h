@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "PathfindingBenchmarkCommandlet.generated.h"
+
+/**
+ * Benchmarks the pathfinding subsystem on generated graphs, without a map or a renderer, and writes the results as
+ * JSON. For every graph shape and size it times the node to node paths, the nearest and furthest node lookups and the
+ * cover and exit paths, and reports their latency percentiles and the nodes that the searches expanded. On graphs of
+ * up to BaselineMaxNodes nodes it also runs the first BaselineQueries queries with the linear open set that A* used
+ * before the indexed heap, and with the heap, for a before and after.
+ * The A* searches are also run with the landmark heuristic, with Landmarks landmarks built for each graph, to compare
+ * the nodes that each heuristic expands.
+ *
+ * With -Verify, every graph of up to VerifyMaxNodes nodes also has the next hop table, the contraction hierarchy and
+ * the navigation hierarchy built for it, and VerifyQueries random node to node paths are found with each of them, with
+ * D* Lite, bidirectional A* and landmark A*, and checked against the cost of the plain A* path. The hierarchy may find
+ * longer paths but never shorter ones. The path distance Away queries are also checked to find the same paths when
+ * they are resolved from an FPathQuery as when GetPathAway finds them. The commandlet fails if any path doesn't match.
+ *
+ * Run with:
+ * UnrealEditor-Cmd AGP.uproject -run=PathfindingBenchmark -nullrhi [-Shapes=Grid,RandomGeometric,Maze]
+ * [-Sizes=100,1000,10000,100000,1000000] [-Queries=1000] [-Seed=1] [-Output=Path.json]
+ * [-BaselineMaxNodes=100000] [-BaselineQueries=100] [-Landmarks=8] [-Verify] [-VerifyMaxNodes=4096] [-VerifyQueries=200]
+ *
+ * The world settings class defaults decide which precomputed structures are built, as they do for a map.
+ *
+ * The allocations that each kind of query makes on the thread that runs it are counted by wrapping the global
+ * allocator once when the commandlet starts, and written as AllocationsPerQuery. Every query also runs inside a trace
+ * scope named after its kind, and every graph starts with a trace bookmark, so adding -trace=cpu,memalloc shows what
+ * was allocated in the memory view of Unreal Insights.
+ */
+UCLASS()
+class AGP_API UPathfindingBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+
+	UPathfindingBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
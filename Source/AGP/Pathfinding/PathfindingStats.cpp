@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PathfindingStats.h"
+
+DEFINE_LOG_CATEGORY(LogPathfinding);
+
+CSV_DEFINE_CATEGORY(Pathfinding, true);
+
+DEFINE_STAT(STAT_PathfindingGetPath);
+DEFINE_STAT(STAT_PathfindingGetPathToNearest);
+DEFINE_STAT(STAT_PathfindingGetPathToAnyGoal);
+DEFINE_STAT(STAT_PathfindingFindNearestGoals);
+DEFINE_STAT(STAT_PathfindingFindNearestNode);
+DEFINE_STAT(STAT_PathfindingFindFurthestNode);
+DEFINE_STAT(STAT_PathfindingContinuePath);
+DEFINE_STAT(STAT_PathfindingReplanPath);
+DEFINE_STAT(STAT_PathfindingSolveQuery);
+DEFINE_STAT(STAT_PathfindingSolvePathBatch);
+DEFINE_STAT(STAT_PathfindingTimeSlicedSearches);
+DEFINE_STAT(STAT_PathfindingApplyGraphChanges);
+
+DEFINE_STAT(STAT_PathfindingQueries);
+DEFINE_STAT(STAT_PathfindingFailedQueries);
+DEFINE_STAT(STAT_PathfindingSearches);
+DEFINE_STAT(STAT_PathfindingNodesExpanded);
+DEFINE_STAT(STAT_PathfindingOpenSetPeak);
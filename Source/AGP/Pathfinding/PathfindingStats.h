@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPathfinding, Log, All);
+
+/**
+ * The pathfinding columns of CSV profiler captures. Has the main queries timed per frame, including the ones that run
+ * on the workers, and the searches and nodes expanded.
+ */
+CSV_DECLARE_CATEGORY_EXTERN(Pathfinding);
+
+/**
+ * The pathfinding stats, shown in game with "stat Pathfinding". The cycle counters also show up as events in Unreal
+ * Insights when it records the cpu channel. The counters are per frame apart from the open set peak, which is the
+ * largest open set of any search in the last frame.
+ */
+DECLARE_STATS_GROUP(TEXT("Pathfinding"), STATGROUP_Pathfinding, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Get Path"), STAT_PathfindingGetPath, STATGROUP_Pathfinding, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Get Path To Nearest"), STAT_PathfindingGetPathToNearest, STATGROUP_Pathfinding, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Get Path To Any Goal"), STAT_PathfindingGetPathToAnyGoal, STATGROUP_Pathfinding, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Nearest Goals"), STAT_PathfindingFindNearestGoals, STATGROUP_Pathfinding, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Nearest Node"), STAT_PathfindingFindNearestNode, STATGROUP_Pathfinding, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Furthest Node"), STAT_PathfindingFindFurthestNode, STATGROUP_Pathfinding, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Continue Path"), STAT_PathfindingContinuePath, STATGROUP_Pathfinding, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Replan Path"), STAT_PathfindingReplanPath, STATGROUP_Pathfinding, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Solve Query"), STAT_PathfindingSolveQuery, STATGROUP_Pathfinding, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Solve Path Batch"), STAT_PathfindingSolvePathBatch, STATGROUP_Pathfinding, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Time Sliced Searches"), STAT_PathfindingTimeSlicedSearches, STATGROUP_Pathfinding, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Apply Graph Changes"), STAT_PathfindingApplyGraphChanges, STATGROUP_Pathfinding, );
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries"), STAT_PathfindingQueries, STATGROUP_Pathfinding, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Failed Queries"), STAT_PathfindingFailedQueries, STATGROUP_Pathfinding, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Searches"), STAT_PathfindingSearches, STATGROUP_Pathfinding, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Nodes Expanded"), STAT_PathfindingNodesExpanded, STATGROUP_Pathfinding, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Open Set Peak"), STAT_PathfindingOpenSetPeak, STATGROUP_Pathfinding, );
@@ -3,283 +3,1529 @@
 
 #include "PathfindingSubsystem.h"
 
+#include "BakedNavigationGraph.h"
 #include "EngineUtils.h"
+#include "NavigationGraphDebugComponent.h"
 #include "NavigationNode.h"
+#include "NavigationSearch.h"
+#include "PathfindingStats.h"
+#include "AGP/AGPWorldSettings.h"
 #include "AGP/Bunker.h"
 #include "AGP/Characters/EnemyCharacter.h"
 #include "Kismet/GameplayStatics.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
 
 void UPathfindingSubsystem::OnWorldBeginPlay(UWorld& InWorld)
 {
-	PopulateNodes();
+	const double StartTime = FPlatformTime::Seconds();
+	const AAGPWorldSettings* WorldSettings = Cast<AAGPWorldSettings>(InWorld.GetWorldSettings());
+	if (!WorldSettings || !WorldSettings->bUseBakedNavigationGraph || !LoadBakedGraph())
+	{
+		PopulateNodes();
+		BuildLandmarks();
+	}
+	BuildNextHopTable();
+	BuildContractionHierarchy();
+	BuildNavigationHierarchy();
+	UE_LOG(LogPathfinding, Display, TEXT("Set up the navigation graph of %d nodes in %.1f ms."), Graph ? Graph->GetNumNodes() : 0,
+		(FPlatformTime::Seconds() - StartTime) * 1000.0)
+	if (WorldSettings)
+	{
+		bTimeSlicePathRequests = WorldSettings->bTimeSlicePathRequests;
+		PathSearchBudgetSeconds = WorldSettings->PathSearchBudgetMicroseconds / 1000000.0;
+	}
 	BunkerActor = Cast<ABunker>(UGameplayStatics::GetActorOfClass(GetWorld(), ABunker::StaticClass()));
 	GetSplinePoint();
 }
 
+void UPathfindingSubsystem::RebuildFromGraphData(TConstArrayView<FVector> Locations, TConstArrayView<EPointType> NodeTypes, TConstArrayView<TArray<int32>> Connections)
+{
+	// There are no node actors behind the graph, so nothing can look them up by node id.
+	Nodes.Empty();
+	BuildGraph(Locations, NodeTypes, Connections);
+	BuildNextHopTable();
+	BuildLandmarks();
+	BuildContractionHierarchy();
+	BuildNavigationHierarchy();
+}
+
+void UPathfindingSubsystem::Deinitialize()
+{
+	// The workers read from this subsystem so they all need to finish before it goes away.
+	UE::Tasks::Wait(PathRequestTasks);
+	PathRequestTasks.Empty();
+	if (DistanceFieldsTask.IsValid())
+	{
+		DistanceFieldsTask.Wait();
+		DistanceFieldsTask = {};
+	}
+	TimeSlicedRequestIds.Empty();
+	PendingPathRequests.Empty();
+	CompletedPathRequestIds.Empty();
+	if (GraphDebugComponent)
+	{
+		GraphDebugComponent->DestroyComponent();
+		GraphDebugComponent = nullptr;
+	}
+
+	Super::Deinitialize();
+}
+
+void UPathfindingSubsystem::Tick(float DeltaTime)
+{
+	CSV_SCOPED_TIMING_STAT(Pathfinding, Tick);
+	Super::Tick(DeltaTime);
+
+	// Apply the graph changes made since the last tick in one go so there is at most one new snapshot per frame.
+	ApplyGraphChanges();
+	UpdateDistanceFields();
+	AdvanceTimeSlicedSearches();
+	SET_DWORD_STAT(STAT_PathfindingOpenSetPeak, FrameOpenSetPeak.exchange(0));
+#if ENABLE_DRAW_DEBUG
+	UpdateGraphDebugDrawing();
+#endif
+
+	if (bDeterministicPathDelivery)
+	{
+		UE::Tasks::Wait(PathRequestTasks);
+	}
+
+	// Deliver the paths that the workers have finished since the last tick.
+	uint32 CompletedId;
+	while (CompletedPathRequestIds.Dequeue(CompletedId))
+	{
+		TSharedRef<FPendingPathRequest, ESPMode::ThreadSafe>* Found = PendingPathRequests.Find(CompletedId);
+		if (!Found)
+		{
+			// The request was cancelled while the worker was running.
+			continue;
+		}
+
+		const TSharedRef<FPendingPathRequest, ESPMode::ThreadSafe> Request = *Found;
+		Request->bCompleted = true;
+		if (Request->bHasCallback)
+		{
+			// Only requests made without a callback are kept for TryGetPathResult.
+			PendingPathRequests.Remove(CompletedId);
+			Request->OnComplete.ExecuteIfBound(Request->Path, Request->Continuation);
+		}
+	}
+
+	PathRequestTasks.RemoveAllSwap([](const UE::Tasks::FTask& Task)
+	{
+		return Task.IsCompleted();
+	});
+}
+
+TStatId UPathfindingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPathfindingSubsystem, STATGROUP_Tickables);
+}
+
+FPathRequestHandle UPathfindingSubsystem::RequestPathAsync(const FPathQuery& Query, FOnPathComputed OnComplete)
+{
+	INC_DWORD_STAT(STAT_PathfindingQueries);
+	const TSharedRef<FPendingPathRequest, ESPMode::ThreadSafe> Request = MakeShared<FPendingPathRequest, ESPMode::ThreadSafe>();
+	Request->Query = Query;
+	// FMath::Rand isn't safe to use from the workers so roll the seed for Random queries here.
+	Request->RandomSeed = FMath::Rand();
+	Request->OnComplete = MoveTemp(OnComplete);
+	Request->bHasCallback = Request->OnComplete.IsBound();
+
+	FPathRequestHandle Handle;
+	Handle.Id = NextPathRequestId++;
+	if (NextPathRequestId == 0)
+	{
+		// Skip the invalid id when the counter wraps around.
+		NextPathRequestId = 1;
+	}
+	PendingPathRequests.Add(Handle.Id, Request);
+
+	if (bTimeSlicePathRequests)
+	{
+		StartTimeSlicedRequest(Handle.Id, Request);
+	}
+	else
+	{
+		LaunchPathRequestTask(Handle.Id, Request);
+	}
+	return Handle;
+}
+
+void UPathfindingSubsystem::LaunchPathRequestTask(uint32 Id, const TSharedRef<FPendingPathRequest, ESPMode::ThreadSafe>& Request)
+{
+	// The worker keeps its own reference to the snapshot so the graph and its indices can't be swapped out from under it.
+	PathRequestTasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, Request, Id, NavigationSnapshot = Snapshot]()
+	{
+		if (!Request->bCancelled && NavigationSnapshot->Graph)
+		{
+			Request->Path = SolveQuery(*NavigationSnapshot, Request->Query, FRandomStream(Request->RandomSeed), Request->Continuation);
+		}
+		CompletedPathRequestIds.Enqueue(Id);
+	}));
+}
+
+void UPathfindingSubsystem::CancelPathRequest(FPathRequestHandle& Handle)
+{
+	if (const TSharedRef<FPendingPathRequest, ESPMode::ThreadSafe>* Found = PendingPathRequests.Find(Handle.Id))
+	{
+		// The worker may still be running so let it know not to bother.
+		(*Found)->bCancelled = true;
+		if ((*Found)->Search)
+		{
+			WorkspacePool.Release((*Found)->Search->ReleaseWorkspace());
+		}
+		PendingPathRequests.Remove(Handle.Id);
+	}
+	Handle.Invalidate();
+}
+
+void UPathfindingSubsystem::StartTimeSlicedRequest(uint32 Id, const TSharedRef<FPendingPathRequest, ESPMode::ThreadSafe>& RequestRef)
+{
+	FPendingPathRequest& Request = *RequestRef;
+	if (!Graph)
+	{
+		CompletedPathRequestIds.Enqueue(Id);
+		return;
+	}
+
+	// Finding the furthest node by path distance searches the whole graph, which can't be sliced.
+	if (Request.Query.Kind == EPathQueryKind::Away && Request.Query.FurthestNodeMode == EFurthestNodeMode::PathDistance)
+	{
+		LaunchPathRequestTask(Id, RequestRef);
+		return;
+	}
+
+	int32 StartNode;
+	int32 EndNode;
+	ResolveQueryNodes(*Snapshot, Request.Query, FRandomStream(Request.RandomSeed), StartNode, EndNode);
+
+	// Only the lookups that just walk a path out of a table are answered here, as they cost no more than the length of
+	// the path. Paths to the nearest point of a type need current distance fields, and node to node paths need a
+	// current next hop table, unless the navigation hierarchy answers them first.
+	const uint32 Version = Graph->GetVersion();
+	const bool bNodeToNode = EndNode != INDEX_NONE;
+	const bool bUseNavigationHierarchy = bNodeToNode && NavigationHierarchy && NavigationHierarchy->GetGraphVersion() == Version;
+	const bool bAnsweredByLookup = bNodeToNode
+		? !bUseNavigationHierarchy && NextHopTable && NextHopTable->GetGraphVersion() == Version
+		: DistanceFields && DistanceFields->GetGraphVersion() == Version;
+	if (bAnsweredByLookup)
+	{
+		Request.Path = SolveQuery(*Snapshot, Request.Query, FRandomStream(Request.RandomSeed), Request.Continuation);
+		CompletedPathRequestIds.Enqueue(Id);
+		return;
+	}
+
+	// Everything else is a search. The multi-goal search while the distance fields are being rebuilt, the contraction
+	// hierarchy query and the navigation hierarchy's search over its abstract graph all go to the workers, so that the
+	// game thread only ever spends the budget on searches, however many requests are pending.
+	const bool bUseContractionHierarchy = ContractionHierarchy && ContractionHierarchy->GetGraphVersion() == Version;
+	if (!bNodeToNode || bUseNavigationHierarchy || bUseContractionHierarchy)
+	{
+		LaunchPathRequestTask(Id, RequestRef);
+		return;
+	}
+	if (PathCache.Find(Version, StartNode, EndNode, Request.Path))
+	{
+		if (Request.Path.IsEmpty())
+		{
+			INC_DWORD_STAT(STAT_PathfindingFailedQueries);
+		}
+		CompletedPathRequestIds.Enqueue(Id);
+		return;
+	}
+
+	const bool bUseLandmarks = Landmarks && Landmarks->GetGraphVersion() == Graph->GetLayoutVersion();
+	Request.Search = MakeUnique<FTimeSlicedPathSearch>(Graph, WorkspacePool.Acquire(), bUseLandmarks ? Landmarks : TSharedPtr<const FNavigationLandmarks, ESPMode::ThreadSafe>(), StartNode, EndNode);
+	TimeSlicedRequestIds.Add(Id);
+}
+
+void UPathfindingSubsystem::AdvanceTimeSlicedSearches()
+{
+	SCOPE_CYCLE_COUNTER(STAT_PathfindingTimeSlicedSearches);
+	const double FrameEndTime = FPlatformTime::Seconds() + PathSearchBudgetSeconds;
+
+	// The searches take turns, carrying on next frame from wherever this frame stopped. Each turn gets an even share of
+	// what is left of the budget, so a long search can't starve the others and time left over by quick ones is reused.
+	int32 NumTurnsLeft = TimeSlicedRequestIds.Num();
+	while (NumTurnsLeft > 0 && !TimeSlicedRequestIds.IsEmpty())
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (Now >= FrameEndTime)
+		{
+			break;
+		}
+		if (NextTimeSlicedRequest >= TimeSlicedRequestIds.Num())
+		{
+			NextTimeSlicedRequest = 0;
+		}
+
+		const uint32 Id = TimeSlicedRequestIds[NextTimeSlicedRequest];
+		const TSharedRef<FPendingPathRequest, ESPMode::ThreadSafe>* Found = PendingPathRequests.Find(Id);
+		if (!Found || !(*Found)->Search)
+		{
+			// The request was cancelled.
+			TimeSlicedRequestIds.RemoveAt(NextTimeSlicedRequest);
+			--NumTurnsLeft;
+			continue;
+		}
+
+		FPendingPathRequest& Request = **Found;
+		const double SliceEndTime = Now + (FrameEndTime - Now) / NumTurnsLeft;
+		--NumTurnsLeft;
+		if (Request.Search->Advance(SliceEndTime) == ETimeSlicedSearchStatus::InProgress)
+		{
+			++NextTimeSlicedRequest;
+			continue;
+		}
+
+		// The path is delivered along with the paths from the workers.
+		Request.Search->GetPath(Request.Path);
+		PathCache.Add(Request.Search->GetGraph()->GetVersion(), Request.Search->GetStartNode(), Request.Search->GetEndNode(), Request.Path);
+		if (Request.Path.IsEmpty())
+		{
+			INC_DWORD_STAT(STAT_PathfindingFailedQueries);
+		}
+		TUniquePtr<FNavigationSearchWorkspace> Workspace = Request.Search->ReleaseWorkspace();
+		RecordSearchStats(Workspace->GetNumExpanded(), Workspace->GetPeakOpenSetSize());
+		WorkspacePool.Release(MoveTemp(Workspace));
+		Request.Search.Reset();
+		TimeSlicedRequestIds.RemoveAt(NextTimeSlicedRequest);
+		CompletedPathRequestIds.Enqueue(Id);
+	}
+}
+
+bool UPathfindingSubsystem::IsPathRequestPending(const FPathRequestHandle& Handle) const
+{
+	return Handle.IsValid() && PendingPathRequests.Contains(Handle.Id);
+}
+
+bool UPathfindingSubsystem::TryGetPathResult(FPathRequestHandle& Handle, TArray<FVector>& OutPath, FPathContinuation* OutContinuation)
+{
+	const TSharedRef<FPendingPathRequest, ESPMode::ThreadSafe>* Found = PendingPathRequests.Find(Handle.Id);
+	if (!Found || !(*Found)->bCompleted)
+	{
+		return false;
+	}
+
+	OutPath = MoveTemp((*Found)->Path);
+	if (OutContinuation)
+	{
+		*OutContinuation = MoveTemp((*Found)->Continuation);
+	}
+	PendingPathRequests.Remove(Handle.Id);
+	Handle.Invalidate();
+	return true;
+}
+
+bool UPathfindingSubsystem::ContinuePath(FPathContinuation& Continuation, TArray<FVector>& OutPath) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_PathfindingContinuePath);
+	CSV_SCOPED_TIMING_STAT(Pathfinding, ContinuePath);
+	OutPath.Reset();
+	if (!Continuation.HasRemaining())
+	{
+		return false;
+	}
+	INC_DWORD_STAT(STAT_PathfindingQueries);
+
+	// Refine on the newest costs, so that edges blocked since the route was found aren't walked. The route only means
+	// anything while the graph still has the same nodes and edges.
+	if (Graph && Continuation.Graph != Graph && Continuation.Graph->GetLayoutVersion() == Graph->GetLayoutVersion())
+	{
+		Continuation.Graph = Graph;
+	}
+
+	const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+	if (Continuation.Graph != Graph || !RefineRoute(Workspace.Get(), Continuation, OutPath))
+	{
+		// The route can't be walked any more so give up on it and let the caller find a new path.
+		INC_DWORD_STAT(STAT_PathfindingFailedQueries);
+		Continuation.Reset();
+		OutPath.Reset();
+	}
+	return true;
+}
+
+bool UPathfindingSubsystem::RefineRoute(FNavigationSearchWorkspace& Workspace, FPathContinuation& Continuation, TArray<FVector>& OutPath) const
+{
+	const FNavigationGraph& NavigationGraph = *Continuation.Graph;
+	TArray<int32> PathNodes;
+	if (Continuation.NextStep == 1)
+	{
+		// The first part of the path also includes the node it starts at.
+		PathNodes.Add(Continuation.Route[0]);
+	}
+
+	// Steps between clusters are a single edge, so keep going until there are a few nodes to walk.
+	constexpr int32 MinRefinedNodes = 4;
+	while (PathNodes.Num() < MinRefinedNodes && Continuation.Route.IsValidIndex(Continuation.NextStep))
+	{
+		const int32 FromNode = Continuation.Route[Continuation.NextStep - 1];
+		const int32 ToNode = Continuation.Route[Continuation.NextStep];
+		if (!Continuation.Hierarchy->RefineStep(NavigationGraph, Workspace, FromNode, ToNode, PathNodes))
+		{
+			return false;
+		}
+		++Continuation.NextStep;
+	}
+
+	// The paths are consumed from the back so they are stored in reverse order.
+	OutPath.Reset(PathNodes.Num());
+	for (int32 Index = PathNodes.Num() - 1; Index >= 0; --Index)
+	{
+		OutPath.Add(NavigationGraph.GetNodeLocation(PathNodes[Index]));
+	}
+	return true;
+}
+
 
 TArray<FVector> UPathfindingSubsystem::GetRandomPath(const FVector& StartLocation)
 {
 	return GetPath(FindNearestNode(StartLocation), GetRandomNode());
 }
 
-TArray<FVector> UPathfindingSubsystem::GetPath(const FVector& StartLocation, const FVector& TargetLocation)
+TArray<FVector> UPathfindingSubsystem::GetPath(const FVector& StartLocation, const FVector& TargetLocation, bool bBidirectional)
 {
-	return GetPath(FindNearestNode(StartLocation), FindNearestNode(TargetLocation));
+	return GetPath(FindNearestNode(StartLocation), FindNearestNode(TargetLocation), bBidirectional);
 }
 
-TArray<FVector> UPathfindingSubsystem::GetPathAway(const FVector& StartLocation, const FVector& TargetLocation)
+TArray<FVector> UPathfindingSubsystem::GetPathAway(const FVector& StartLocation, const FVector& TargetLocation, EFurthestNodeMode Mode, bool bBidirectional)
 {
-	return GetPath(FindNearestNode(StartLocation), FindFurthestNode(TargetLocation));
+	return GetPath(FindNearestNode(StartLocation), FindFurthestNode(*Snapshot, TargetLocation, Mode), bBidirectional);
 }
 
 TArray<FVector> UPathfindingSubsystem::GetExitPath(const FVector& StartLocation)
 {
-	return GetPath(FindNearestNode(StartLocation),(EscapeNode));
+	return GetPathToNearest(EPointType::EscapePoint, StartLocation);
 }
 
 TArray<FVector> UPathfindingSubsystem::GetSpawnPointPath(const FVector& StartLocation)
 {
-	return GetPath(FindNearestNode(StartLocation),SpawnNode);
+	return GetPathToNearest(EPointType::SpawnPoint, StartLocation);
 }
-TArray<FVector> UPathfindingSubsystem::GetNearestCoverPath(const FVector& StartLocation, const FVector& TargetLocation)
+TArray<FVector> UPathfindingSubsystem::GetNearestCoverPath(const FVector& StartLocation)
 {
-	return GetPath(FindNearestNode(StartLocation),FindNearestNode(CoverNodes,TargetLocation));
+	return GetPathToNearest(EPointType::Cover, StartLocation);
 }
 
 void UPathfindingSubsystem::PopulateNodes()
 {
-	Nodes.Empty();
+	// Flatten the actors into the graph snapshot so that searches don't need to touch the actors again.
+	TArray<FVector> Locations;
+	TArray<EPointType> NodeTypes;
+	TArray<TArray<int32>> Connections;
+	GatherNodeData(Nodes, Locations, NodeTypes, Connections);
+	BuildGraph(Locations, NodeTypes, Connections);
+}
+
+void UPathfindingSubsystem::GatherNodeData(TArray<ANavigationNode*>& OutNodes, TArray<FVector>& OutLocations, TArray<EPointType>& OutNodeTypes,
+	TArray<TArray<int32>>& OutConnections) const
+{
+	OutNodes.Empty();
 
 	for (TActorIterator<ANavigationNode> It(GetWorld()); It; ++It)
 	{
-		Nodes.Add(*It);
-		UE_LOG(LogTemp, Warning, TEXT("NODE: %s"), *(*It)->GetActorLocation().ToString())
-		if(*It && It->NodeType == EPointType::SpawnPoint)
+		It->NodeIndex = OutNodes.Add(*It);
+		UE_LOG(LogPathfinding, Verbose, TEXT("NODE: %s"), *(*It)->GetActorLocation().ToString())
+	}
+
+	OutLocations.Reset(OutNodes.Num());
+	OutNodeTypes.Reset(OutNodes.Num());
+	OutConnections.Reset();
+	OutConnections.SetNum(OutNodes.Num());
+	for (int32 NodeId = 0; NodeId < OutNodes.Num(); ++NodeId)
+	{
+		OutLocations.Add(OutNodes[NodeId]->GetActorLocation());
+		OutNodeTypes.Add(OutNodes[NodeId]->NodeType);
+		for (const ANavigationNode* ConnectedNode : OutNodes[NodeId]->ConnectedNodes)
 		{
-			SpawnNode=*It;
+			// Connected nodes that were not found by the actor iterator (or are nullptrs) are skipped by the graph.
+			OutConnections[NodeId].Add(ConnectedNode && OutNodes.IsValidIndex(ConnectedNode->NodeIndex)
+				&& OutNodes[ConnectedNode->NodeIndex] == ConnectedNode ? ConnectedNode->NodeIndex : INDEX_NONE);
 		}
-		if(*It && It->NodeType == EPointType::EscapePoint)
+	}
+}
+
+bool UPathfindingSubsystem::LoadBakedGraph()
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const FString Filename = FBakedNavigationGraph::GetFilename(*GetWorld());
+	const FBakedNavigationGraphPtr BakedGraph = FBakedNavigationGraph::Load(Filename);
+	if (!BakedGraph)
+	{
+		UE_LOG(LogPathfinding, Warning, TEXT("There is no usable baked navigation graph at %s, so the graph will be built from the node actors. Bake it with AGP.Pathfinding.BakeGraph."),
+			*Filename)
+		return false;
+	}
+
+	// There are no node actors behind a baked graph, so nothing can look them up by node id.
+	Nodes.Empty();
+	const TSharedRef<FNavigationGraph, ESPMode::ThreadSafe> NewGraph = MakeShared<FNavigationGraph, ESPMode::ThreadSafe>();
+	NewGraph->InitFromBaked(BakedGraph.ToSharedRef());
+	SetGraph(NewGraph, BakedGraph);
+
+	const AAGPWorldSettings* WorldSettings = Cast<AAGPWorldSettings>(GetWorld()->GetWorldSettings());
+	if (WorldSettings && WorldSettings->NumLandmarks > 0 && BakedGraph->GetNumLandmarks() > 0)
+	{
+		const TSharedRef<FNavigationLandmarks, ESPMode::ThreadSafe> NewLandmarks = MakeShared<FNavigationLandmarks, ESPMode::ThreadSafe>();
+		NewLandmarks->InitFromBaked(BakedGraph.ToSharedRef(), NewGraph->GetLayoutVersion());
+		Landmarks = NewLandmarks;
+		PublishSnapshot();
+	}
+	else
+	{
+		BuildLandmarks();
+	}
+
+	UE_LOG(LogPathfinding, Display, TEXT("Loaded the baked navigation graph %s with %d nodes, %d landmarks and %s distance fields in %.2f ms (%.2f MB, %s)."),
+		*Filename, BakedGraph->GetNumNodes(), BakedGraph->GetNumLandmarks(), BakedGraph->HasDistanceFields() ? TEXT("baked") : TEXT("built"),
+		(FPlatformTime::Seconds() - StartTime) * 1000.0, BakedGraph->GetSize() / (1024.0 * 1024.0), BakedGraph->IsMapped() ? TEXT("memory mapped") : TEXT("read"))
+	return true;
+}
+
+bool UPathfindingSubsystem::BakeNavigationGraph() const
+{
+	TArray<ANavigationNode*> BakedNodes;
+	TArray<FVector> Locations;
+	TArray<EPointType> NodeTypes;
+	TArray<TArray<int32>> Connections;
+	GatherNodeData(BakedNodes, Locations, NodeTypes, Connections);
+
+	FNavigationGraph BakedGraph;
+	BakedGraph.Build(Locations, NodeTypes, Connections);
+
+	const AAGPWorldSettings* WorldSettings = Cast<AAGPWorldSettings>(GetWorld()->GetWorldSettings());
+	FNavigationLandmarks BakedLandmarks;
+	FNavigationDistanceFields BakedDistanceFields;
+	{
+		const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+		if (WorldSettings && WorldSettings->NumLandmarks > 0)
 		{
-			EscapeNode=*It;
+			BakedLandmarks.Build(BakedGraph, Workspace.Get(), WorldSettings->NumLandmarks);
 		}
-		if(*It && It->NodeType == EPointType::Cover)
+		BakedDistanceFields.Build(BakedGraph, Workspace.Get());
+	}
+	return FBakedNavigationGraph::Write(FBakedNavigationGraph::GetFilename(*GetWorld()), BakedGraph,
+		BakedLandmarks.GetNumLandmarks() > 0 ? &BakedLandmarks : nullptr, &BakedDistanceFields);
+}
+
+static FAutoConsoleCommandWithWorld BakeGraphCommand(
+	TEXT("AGP.Pathfinding.BakeGraph"),
+	TEXT("Bakes the navigation node actors of the current map, their landmarks and their distance fields, to the file that the map loads when its world settings ask for a baked navigation graph."),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		const UPathfindingSubsystem* PathfindingSubsystem = World ? World->GetSubsystem<UPathfindingSubsystem>() : nullptr;
+		if (PathfindingSubsystem)
 		{
-			CoverNodes.Add(*It);
+			PathfindingSubsystem->BakeNavigationGraph();
 		}
+	}));
+
+void UPathfindingSubsystem::BuildGraph(TConstArrayView<FVector> Locations, TConstArrayView<EPointType> NodeTypes, TConstArrayView<TArray<int32>> Connections)
+{
+	const TSharedRef<FNavigationGraph, ESPMode::ThreadSafe> NewGraph = MakeShared<FNavigationGraph, ESPMode::ThreadSafe>();
+	NewGraph->Build(Locations, NodeTypes, Connections);
+	SetGraph(NewGraph);
+}
+
+void UPathfindingSubsystem::SetGraph(const TSharedRef<FNavigationGraph, ESPMode::ThreadSafe>& NewGraph,
+	const TSharedPtr<const FBakedNavigationGraph, ESPMode::ThreadSafe>& BakedGraph)
+{
+	NewGraph->SetVersion(++GraphVersion);
+	NewGraph->SetLayoutVersion(GraphVersion);
+	Graph = NewGraph;
+	BaseGraph = NewGraph;
+	BlockedEdges.Init(false, NewGraph->GetNumEdges());
+	BlockedNodes.Init(false, NewGraph->GetNumNodes());
+	NodeCostMultipliers.Init(1.0f, NewGraph->GetNumNodes());
+	PendingEdgeBlocks.Reset();
+	PendingNodeBlocks.Reset();
+	PendingNodeCostMultipliers.Reset();
+
+	// Build the spatial indices used by the nearest node queries. They are new objects rather than rebuilt in place, as
+	// the workers may still be reading the old ones through their snapshots.
+	const TSharedRef<FNavigationSpatialIndex, ESPMode::ThreadSafe> NewSpatialIndex = MakeShared<FNavigationSpatialIndex, ESPMode::ThreadSafe>();
+	NewSpatialIndex->Build(*NewGraph);
+	SpatialIndex = NewSpatialIndex;
+
+	// Precompute the distance to the nearest cover, spawn and escape points from every node, unless they were baked.
+	const TSharedRef<FNavigationDistanceFields, ESPMode::ThreadSafe> NewDistanceFields = MakeShared<FNavigationDistanceFields, ESPMode::ThreadSafe>();
+	if (BakedGraph && BakedGraph->HasDistanceFields())
+	{
+		NewDistanceFields->InitFromBaked(BakedGraph.ToSharedRef(), NewGraph->GetVersion());
+	}
+	else
+	{
+		const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+		NewDistanceFields->Build(*Graph, Workspace.Get());
+	}
+	DistanceFields = NewDistanceFields;
+	bDistanceFieldsStale = false;
+	PublishSnapshot();
+}
+
+void UPathfindingSubsystem::PublishSnapshot()
+{
+	const TSharedRef<FNavigationSnapshot, ESPMode::ThreadSafe> NewSnapshot = MakeShared<FNavigationSnapshot, ESPMode::ThreadSafe>();
+	NewSnapshot->Graph = Graph;
+	NewSnapshot->SpatialIndex = SpatialIndex;
+	NewSnapshot->DistanceFields = DistanceFields;
+	NewSnapshot->NextHopTable = NextHopTable;
+	NewSnapshot->Landmarks = Landmarks;
+	NewSnapshot->ContractionHierarchy = ContractionHierarchy;
+	NewSnapshot->NavigationHierarchy = NavigationHierarchy;
+	Snapshot = NewSnapshot;
+}
+
+void UPathfindingSubsystem::BuildNextHopTable()
+{
+	NextHopTable.Reset();
+	PublishSnapshot();
+
+	const AAGPWorldSettings* WorldSettings = Cast<AAGPWorldSettings>(GetWorld()->GetWorldSettings());
+	if (!Graph || !WorldSettings || !WorldSettings->bUseNextHopTable)
+	{
+		return;
+	}
+	if (Graph->GetNumNodes() > WorldSettings->MaxNextHopTableNodes)
+	{
+		UE_LOG(LogPathfinding, Warning, TEXT("Skipping the next hop table as there are %d nodes, more than the limit of %d."),
+			Graph->GetNumNodes(), WorldSettings->MaxNextHopTableNodes)
+		return;
+	}
+	const int64 RequiredSize = FNextHopTable::GetRequiredSize(Graph->GetNumNodes());
+	if (RequiredSize > static_cast<int64>(WorldSettings->MaxNextHopTableMegabytes) * 1024 * 1024)
+	{
+		UE_LOG(LogPathfinding, Warning, TEXT("Skipping the next hop table as it would need %.1f MB, more than the limit of %d MB."),
+			RequiredSize / (1024.0 * 1024.0), WorldSettings->MaxNextHopTableMegabytes)
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const TSharedRef<FNextHopTable, ESPMode::ThreadSafe> NewTable = MakeShared<FNextHopTable, ESPMode::ThreadSafe>();
+	NewTable->Build(*Graph);
+	NextHopTable = NewTable;
+	PublishSnapshot();
+	UE_LOG(LogPathfinding, Display, TEXT("Built the next hop table for %d nodes in %.1f ms using %.2f MB."),
+		Graph->GetNumNodes(), (FPlatformTime::Seconds() - StartTime) * 1000.0, NewTable->GetAllocatedSize() / (1024.0 * 1024.0))
+}
+
+void UPathfindingSubsystem::BuildLandmarks()
+{
+	Landmarks.Reset();
+	PublishSnapshot();
+
+	const AAGPWorldSettings* WorldSettings = Cast<AAGPWorldSettings>(GetWorld()->GetWorldSettings());
+	if (!Graph || !WorldSettings || WorldSettings->NumLandmarks <= 0)
+	{
+		return;
 	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const TSharedRef<FNavigationLandmarks, ESPMode::ThreadSafe> NewLandmarks = MakeShared<FNavigationLandmarks, ESPMode::ThreadSafe>();
+	{
+		const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+		NewLandmarks->Build(*Graph, Workspace.Get(), WorldSettings->NumLandmarks);
+	}
+	Landmarks = NewLandmarks;
+	PublishSnapshot();
+	UE_LOG(LogPathfinding, Display, TEXT("Built %d landmarks in %.1f ms using %.2f MB."), NewLandmarks->GetNumLandmarks(),
+		(FPlatformTime::Seconds() - StartTime) * 1000.0, NewLandmarks->GetAllocatedSize() / (1024.0 * 1024.0))
+}
+
+void UPathfindingSubsystem::BuildContractionHierarchy()
+{
+	ContractionHierarchy.Reset();
+	PublishSnapshot();
+
+	const AAGPWorldSettings* WorldSettings = Cast<AAGPWorldSettings>(GetWorld()->GetWorldSettings());
+	if (!Graph || !WorldSettings || !WorldSettings->bUseContractionHierarchy)
+	{
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const TSharedRef<FContractionHierarchy, ESPMode::ThreadSafe> NewHierarchy = MakeShared<FContractionHierarchy, ESPMode::ThreadSafe>();
+	{
+		const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+		NewHierarchy->Build(*Graph, Workspace.Get());
+	}
+	ContractionHierarchy = NewHierarchy;
+	PublishSnapshot();
+	UE_LOG(LogPathfinding, Display, TEXT("Built the contraction hierarchy for %d nodes with %d shortcuts in %.1f ms using %.2f MB."),
+		Graph->GetNumNodes(), NewHierarchy->GetNumShortcuts(), (FPlatformTime::Seconds() - StartTime) * 1000.0,
+		NewHierarchy->GetAllocatedSize() / (1024.0 * 1024.0))
+}
+
+void UPathfindingSubsystem::BuildNavigationHierarchy()
+{
+	NavigationHierarchy.Reset();
+	PublishSnapshot();
+
+	const AAGPWorldSettings* WorldSettings = Cast<AAGPWorldSettings>(GetWorld()->GetWorldSettings());
+	if (!Graph || !WorldSettings || !WorldSettings->bUseHierarchicalPathfinding)
+	{
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	const TSharedRef<FNavigationHierarchy, ESPMode::ThreadSafe> NewHierarchy = MakeShared<FNavigationHierarchy, ESPMode::ThreadSafe>();
+	NewHierarchy->Build(*Graph);
+	NavigationHierarchy = NewHierarchy;
+	PublishSnapshot();
+	UE_LOG(LogPathfinding, Display, TEXT("Built the navigation hierarchy with %d clusters and %d entrances in %.1f ms."),
+		NewHierarchy->GetNumClusters(), NewHierarchy->GetNumEntrances(), (FPlatformTime::Seconds() - StartTime) * 1000.0)
 }
 
-ANavigationNode* UPathfindingSubsystem::GetRandomNode()
+void UPathfindingSubsystem::LogHeuristicComparison(int32 NumSamples) const
+{
+	if (!Graph || Graph->GetNumNodes() == 0)
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("The navigation graph has not been built."))
+		return;
+	}
+	if (!Landmarks || Landmarks->GetGraphVersion() != Graph->GetLayoutVersion())
+	{
+		UE_LOG(LogPathfinding, Warning, TEXT("There are no landmarks for the current graph. Set NumLandmarks in the world settings."))
+		return;
+	}
+
+	const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+	FRandomStream RandomStream(NumSamples);
+	TArray<FVector> Path;
+	int64 StraightLineExpanded = 0;
+	int64 LandmarkExpanded = 0;
+	for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+	{
+		const int32 StartNode = RandomStream.RandRange(0, Graph->GetNumNodes() - 1);
+		const int32 EndNode = RandomStream.RandRange(0, Graph->GetNumNodes() - 1);
+		FNavigationSearch::FindPath(*Graph, Workspace.Get(), StartNode, EndNode, Path);
+		StraightLineExpanded += Workspace.Get().GetNumExpanded();
+		FNavigationSearch::FindPath(*Graph, Workspace.Get(), StartNode, EndNode, Path, Landmarks.Get());
+		LandmarkExpanded += Workspace.Get().GetNumExpanded();
+	}
+
+	UE_LOG(LogPathfinding, Display, TEXT("Expanded nodes over %d searches on %d nodes: straight line %.1f per search, %d landmarks %.1f per search (%.1f%%)."),
+		NumSamples, Graph->GetNumNodes(), static_cast<double>(StraightLineExpanded) / FMath::Max(NumSamples, 1),
+		Landmarks->GetNumLandmarks(), static_cast<double>(LandmarkExpanded) / FMath::Max(NumSamples, 1),
+		StraightLineExpanded > 0 ? 100.0 * LandmarkExpanded / StraightLineExpanded : 0.0)
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CompareHeuristicsCommand(
+	TEXT("AGP.Pathfinding.CompareHeuristics"),
+	TEXT("Logs the nodes expanded by A* with the straight line and the landmark heuristics. Optional argument: the number of searches."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const UPathfindingSubsystem* PathfindingSubsystem = World ? World->GetSubsystem<UPathfindingSubsystem>() : nullptr;
+		if (PathfindingSubsystem)
+		{
+			PathfindingSubsystem->LogHeuristicComparison(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000);
+		}
+	}));
+
+void UPathfindingSubsystem::LogBidirectionalComparison(int32 NumSamples) const
+{
+	if (!Graph || Graph->GetNumNodes() == 0)
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("The navigation graph has not been built."))
+		return;
+	}
+
+	const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+	FRandomStream RandomStream(NumSamples);
+	TArray<FVector> Path;
+	int64 UnidirectionalExpanded = 0;
+	int64 BidirectionalExpanded = 0;
+	double UnidirectionalSeconds = 0.0;
+	double BidirectionalSeconds = 0.0;
+	int32 NumMismatches = 0;
+	for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+	{
+		const int32 StartNode = RandomStream.RandRange(0, Graph->GetNumNodes() - 1);
+		const int32 EndNode = RandomStream.RandRange(0, Graph->GetNumNodes() - 1);
+
+		double StartTime = FPlatformTime::Seconds();
+		const bool bUnidirectionalFound = FNavigationSearch::FindPath(*Graph, Workspace.Get(), StartNode, EndNode, Path);
+		UnidirectionalSeconds += FPlatformTime::Seconds() - StartTime;
+		UnidirectionalExpanded += Workspace.Get().GetNumExpanded();
+
+		StartTime = FPlatformTime::Seconds();
+		const bool bBidirectionalFound = FNavigationSearch::FindPathBidirectional(*Graph, Workspace.Get(), StartNode, EndNode, Path);
+		BidirectionalSeconds += FPlatformTime::Seconds() - StartTime;
+		BidirectionalExpanded += Workspace.Get().GetNumExpanded() + Workspace.Get().GetReverseWorkspace().GetNumExpanded();
+
+		if (bUnidirectionalFound != bBidirectionalFound)
+		{
+			++NumMismatches;
+		}
+	}
+
+	const double Samples = FMath::Max(NumSamples, 1);
+	UE_LOG(LogPathfinding, Display, TEXT("Over %d searches on %d nodes: unidirectional %.1f expanded and %.1f us per search, bidirectional %.1f expanded and %.1f us per search."),
+		NumSamples, Graph->GetNumNodes(), UnidirectionalExpanded / Samples, UnidirectionalSeconds * 1000000.0 / Samples,
+		BidirectionalExpanded / Samples, BidirectionalSeconds * 1000000.0 / Samples)
+	if (NumMismatches > 0)
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("The two searches disagreed on whether there was a path %d times."), NumMismatches)
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs CompareBidirectionalCommand(
+	TEXT("AGP.Pathfinding.CompareBidirectional"),
+	TEXT("Logs the nodes expanded and the time taken by unidirectional and bidirectional A*. Optional argument: the number of searches."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const UPathfindingSubsystem* PathfindingSubsystem = World ? World->GetSubsystem<UPathfindingSubsystem>() : nullptr;
+		if (PathfindingSubsystem)
+		{
+			PathfindingSubsystem->LogBidirectionalComparison(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000);
+		}
+	}));
+
+#if ENABLE_DRAW_DEBUG
+static TAutoConsoleVariable<bool> CVarDrawNavigationGraph(
+	TEXT("AGP.Pathfinding.DrawGraph"),
+	false,
+	TEXT("Draws the navigation graph: the nodes coloured by point type, two way edges green, one way edges red and blocked edges grey."));
+
+void UPathfindingSubsystem::UpdateGraphDebugDrawing()
+{
+	if (!CVarDrawNavigationGraph.GetValueOnGameThread() || !Graph)
+	{
+		if (GraphDebugComponent && GraphDebugComponent->GetDrawnGraphVersion() != 0)
+		{
+			GraphDebugComponent->ClearGraph();
+		}
+		return;
+	}
+
+	if (!GraphDebugComponent)
+	{
+		GraphDebugComponent = NewObject<UNavigationGraphDebugComponent>(this);
+		GraphDebugComponent->RegisterComponentWithWorld(GetWorld());
+	}
+	// The lines stay on screen between draws, so only draw again when there is a new snapshot.
+	if (GraphDebugComponent->GetDrawnGraphVersion() != Graph->GetVersion())
+	{
+		GraphDebugComponent->DrawGraph(*Graph);
+	}
+}
+#endif
+
+int32 UPathfindingSubsystem::GetRandomNode() const
 {
 	// Failure condition
-	if (Nodes.Num() == 0)
+	if (!Graph || Graph->GetNumNodes() == 0)
 	{
-		UE_LOG(LogTemp, Error, TEXT("The nodes array is empty."))
-		return nullptr;
+		UE_LOG(LogPathfinding, Error, TEXT("The nodes array is empty."))
+		return INDEX_NONE;
 	}
-	const int32 RandIndex = FMath::RandRange(0, Nodes.Num()-1);
-	return Nodes[RandIndex];
+	const int32 RandIndex = FMath::RandRange(0, Graph->GetNumNodes()-1);
+	return RandIndex;
 }
 
-ANavigationNode* UPathfindingSubsystem::FindNearestNode(TArray<ANavigationNode*>OtherNodes,const FVector& TargetLocation)
+int32 UPathfindingSubsystem::FindNearestNode(const FNavigationSnapshot& NavigationSnapshot, EPointType PointType, const FVector& TargetLocation) const
 {
+	SCOPE_CYCLE_COUNTER(STAT_PathfindingFindNearestNode);
 	// Failure condition.
-	if (OtherNodes.Num() == 0)
+	if (!NavigationSnapshot.SpatialIndex || NavigationSnapshot.SpatialIndex->GetNodeGrid(PointType).IsEmpty())
 	{
-		UE_LOG(LogTemp, Error, TEXT("The nodes array is empty."))
-		return nullptr;
+		UE_LOG(LogPathfinding, Error, TEXT("There are no nodes of the requested point type."))
+		return INDEX_NONE;
 	}
 
-	// Using the minimum programming pattern to find the closest node.
-	// What is the Big O complexity of this? Can you do it more efficiently?
-	ANavigationNode* ClosestNode = nullptr;
-	float MinDistance = UE_MAX_FLT;
-	for (ANavigationNode* Node : OtherNodes)
+	// The grid only looks at the cells around the TargetLocation instead of every node.
+	return NavigationSnapshot.SpatialIndex->GetNodeGrid(PointType).FindNearest(TargetLocation);
+}
+
+int32 UPathfindingSubsystem::FindNearestNode(const FVector& TargetLocation) const
+{
+	return FindNearestNode(*Snapshot, TargetLocation);
+}
+
+int32 UPathfindingSubsystem::FindNearestNode(const FNavigationSnapshot& NavigationSnapshot, const FVector& TargetLocation) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_PathfindingFindNearestNode);
+	// Failure condition.
+	if (!NavigationSnapshot.SpatialIndex || NavigationSnapshot.SpatialIndex->GetNodeGrid().IsEmpty())
 	{
-		const float Distance = FVector::Distance(TargetLocation, Node->GetActorLocation());
-		if (Distance < MinDistance)
+		UE_LOG(LogPathfinding, Error, TEXT("The nodes array is empty."))
+		return INDEX_NONE;
+	}
+
+	// The grid only looks at the cells around the TargetLocation instead of every node.
+	return NavigationSnapshot.SpatialIndex->GetNodeGrid().FindNearest(TargetLocation);
+}
+
+int32 UPathfindingSubsystem::FindFurthestNode(const FNavigationSnapshot& NavigationSnapshot, const FVector& TargetLocation, EFurthestNodeMode Mode) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_PathfindingFindFurthestNode);
+	// Failure condition.
+	if (!NavigationSnapshot.Graph || !NavigationSnapshot.SpatialIndex || NavigationSnapshot.SpatialIndex->GetFurthestTree().IsEmpty())
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("The nodes array is empty."))
+		return INDEX_NONE;
+	}
+
+	if (Mode == EFurthestNodeMode::PathDistance)
+	{
+		const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+		const int32 FurthestNode = FNavigationSearch::FindFurthestNodeByPathDistance(*NavigationSnapshot.Graph, Workspace.Get(),
+			FindNearestNode(NavigationSnapshot, TargetLocation));
+		RecordSearchStats(Workspace.Get().GetNumExpanded(), Workspace.Get().GetPeakOpenSetSize());
+		return FurthestNode;
+	}
+
+	// The tree skips every box of nodes that can't be further away than the best node found so far.
+	return NavigationSnapshot.SpatialIndex->GetFurthestTree().FindFurthest(TargetLocation);
+}
+
+void UPathfindingSubsystem::GetSplinePoint()
+{
+	SplinePoints.Empty();
+	if (BunkerActor)
+	{
+		int32 NumberOfPoints = BunkerActor->Spline->GetNumberOfSplinePoints();
+		for(int32 i = 0; i < NumberOfPoints; ++i)
 		{
-			MinDistance = Distance;
-			ClosestNode = Node;
+			FVector PointLocation = BunkerActor->Spline->GetLocationAtSplinePoint(i, ESplineCoordinateSpace::World);
+			SplinePoints.Add(PointLocation);
 		}
 	}
 
-	return ClosestNode;
+	TArray<int32> SplinePointIndices;
+	for (int32 i = 0; i < SplinePoints.Num(); ++i)
+	{
+		SplinePointIndices.Add(i);
+	}
+	SplinePointFurthestTree.Build(SplinePoints, SplinePointIndices);
 }
 
 
-ANavigationNode* UPathfindingSubsystem::FindNearestNode(const FVector& TargetLocation)
+
+TArray<FVector> UPathfindingSubsystem::GetPath(int32 StartNode, int32 EndNode, bool bBidirectional) const
 {
-	// Failure condition.
-	if (Nodes.Num() == 0)
+	SCOPE_CYCLE_COUNTER(STAT_PathfindingGetPath);
+	CSV_SCOPED_TIMING_STAT(Pathfinding, GetPath);
+	INC_DWORD_STAT(STAT_PathfindingQueries);
+	if (!Graph)
 	{
-		UE_LOG(LogTemp, Error, TEXT("The nodes array is empty."))
-		return nullptr;
+		UE_LOG(LogPathfinding, Error, TEXT("The navigation graph has not been built."))
+		return TArray<FVector>();
+	}
+	if (!Graph->IsValidNode(StartNode) || !Graph->IsValidNode(EndNode))
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("Either the start or end node are invalid."))
+		INC_DWORD_STAT(STAT_PathfindingFailedQueries);
+		return TArray<FVector>();
+	}
+
+	// Take a workspace from the pool so that the search doesn't need to allocate its scores and open set.
+	const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+	TArray<FVector> Path;
+	if (FindPathCached(*Snapshot, Workspace.Get(), StartNode, EndNode, Path, bBidirectional))
+	{
+		UE_LOG(LogPathfinding, Verbose, TEXT("PATH FOUND"))
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_PathfindingFailedQueries);
+	}
+	return Path;
+}
+
+TArray<FVector> UPathfindingSubsystem::GetPathToNearest(EPointType PointType, const FVector& StartLocation) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_PathfindingGetPathToNearest);
+	CSV_SCOPED_TIMING_STAT(Pathfinding, GetPathToNearest);
+	INC_DWORD_STAT(STAT_PathfindingQueries);
+	if (!Graph)
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("The navigation graph has not been built."))
+		return TArray<FVector>();
+	}
+
+	const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+	TArray<FVector> Path;
+	if (FindPathToNearest(*Snapshot, Workspace.Get(), PointType, FindNearestNode(StartLocation), Path))
+	{
+		UE_LOG(LogPathfinding, Verbose, TEXT("PATH FOUND"))
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_PathfindingFailedQueries);
 	}
+	return Path;
+}
 
-	// Using the minimum programming pattern to find the closest node.
-	// What is the Big O complexity of this? Can you do it more efficiently?
-	ANavigationNode* ClosestNode = nullptr;
-	float MinDistance = UE_MAX_FLT;
-	for (ANavigationNode* Node : Nodes)
+FNavigationGoalSet UPathfindingSubsystem::MakePointTypeGoalSet(uint32 PointTypeMask) const
+{
+	FNavigationGoalSet Goals;
+	if (!SpatialIndex)
+	{
+		return Goals;
+	}
+	for (int32 PointType = 0; PointType < static_cast<int32>(EPointType::MAX); ++PointType)
 	{
-		const float Distance = FVector::Distance(TargetLocation, Node->GetActorLocation());
-		if (Distance < MinDistance)
+		if (PointTypeMask & FNavigationGoalSet::GetPointTypeBit(static_cast<EPointType>(PointType)))
 		{
-			MinDistance = Distance;
-			ClosestNode = Node;
+			Goals.AddPointType(static_cast<EPointType>(PointType), SpatialIndex.ToSharedRef());
 		}
 	}
+	return Goals;
+}
 
-	return ClosestNode;
+TArray<FVector> UPathfindingSubsystem::GetPathToAnyGoal(const FVector& StartLocation, const FNavigationGoalSet& Goals) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_PathfindingGetPathToAnyGoal);
+	INC_DWORD_STAT(STAT_PathfindingQueries);
+	TArray<FVector> Path;
+	if (!Graph)
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("The navigation graph has not been built."))
+		return Path;
+	}
+
+	const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+	const bool bFound = FNavigationSearch::FindPathToAnyGoal(*Graph, Workspace.Get(), FindNearestNode(StartLocation), Goals, Path) != INDEX_NONE;
+	RecordSearchStats(Workspace.Get().GetNumExpanded(), Workspace.Get().GetPeakOpenSetSize());
+	if (bFound)
+	{
+		UE_LOG(LogPathfinding, Verbose, TEXT("PATH FOUND"))
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_PathfindingFailedQueries);
+	}
+	return Path;
 }
 
-ANavigationNode* UPathfindingSubsystem::FindFurthestNode(const FVector& TargetLocation)
+void UPathfindingSubsystem::FindNearestGoals(const FVector& StartLocation, const FNavigationGoalSet& Goals, int32 MaxGoals, TArray<FNavigationGoalCandidate>& OutGoals, TArray<TArray<FVector>>* OutPaths) const
 {
-	// Failure condition.
-	if (Nodes.Num() == 0)
+	SCOPE_CYCLE_COUNTER(STAT_PathfindingFindNearestGoals);
+	INC_DWORD_STAT(STAT_PathfindingQueries);
+	OutGoals.Reset();
+	if (OutPaths)
+	{
+		OutPaths->Reset();
+	}
+	if (!Graph)
 	{
-		UE_LOG(LogTemp, Error, TEXT("The nodes array is empty."))
+		UE_LOG(LogPathfinding, Error, TEXT("The navigation graph has not been built."))
+		return;
+	}
+
+	const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+	FNavigationSearch::FindNearestGoals(*Graph, Workspace.Get(), FindNearestNode(StartLocation), Goals, MaxGoals, OutGoals);
+	RecordSearchStats(Workspace.Get().GetNumExpanded(), Workspace.Get().GetPeakOpenSetSize());
+	if (OutGoals.IsEmpty())
+	{
+		INC_DWORD_STAT(STAT_PathfindingFailedQueries);
+	}
+	if (OutPaths)
+	{
+		// The paths are still in the workspace from the search.
+		OutPaths->SetNum(OutGoals.Num());
+		for (int32 GoalIndex = 0; GoalIndex < OutGoals.Num(); ++GoalIndex)
+		{
+			FNavigationSearch::ReconstructPath(*Graph, Workspace.Get(), OutGoals[GoalIndex].NodeId, (*OutPaths)[GoalIndex]);
+		}
+	}
+}
+
+TSharedPtr<FDStarLitePlanner, ESPMode::ThreadSafe> UPathfindingSubsystem::CreatePlanner(EPointType GoalType)
+{
+	if (!Graph)
+	{
+		UE_LOG(LogPathfinding, Error, TEXT("The navigation graph has not been built."))
 		return nullptr;
 	}
 
-	// Using the minimum programming pattern to find the closest node.
-	// What is the Big O complexity of this? Can you do it more efficiently?
-	ANavigationNode* FurthestNode = nullptr;
-	float MaxDistance = -1.0f;
-	for (ANavigationNode* Node : Nodes)
+	TArray<int32> GoalNodes;
+	for (int32 NodeId = 0; NodeId < Graph->GetNumNodes(); ++NodeId)
 	{
-		const float Distance = FVector::Distance(TargetLocation, Node->GetActorLocation());
-		if (Distance > MaxDistance)
+		if (Graph->GetNodeType(NodeId) == GoalType)
 		{
-			MaxDistance = Distance;
-			FurthestNode = Node;
+			GoalNodes.Add(NodeId);
 		}
 	}
 
-	return FurthestNode;
+	// Agents that come and go would otherwise grow the list until the graph next changes.
+	Planners.RemoveAllSwap([](const TWeakPtr<FDStarLitePlanner, ESPMode::ThreadSafe>& Planner) { return !Planner.IsValid(); });
+
+	const TSharedRef<FDStarLitePlanner, ESPMode::ThreadSafe> Planner = MakeShared<FDStarLitePlanner, ESPMode::ThreadSafe>();
+	Planner->Initialize(Graph, GoalNodes);
+	Planners.Add(Planner);
+	return Planner;
 }
 
-void UPathfindingSubsystem::GetSplinePoint()
+bool UPathfindingSubsystem::ReplanPath(FDStarLitePlanner& Planner, const FVector& StartLocation, TArray<FVector>& OutPath) const
 {
-	int32 NumberOfPoints = BunkerActor->Spline->GetNumberOfSplinePoints();
-	for(int32 i = 0; i < NumberOfPoints; ++i)
+	SCOPE_CYCLE_COUNTER(STAT_PathfindingReplanPath);
+	CSV_SCOPED_TIMING_STAT(Pathfinding, ReplanPath);
+	INC_DWORD_STAT(STAT_PathfindingQueries);
+	// The planners are moved onto every new snapshot of the graph, so its node ids are the same as the current ones.
+	const bool bFound = Planner.FindPath(FindNearestNode(StartLocation), OutPath);
+	// The planner keeps its open set between replans, so only the expansions are worth recording.
+	RecordSearchStats(Planner.GetNumExpanded(), 0);
+	if (!bFound)
 	{
-		FVector PointLocation = BunkerActor->Spline->GetLocationAtSplinePoint(i, ESplineCoordinateSpace::World);
-		SplinePoints.Add(PointLocation);
+		INC_DWORD_STAT(STAT_PathfindingFailedQueries);
 	}
+	return bFound;
 }
 
+void UPathfindingSubsystem::SetEdgeBlocked(int32 FromNode, int32 ToNode, bool bBlocked)
+{
+	if (!BaseGraph || !BaseGraph->IsValidNode(FromNode) || !BaseGraph->IsValidNode(ToNode))
+	{
+		UE_LOG(LogPathfinding, Warning, TEXT("Can't change the edge from node %d to node %d as it isn't in the graph."), FromNode, ToNode)
+		return;
+	}
+	PendingEdgeBlocks.Add(FIntPoint(FromNode, ToNode), bBlocked);
+}
 
+void UPathfindingSubsystem::SetNodeBlocked(int32 NodeId, bool bBlocked)
+{
+	if (!BaseGraph || !BaseGraph->IsValidNode(NodeId))
+	{
+		UE_LOG(LogPathfinding, Warning, TEXT("Can't change node %d as it isn't in the graph."), NodeId)
+		return;
+	}
+	PendingNodeBlocks.Add(NodeId, bBlocked);
+}
 
-TArray<FVector> UPathfindingSubsystem::GetPath(ANavigationNode* StartNode, ANavigationNode* EndNode)
+void UPathfindingSubsystem::SetNodeCostMultiplier(int32 NodeId, float Multiplier)
 {
-	if (!StartNode || !EndNode)
+	if (!BaseGraph || !BaseGraph->IsValidNode(NodeId))
 	{
-		UE_LOG(LogTemp, Error, TEXT("Either the start or end node are nullptrs."))
-		return TArray<FVector>();
+		UE_LOG(LogPathfinding, Warning, TEXT("Can't change node %d as it isn't in the graph."), NodeId)
+		return;
 	}
+	// Cheaper edges than the ones the graph was built with would make the straight line and landmark heuristics
+	// overestimate, so the multipliers can only make paths more expensive.
+	PendingNodeCostMultipliers.Add(NodeId, FMath::Max(Multiplier, 1.0f));
+}
 
-	// Setup the open set and add the start node.
-	TArray<ANavigationNode*> OpenSet;
-	OpenSet.Add(StartNode);
+void UPathfindingSubsystem::SetCostMultiplierInRadius(const FVector& Location, float Radius, float Multiplier)
+{
+	if (!SpatialIndex)
+	{
+		return;
+	}
+	TArray<int32> NodeIds;
+	SpatialIndex->GetNodeGrid().FindInRadius(Location, Radius, NodeIds);
+	for (const int32 NodeId : NodeIds)
+	{
+		SetNodeCostMultiplier(NodeId, Multiplier);
+	}
+}
 
-	// Setup the maps that will hold the GScores, HScores and CameFrom
-	TMap<ANavigationNode*, float> GScores, HScores;
-	TMap<ANavigationNode*, ANavigationNode*> CameFrom;
-	// You could pre-populate the GScores and HScores maps with all of the GScores (at infinity) and HScores here by looping over
-	// all the nodes in the Nodes array. However it is more efficient to only calculate these when you need them
-	// as some nodes might not be explored when finding a path.
+float UPathfindingSubsystem::GetModifiedEdgeCost(int32 EdgeId, int32 FromNode) const
+{
+	const int32 ToNode = BaseGraph->GetEdgeTarget(EdgeId);
+	if (BlockedEdges[EdgeId] || BlockedNodes[FromNode] || BlockedNodes[ToNode])
+	{
+		return UE_MAX_FLT;
+	}
+	return BaseGraph->GetEdgeCost(EdgeId) * FMath::Max(NodeCostMultipliers[FromNode], NodeCostMultipliers[ToNode]);
+}
 
-	// Setup the start nodes G and H score.
-	GScores.Add(StartNode, 0);
-	HScores.Add(StartNode, FVector::Distance(StartNode->GetActorLocation(), EndNode->GetActorLocation()));
-	CameFrom.Add(StartNode, nullptr);
+void UPathfindingSubsystem::ApplyGraphChanges()
+{
+	SCOPE_CYCLE_COUNTER(STAT_PathfindingApplyGraphChanges);
+	if (!BaseGraph || (PendingEdgeBlocks.IsEmpty() && PendingNodeBlocks.IsEmpty() && PendingNodeCostMultipliers.IsEmpty()))
+	{
+		return;
+	}
 
-	while (!OpenSet.IsEmpty())
+	// Record the changes and gather every edge whose cost they may have changed, along with the node it starts at.
+	TBitArray<> DirtyEdges(false, BaseGraph->GetNumEdges());
+	TArray<TPair<int32, int32>> EdgesToUpdate;
+	const auto MarkEdge = [&DirtyEdges, &EdgesToUpdate](int32 EdgeId, int32 FromNode)
 	{
-		// Find the node in the open set with the lowest FScore.
-		ANavigationNode* CurrentNode = OpenSet[0]; // We know this exists because the OpenSet is not empty.
-		for (int32 i = 1; i < OpenSet.Num(); i++)
+		if (!DirtyEdges[EdgeId])
 		{
-			// We can be sure that all the nodes in the open set have already had their GScores and HScores calculated.
-			if (GScores[OpenSet[i]] + HScores[OpenSet[i]] < GScores[CurrentNode] + HScores[CurrentNode])
+			DirtyEdges[EdgeId] = true;
+			EdgesToUpdate.Emplace(EdgeId, FromNode);
+		}
+	};
+	const auto MarkNodeEdges = [this, &MarkEdge](int32 NodeId)
+	{
+		for (int32 EdgeId = BaseGraph->GetEdgeBegin(NodeId); EdgeId < BaseGraph->GetEdgeEnd(NodeId); ++EdgeId)
+		{
+			MarkEdge(EdgeId, NodeId);
+		}
+		for (int32 ReverseEdgeId = BaseGraph->GetReverseEdgeBegin(NodeId); ReverseEdgeId < BaseGraph->GetReverseEdgeEnd(NodeId); ++ReverseEdgeId)
+		{
+			MarkEdge(BaseGraph->GetReverseEdgeForwardId(ReverseEdgeId), BaseGraph->GetReverseEdgeSource(ReverseEdgeId));
+		}
+	};
+
+	for (const TPair<FIntPoint, bool>& Change : PendingEdgeBlocks)
+	{
+		const int32 FromNode = Change.Key.X;
+		for (int32 EdgeId = BaseGraph->GetEdgeBegin(FromNode); EdgeId < BaseGraph->GetEdgeEnd(FromNode); ++EdgeId)
+		{
+			if (BaseGraph->GetEdgeTarget(EdgeId) == Change.Key.Y)
 			{
-				CurrentNode = OpenSet[i];
+				BlockedEdges[EdgeId] = Change.Value;
+				MarkEdge(EdgeId, FromNode);
+				break;
 			}
 		}
+	}
+	for (const TPair<int32, bool>& Change : PendingNodeBlocks)
+	{
+		BlockedNodes[Change.Key] = Change.Value;
+		MarkNodeEdges(Change.Key);
+	}
+	for (const TPair<int32, float>& Change : PendingNodeCostMultipliers)
+	{
+		NodeCostMultipliers[Change.Key] = Change.Value;
+		MarkNodeEdges(Change.Key);
+	}
+	PendingEdgeBlocks.Reset();
+	PendingNodeBlocks.Reset();
+	PendingNodeCostMultipliers.Reset();
 
-		// Remove the current node from the OpenSet
-		OpenSet.Remove(CurrentNode);
+	// The current snapshot may still be in use by the workers, so the changes go into a copy of it. The copy is only
+	// made once some edge has really changed cost.
+	TSharedPtr<FNavigationGraph, ESPMode::ThreadSafe> NewGraph;
+	TArray<int32> ChangedEdges;
+	TArray<int32> ChangedNodes;
+	for (const TPair<int32, int32>& Edge : EdgesToUpdate)
+	{
+		const float Cost = GetModifiedEdgeCost(Edge.Key, Edge.Value);
+		if (Cost == Graph->GetEdgeCost(Edge.Key))
+		{
+			continue;
+		}
+		if (!NewGraph)
+		{
+			NewGraph = MakeShared<FNavigationGraph, ESPMode::ThreadSafe>(*Graph);
+		}
+		NewGraph->SetEdgeCost(Edge.Key, Cost);
+		ChangedEdges.Add(Edge.Key);
+		ChangedNodes.Add(Edge.Value);
+		ChangedNodes.Add(BaseGraph->GetEdgeTarget(Edge.Key));
+	}
+	if (!NewGraph)
+	{
+		return;
+	}
 
-		if (CurrentNode == EndNode)
+	// The layout version is copied over so the landmarks stay in use, as the costs never go below the base costs.
+	NewGraph->SetVersion(++GraphVersion);
+	Graph = NewGraph;
+	NotifyPlanners(Graph, ChangedEdges);
+
+	// The next hop table and the contraction hierarchy are too expensive to rebuild every time the graph changes, so
+	// they go unused until the graph is rebuilt. The distance fields search the whole graph, so they are rebuilt on a
+	// worker by UpdateDistanceFields. Only the costs of the touched clusters of the hierarchy are rebuilt, and the
+	// copy shares everything else with the old hierarchy.
+	bDistanceFieldsStale = true;
+	if (NavigationHierarchy)
+	{
+		const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+		const TSharedRef<FNavigationHierarchy, ESPMode::ThreadSafe> NewHierarchy = MakeShared<FNavigationHierarchy, ESPMode::ThreadSafe>(*NavigationHierarchy);
+		NewHierarchy->RebuildClusters(*Graph, Workspace.Get(), ChangedNodes);
+		NavigationHierarchy = NewHierarchy;
+	}
+	PublishSnapshot();
+}
+
+void UPathfindingSubsystem::UpdateDistanceFields()
+{
+	if (DistanceFieldsTask.IsValid())
+	{
+		if (!DistanceFieldsTask.IsCompleted())
+		{
+			return;
+		}
+		// The graph may have been rebuilt while the task ran, in which case the fields built with it are newer.
+		const TSharedPtr<const FNavigationDistanceFields, ESPMode::ThreadSafe> NewDistanceFields = DistanceFieldsTask.GetResult();
+		DistanceFieldsTask = {};
+		if (!DistanceFields || NewDistanceFields->GetGraphVersion() > DistanceFields->GetGraphVersion())
 		{
-			// Then we have found the path so reconstruct it and get the positions of each of the nodes in the path.
-			UE_LOG(LogTemp, Display, TEXT("PATH FOUND"))
-			return ReconstructPath(CameFrom, EndNode);
+			DistanceFields = NewDistanceFields;
+			PublishSnapshot();
 		}
+	}
+
+	if (!bDistanceFieldsStale || !Graph)
+	{
+		return;
+	}
+	bDistanceFieldsStale = false;
+	DistanceFieldsTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, SourceGraph = Graph]()
+	{
+		const TSharedRef<FNavigationDistanceFields, ESPMode::ThreadSafe> NewDistanceFields = MakeShared<FNavigationDistanceFields, ESPMode::ThreadSafe>();
+		const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+		NewDistanceFields->Build(*SourceGraph, Workspace.Get());
+		return TSharedPtr<const FNavigationDistanceFields, ESPMode::ThreadSafe>(NewDistanceFields);
+	});
+}
 
-		for (ANavigationNode* ConnectedNode : CurrentNode->ConnectedNodes)
+void UPathfindingSubsystem::NotifyPlanners(const FNavigationGraphPtr& NewGraph, TConstArrayView<int32> ChangedEdges)
+{
+	for (int32 Index = Planners.Num() - 1; Index >= 0; --Index)
+	{
+		if (const TSharedPtr<FDStarLitePlanner, ESPMode::ThreadSafe> Planner = Planners[Index].Pin())
 		{
-			if (!ConnectedNode) continue; // Failsafe if the ConnectedNode is a nullptr.
-			const float TentativeGScore = GScores[CurrentNode] + FVector::Distance(CurrentNode->GetActorLocation(), ConnectedNode->GetActorLocation());
-			// Because we didn't setup all the scores and came from at the start, we need to check if the connected node has a gscore
-			// already otherwise set it. If it doesn't have a gscore then it won't have all the other things either so initialise them as well.
-			if (!GScores.Contains(ConnectedNode))
+			Planner->UpdateGraph(NewGraph, ChangedEdges);
+		}
+		else
+		{
+			Planners.RemoveAtSwap(Index);
+		}
+	}
+}
+
+void UPathfindingSubsystem::RecordSearchStats(int32 NumExpanded, int32 PeakOpenSetSize) const
+{
+	CSV_CUSTOM_STAT(Pathfinding, Searches, 1, ECsvCustomStatOp::Accumulate);
+	CSV_CUSTOM_STAT(Pathfinding, NodesExpanded, NumExpanded, ECsvCustomStatOp::Accumulate);
+#if STATS
+	INC_DWORD_STAT(STAT_PathfindingSearches);
+	INC_DWORD_STAT_BY(STAT_PathfindingNodesExpanded, NumExpanded);
+	int32 FramePeak = FrameOpenSetPeak.load(std::memory_order_relaxed);
+	while (PeakOpenSetSize > FramePeak && !FrameOpenSetPeak.compare_exchange_weak(FramePeak, PeakOpenSetSize, std::memory_order_relaxed))
+	{
+	}
+#endif
+}
+
+bool UPathfindingSubsystem::FindPathCached(const FNavigationSnapshot& NavigationSnapshot, FNavigationSearchWorkspace& Workspace, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath,
+	bool bBidirectional) const
+{
+	const FNavigationGraph& NavigationGraph = *NavigationSnapshot.Graph;
+	if (!NavigationGraph.IsValidNode(StartNode) || !NavigationGraph.IsValidNode(EndNode))
+	{
+		OutPath.Reset();
+		return false;
+	}
+
+	const FNextHopTable* Table = NavigationSnapshot.NextHopTable.Get();
+	if (Table && Table->GetGraphVersion() == NavigationGraph.GetVersion())
+	{
+		return Table->FindPath(NavigationGraph, StartNode, EndNode, OutPath);
+	}
+
+	// Hierarchy queries are cheap enough that caching them wouldn't save anything.
+	const FContractionHierarchy* Hierarchy = NavigationSnapshot.ContractionHierarchy.Get();
+	if (Hierarchy && Hierarchy->GetGraphVersion() == NavigationGraph.GetVersion())
+	{
+		return Hierarchy->FindPath(NavigationGraph, Workspace, StartNode, EndNode, OutPath);
+	}
+
+	if (PathCache.Find(NavigationGraph.GetVersion(), StartNode, EndNode, OutPath))
+	{
+		return !OutPath.IsEmpty();
+	}
+
+	// Both searches find a shortest path so their paths share the cache.
+	bool bFound;
+	if (bBidirectional)
+	{
+		bFound = FNavigationSearch::FindPathBidirectional(NavigationGraph, Workspace, StartNode, EndNode, OutPath);
+		const FNavigationSearchWorkspace& ReverseWorkspace = Workspace.GetReverseWorkspace();
+		RecordSearchStats(Workspace.GetNumExpanded() + ReverseWorkspace.GetNumExpanded(),
+			FMath::Max(Workspace.GetPeakOpenSetSize(), ReverseWorkspace.GetPeakOpenSetSize()));
+	}
+	else
+	{
+		const FNavigationLandmarks* GraphLandmarks = NavigationSnapshot.Landmarks.Get();
+		const bool bUseLandmarks = GraphLandmarks && GraphLandmarks->GetGraphVersion() == NavigationGraph.GetLayoutVersion();
+		bFound = FNavigationSearch::FindPath(NavigationGraph, Workspace, StartNode, EndNode, OutPath, bUseLandmarks ? GraphLandmarks : nullptr);
+		RecordSearchStats(Workspace.GetNumExpanded(), Workspace.GetPeakOpenSetSize());
+	}
+	PathCache.Add(NavigationGraph.GetVersion(), StartNode, EndNode, OutPath);
+	return bFound;
+}
+
+bool UPathfindingSubsystem::FindPathToNearest(const FNavigationSnapshot& NavigationSnapshot, FNavigationSearchWorkspace& Workspace, EPointType PointType, int32 StartNode, TArray<FVector>& OutPath) const
+{
+	const FNavigationGraph& NavigationGraph = *NavigationSnapshot.Graph;
+	if (!NavigationGraph.IsValidNode(StartNode))
+	{
+		OutPath.Reset();
+		return false;
+	}
+
+	const FNavigationDistanceFields* Fields = NavigationSnapshot.DistanceFields.Get();
+	if (Fields && Fields->GetGraphVersion() == NavigationGraph.GetVersion())
+	{
+		return Fields->FindPath(NavigationGraph, PointType, StartNode, OutPath);
+	}
+
+	FNavigationGoalSet Goals;
+	Goals.AddPointType(PointType, NavigationSnapshot.SpatialIndex.ToSharedRef());
+	const bool bFound = FNavigationSearch::FindPathToAnyGoal(NavigationGraph, Workspace, StartNode, Goals, OutPath) != INDEX_NONE;
+	RecordSearchStats(Workspace.GetNumExpanded(), Workspace.GetPeakOpenSetSize());
+	return bFound;
+}
+
+void UPathfindingSubsystem::ResolveQueryNodes(const FNavigationSnapshot& NavigationSnapshot, const FPathQuery& Query, const FRandomStream& RandomStream, int32& OutStartNode, int32& OutEndNode) const
+{
+	const FNavigationGraph& NavigationGraph = *NavigationSnapshot.Graph;
+	OutStartNode = FindNearestNode(NavigationSnapshot, Query.StartLocation);
+	OutEndNode = INDEX_NONE;
+	switch (Query.Kind)
+	{
+	case EPathQueryKind::Point:
+		OutEndNode = FindNearestNode(NavigationSnapshot, Query.TargetLocation);
+		break;
+	case EPathQueryKind::Random:
+		OutEndNode = NavigationGraph.GetNumNodes() > 0 ? RandomStream.RandRange(0, NavigationGraph.GetNumNodes() - 1) : INDEX_NONE;
+		break;
+	case EPathQueryKind::Away:
+		OutEndNode = FindFurthestNode(NavigationSnapshot, Query.TargetLocation, Query.FurthestNodeMode);
+		break;
+	case EPathQueryKind::Exit:
+	case EPathQueryKind::SpawnPoint:
+	case EPathQueryKind::NearestCover:
+		// These go to whichever node of their point type is nearest, which FindQueryPath gets from the DistanceFields.
+		break;
+	}
+}
+
+bool UPathfindingSubsystem::FindQueryPath(const FNavigationSnapshot& NavigationSnapshot, FNavigationSearchWorkspace& Workspace, const FPathQuery& Query, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath) const
+{
+	switch (Query.Kind)
+	{
+	case EPathQueryKind::Exit:
+		return FindPathToNearest(NavigationSnapshot, Workspace, EPointType::EscapePoint, StartNode, OutPath);
+	case EPathQueryKind::SpawnPoint:
+		return FindPathToNearest(NavigationSnapshot, Workspace, EPointType::SpawnPoint, StartNode, OutPath);
+	case EPathQueryKind::NearestCover:
+		return FindPathToNearest(NavigationSnapshot, Workspace, EPointType::Cover, StartNode, OutPath);
+	default:
+		return FindPathCached(NavigationSnapshot, Workspace, StartNode, EndNode, OutPath, Query.bBidirectional);
+	}
+}
+
+TArray<FVector> UPathfindingSubsystem::SolveQuery(const FNavigationSnapshot& NavigationSnapshot, const FPathQuery& Query, const FRandomStream& RandomStream, FPathContinuation& OutContinuation) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_PathfindingSolveQuery);
+	CSV_SCOPED_TIMING_STAT(Pathfinding, SolveQuery);
+	const FNavigationGraph& NavigationGraph = *NavigationSnapshot.Graph;
+	int32 StartNode, EndNode;
+	ResolveQueryNodes(NavigationSnapshot, Query, RandomStream, StartNode, EndNode);
+
+	const FNavigationSearchWorkspacePool::FScopedWorkspace Workspace(WorkspacePool);
+	TArray<FVector> Path;
+	OutContinuation.Reset();
+
+	// Node to node paths can be found over the hierarchy and then only refined for the part that is walked first.
+	const TSharedPtr<const FNavigationHierarchy, ESPMode::ThreadSafe>& Hierarchy = NavigationSnapshot.NavigationHierarchy;
+	const bool bNodeToNode = Query.Kind == EPathQueryKind::Point || Query.Kind == EPathQueryKind::Random || Query.Kind == EPathQueryKind::Away;
+	if (bNodeToNode && Hierarchy && Hierarchy->GetGraphVersion() == NavigationGraph.GetVersion())
+	{
+		if (Hierarchy->FindRoute(NavigationGraph, Workspace.Get(), StartNode, EndNode, OutContinuation.Route))
+		{
+			OutContinuation.Graph = NavigationSnapshot.Graph;
+			OutContinuation.Hierarchy = Hierarchy;
+			OutContinuation.NextStep = 1;
+			if (RefineRoute(Workspace.Get(), OutContinuation, Path))
 			{
-				GScores.Add(ConnectedNode, UE_MAX_FLT);
-				HScores.Add(ConnectedNode, FVector::Distance(ConnectedNode->GetActorLocation(), EndNode->GetActorLocation()));
-				CameFrom.Add(ConnectedNode, nullptr);
+				UE_LOG(LogPathfinding, Verbose, TEXT("PATH FOUND"))
 			}
-
-			// Then update this nodes scores and came from if the tentative g score is lower than the current g score.
-			if (TentativeGScore < GScores[ConnectedNode])
+			else
 			{
-				CameFrom[ConnectedNode] = CurrentNode;
-				GScores[ConnectedNode] = TentativeGScore;
-				// HScore is already set when adding the node to the HScores map.
-				// Then add connected node to the open set if it isn't already in there.
-				if (!OpenSet.Contains(ConnectedNode))
-				{
-					OpenSet.Add(ConnectedNode);
-				}
+				OutContinuation.Reset();
+				Path.Reset();
 			}
 		}
+		if (Path.IsEmpty())
+		{
+			INC_DWORD_STAT(STAT_PathfindingFailedQueries);
+		}
+		return Path;
 	}
 
-	// If we get here, then no path has been found so return an empty array.
-	return TArray<FVector>();
-	
+	if (FindQueryPath(NavigationSnapshot, Workspace.Get(), Query, StartNode, EndNode, Path))
+	{
+		UE_LOG(LogPathfinding, Verbose, TEXT("PATH FOUND"))
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_PathfindingFailedQueries);
+	}
+	return Path;
 }
 
-FVector UPathfindingSubsystem::FurthestSplinePoint(const FVector& CharacterLocation)
+void UPathfindingSubsystem::SolvePathBatch(TConstArrayView<FPathQuery> Queries, TArrayView<TArray<FVector>> OutPaths)
 {
-	float MaxDistance=-1.0f;
-	FVector FurthestPoint;
-	for(FVector Point:SplinePoints)
+	SCOPE_CYCLE_COUNTER(STAT_PathfindingSolvePathBatch);
+	CSV_SCOPED_TIMING_STAT(Pathfinding, SolvePathBatch);
+	check(Queries.Num() == OutPaths.Num());
+	INC_DWORD_STAT_BY(STAT_PathfindingQueries, Queries.Num());
+	if (!Graph)
 	{
-		const float Distance = FVector::Distance(CharacterLocation, Point);
-		if (Distance > MaxDistance)
+		UE_LOG(LogPathfinding, Error, TEXT("The navigation graph has not been built."))
+		for (TArray<FVector>& OutPath : OutPaths)
 		{
-			MaxDistance = Distance;
-			FurthestPoint = Point;
+			OutPath.Reset();
 		}
+		return;
 	}
-	return FurthestPoint;
-}
+	const FNavigationSnapshot& NavigationSnapshot = *Snapshot;
+	const int32 NumQueries = Queries.Num();
 
+	// FMath::Rand isn't safe to use from the workers so roll the seeds for Random queries here.
+	TArray<int32> RandomSeeds;
+	RandomSeeds.SetNumUninitialized(NumQueries);
+	for (int32& RandomSeed : RandomSeeds)
+	{
+		RandomSeed = FMath::Rand();
+	}
 
-TArray<FVector> UPathfindingSubsystem::ReconstructPath(const TMap<ANavigationNode*, ANavigationNode*>& CameFromMap, ANavigationNode* EndNode)
-{
-	TArray<FVector> NodeLocations;
+	// Resolve all of the start and end nodes first. These are cheap spatial index lookups so do them in one pass.
+	TArray<int32> StartNodes, EndNodes;
+	StartNodes.SetNumUninitialized(NumQueries);
+	EndNodes.SetNumUninitialized(NumQueries);
+	ParallelFor(NumQueries, [&](int32 QueryIndex)
+	{
+		ResolveQueryNodes(NavigationSnapshot, Queries[QueryIndex], FRandomStream(RandomSeeds[QueryIndex]), StartNodes[QueryIndex], EndNodes[QueryIndex]);
+	});
 
-	const ANavigationNode* NextNode = EndNode;
-	while(NextNode)
+	// Then run the searches. Each worker keeps hold of one workspace for all of the queries that it runs.
+	struct FBatchContext
 	{
-		NodeLocations.Push(NextNode->GetActorLocation());
-		NextNode = CameFromMap[NextNode];
-	}
+		TUniquePtr<FNavigationSearchWorkspace> Workspace;
+	};
+	TArray<FBatchContext> Contexts;
+	ParallelForWithTaskContext(Contexts, NumQueries, [&](FBatchContext& Context, int32 QueryIndex)
+	{
+		if (!Context.Workspace)
+		{
+			Context.Workspace = WorkspacePool.Acquire();
+		}
+		if (!FindQueryPath(NavigationSnapshot, *Context.Workspace, Queries[QueryIndex], StartNodes[QueryIndex], EndNodes[QueryIndex], OutPaths[QueryIndex]))
+		{
+			INC_DWORD_STAT(STAT_PathfindingFailedQueries);
+		}
+	});
 
-	return NodeLocations;
+	for (FBatchContext& Context : Contexts)
+	{
+		if (Context.Workspace)
+		{
+			WorkspacePool.Release(MoveTemp(Context.Workspace));
+		}
+	}
 }
 
+FVector UPathfindingSubsystem::FurthestSplinePoint(const FVector& CharacterLocation)
+{
+	const int32 FurthestPointIndex = SplinePointFurthestTree.FindFurthest(CharacterLocation);
+	if (FurthestPointIndex == INDEX_NONE)
+	{
+		// There are no spline points so stay where we are.
+		return CharacterLocation;
+	}
+	return SplinePoints[FurthestPointIndex];
+}
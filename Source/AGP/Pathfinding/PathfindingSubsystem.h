@@ -4,24 +4,46 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/WorldSubsystem.h"
+#include "ContractionHierarchy.h"
+#include "DStarLitePlanner.h"
+#include "FurthestPointTree.h"
+#include "NavigationDistanceFields.h"
+#include "NavigationGoalSet.h"
+#include "NavigationGraph.h"
+#include "NavigationHierarchy.h"
+#include "NavigationLandmarks.h"
+#include "NavigationNode.h"
+#include "NavigationSearchWorkspace.h"
+#include "NavigationSnapshot.h"
+#include "NavigationSpatialIndex.h"
+#include "NextHopTable.h"
+#include "PathCache.h"
+#include "PathQuery.h"
+#include "TimeSlicedPathSearch.h"
+#include "Containers/Queue.h"
+#include "Tasks/Task.h"
+#include <atomic>
 #include "PathfindingSubsystem.generated.h"
 
 class ABunker;
 class ANavigationNode;
+class FBakedNavigationGraph;
+class UNavigationGraphDebugComponent;
+
 /**
  * 
  */
 UCLASS()
-class AGP_API UPathfindingSubsystem : public UWorldSubsystem
+class AGP_API UPathfindingSubsystem : public UTickableWorldSubsystem
 {
 	GENERATED_BODY()
 
 public:
 
-	ANavigationNode* SpawnNode;
-	ANavigationNode* EscapeNode;
-	
 	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
 	/**
 	 * Will retrieve a path from the StartLocation, to a random position in the world's navigation system.
 	 * @param StartLocation The location that the path will start at.
@@ -32,38 +54,491 @@ public:
 	 * Will retrieve a path from the StartLocation, to the TargetLocation
 	 * @param StartLocation The location that the path will start at.
 	 * @param TargetLocation A location near where the path will end at.
+	 * @param bBidirectional Whether to search from both ends at once, which expands fewer nodes on long paths.
 	 * @return An array of vector positions representing the steps along the path, in reverse order.
 	 */
-	TArray<FVector> GetPath(const FVector& StartLocation, const FVector& TargetLocation);
+	TArray<FVector> GetPath(const FVector& StartLocation, const FVector& TargetLocation, bool bBidirectional = false);
 	/**
 	 * Will retrieve a path from the StartLocation, to a position far away from the TargetLocation
 	 * @param StartLocation The location that the path will start at.
 	 * @param TargetLocation The location that will be used to determine a position far away from.
+	 * @param Mode Whether far away is measured in a straight line or by path distance. Path distance is more
+	 * expensive as it has to search the whole graph.
+	 * @param bBidirectional Whether to search from both ends at once, which expands fewer nodes on long paths.
 	 * @return An array of vector positions representing the steps along the path, in reverse order.
 	 */
-	TArray<FVector> GetPathAway(const FVector& StartLocation, const FVector& TargetLocation);
+	TArray<FVector> GetPathAway(const FVector& StartLocation, const FVector& TargetLocation, EFurthestNodeMode Mode = EFurthestNodeMode::StraightLine,
+		bool bBidirectional = false);
 
+	/**
+	 * Will retrieve a path from the StartLocation to whichever escape point is the shortest path away.
+	 * @param StartLocation The location that the path will start at.
+	 * @return An array of vector positions representing the steps along the path, in reverse order.
+	 */
 	TArray<FVector> GetExitPath(const FVector& StartLocation);
+	/**
+	 * Will retrieve a path from the StartLocation to whichever spawn point is the shortest path away.
+	 * @param StartLocation The location that the path will start at.
+	 * @return An array of vector positions representing the steps along the path, in reverse order.
+	 */
 	TArray<FVector> GetSpawnPointPath(const FVector& StartLocation);
-	TArray<FVector> GetNearestCoverPath(const FVector& StartLocation, const FVector& TargetLocation);
+	/**
+	 * Will retrieve a path from the StartLocation to whichever cover node is the shortest path away.
+	 * @param StartLocation The location that the path will start at.
+	 * @return An array of vector positions representing the steps along the path, in reverse order.
+	 */
+	TArray<FVector> GetNearestCoverPath(const FVector& StartLocation);
 	FVector FurthestSplinePoint(const FVector& CharacterLocation);
 
+	/**
+	 * @param PointTypeMask The point types to include, made up of FNavigationGoalSet::GetPointTypeBit.
+	 * @return A goal set of every node of the given point types, for use with GetPathToAnyGoal and FindNearestGoals. It
+	 * keeps the spatial indices of the current graph alive, so it can be held on to, but make a new one once the graph
+	 * is rebuilt as its heuristic only knows the nodes of the graph that it was made for.
+	 */
+	FNavigationGoalSet MakePointTypeGoalSet(uint32 PointTypeMask) const;
+	/**
+	 * Will retrieve a path from the StartLocation to whichever goal node is cheapest to reach, with a single search.
+	 * @param StartLocation The location that the path will start at.
+	 * @param Goals The nodes that the path may end at.
+	 * @return An array of vector positions representing the steps along the path, in reverse order.
+	 */
+	TArray<FVector> GetPathToAnyGoal(const FVector& StartLocation, const FNavigationGoalSet& Goals) const;
+	/**
+	 * Will find the goal nodes that are cheapest to reach from the StartLocation with a single search. Use this to
+	 * score several candidates, such as cover nodes, instead of searching for a path to each one.
+	 * @param StartLocation The location that the paths start at.
+	 * @param Goals The nodes that can be candidates.
+	 * @param MaxGoals The maximum number of candidates to find.
+	 * @param OutGoals Will be filled with up to MaxGoals candidates, sorted from cheapest to most expensive.
+	 * @param OutPaths If not null, will be filled with the path to each candidate, in reverse order.
+	 */
+	void FindNearestGoals(const FVector& StartLocation, const FNavigationGoalSet& Goals, int32 MaxGoals, TArray<FNavigationGoalCandidate>& OutGoals, TArray<TArray<FVector>>* OutPaths = nullptr) const;
+
+	/**
+	 * Will find the path described by the Query on a worker thread instead of blocking the game thread. If the world
+	 * settings ask for time slicing then the plain A* searches run on the game thread instead, a slice each tick under
+	 * the per-frame budget that all of the requests share, and every other kind of search still runs on a worker.
+	 * @param Query The path to find.
+	 * @param OnComplete Called on the game thread, during a later tick of this subsystem, with the path. If it is not
+	 * bound then the path is kept until it is collected with TryGetPathResult, and if its object is destroyed before
+	 * the path is ready then the path is dropped. When hierarchical pathfinding is on,
+	 * node to node paths only go part of the way and the rest is given as a continuation.
+	 * @return A handle that can be used to cancel the request or poll for its result.
+	 */
+	FPathRequestHandle RequestPathAsync(const FPathQuery& Query, FOnPathComputed OnComplete = FOnPathComputed());
+	/**
+	 * Will stop the request from delivering its path. Its work is skipped if it has not started yet.
+	 * @param Handle The request to cancel. Will be invalidated.
+	 */
+	void CancelPathRequest(FPathRequestHandle& Handle);
+	/**
+	 * @return true if the request has been submitted and its path has not been delivered or collected yet.
+	 */
+	bool IsPathRequestPending(const FPathRequestHandle& Handle) const;
+	/**
+	 * If set, Tick waits for the workers to finish every outstanding path request before delivering them, so a path
+	 * always arrives on the first tick after it was requested however the threads were scheduled. Makes runs
+	 * repeatable at the cost of stalling the game thread on slow searches. Off by default.
+	 */
+	void SetDeterministicPathDelivery(bool bDeterministic)
+	{
+		bDeterministicPathDelivery = bDeterministic;
+	}
+	/**
+	 * Will collect the path of a request that was submitted without a completion delegate.
+	 * @param Handle The request to collect. Will be invalidated if the path was ready.
+	 * @param OutPath The path, in reverse order.
+	 * @param OutContinuation If not null, will be set to the rest of a hierarchical path.
+	 * @return true if the path was ready.
+	 */
+	bool TryGetPathResult(FPathRequestHandle& Handle, TArray<FVector>& OutPath, FPathContinuation* OutContinuation = nullptr);
+	/**
+	 * Will refine the next part of a hierarchical path. Call this once the previous part has been walked.
+	 * @param Continuation The rest of the path. Will be advanced past the part that is refined.
+	 * @param OutPath The next part of the path, in reverse order. Empty if the path can no longer be walked, such as
+	 * when an edge on it has been blocked or the graph has been rebuilt since, in which case find a new path.
+	 * @return true if there was more of the path.
+	 */
+	bool ContinuePath(FPathContinuation& Continuation, TArray<FVector>& OutPath) const;
+
+	/**
+	 * Will block or unblock the edge from one node to another. Like all of the changes to the graph, this is batched
+	 * with the other changes made this frame and applied at the start of the next tick of this subsystem, which makes
+	 * a new snapshot of the graph with a new version.
+	 * @param FromNode The node id that the edge starts at.
+	 * @param ToNode The node id that the edge ends at.
+	 * @param bBlocked Whether the edge can't be used.
+	 */
+	void SetEdgeBlocked(int32 FromNode, int32 ToNode, bool bBlocked);
+	/**
+	 * Will block or unblock every edge into and out of a node.
+	 * @param NodeId The node to block.
+	 * @param bBlocked Whether the node can't be walked through.
+	 */
+	void SetNodeBlocked(int32 NodeId, bool bBlocked);
+	/**
+	 * Will scale the cost of every edge into and out of a node, to make paths avoid it. An edge uses the larger of the
+	 * multipliers of its two nodes.
+	 * @param NodeId The node to change the cost of.
+	 * @param Multiplier The cost multiplier. Clamped to at least 1 so that the heuristics never overestimate.
+	 */
+	void SetNodeCostMultiplier(int32 NodeId, float Multiplier);
+	/**
+	 * Will set the cost multiplier of every node within the Radius of the Location, such as around a danger zone.
+	 * @param Location The centre of the area.
+	 * @param Radius The radius of the area.
+	 * @param Multiplier The cost multiplier. Set it back to 1 to clear the area.
+	 */
+	void SetCostMultiplierInRadius(const FVector& Location, float Radius, float Multiplier);
+	/**
+	 * @return The id of the node nearest the Location, for the node and edge changes. INDEX_NONE if there are no nodes.
+	 */
+	int32 GetNearestNodeId(const FVector& Location) const { return FindNearestNode(Location); }
+	/**
+	 * @return The id of the node furthest away from the Location. INDEX_NONE if there are no nodes.
+	 */
+	int32 GetFurthestNodeId(const FVector& Location, EFurthestNodeMode Mode = EFurthestNodeMode::StraightLine) const { return FindFurthestNode(*Snapshot, Location, Mode); }
+	/**
+	 * @return The version of the current graph snapshot. Anything derived from the graph, and any path found on it, is
+	 * out of date once this has changed.
+	 */
+	uint32 GetGraphVersion() const { return GraphVersion; }
+
+	/**
+	 * Will make an incremental planner to the nodes of the given point type, for an agent that keeps heading to the
+	 * same kind of node while the graph changes around it. The planner is kept up to date with every change to the
+	 * graph for as long as the caller holds on to it.
+	 * @param GoalType The point type of the nodes that the planner's paths end at.
+	 * @return The planner, or null if the graph has not been built.
+	 */
+	TSharedPtr<FDStarLitePlanner, ESPMode::ThreadSafe> CreatePlanner(EPointType GoalType);
+	/**
+	 * Will find the path from the StartLocation with a planner from CreatePlanner, only repairing the parts of its
+	 * last search that have been affected by the agent moving or by changes to the graph.
+	 * @param Planner The planner of the agent.
+	 * @param StartLocation The location that the path will start at.
+	 * @param OutPath The path, in reverse order. Empty if there is no path.
+	 * @return true if a path was found.
+	 */
+	bool ReplanPath(FDStarLitePlanner& Planner, const FVector& StartLocation, TArray<FVector>& OutPath) const;
+
+	/**
+	 * Will find the paths for many queries at once, spreading the searches across all of the worker threads. Use this
+	 * when many agents need to replan in the same frame. Blocks until every path has been found.
+	 * @param Queries The paths to find.
+	 * @param OutPaths One output slot per query. Each will be filled with its query's path, in reverse order, or be
+	 * empty if there is no path.
+	 */
+	void SolvePathBatch(TConstArrayView<FPathQuery> Queries, TArrayView<TArray<FVector>> OutPaths);
+
+	/**
+	 * @return The hit and miss counters of the node to node path cache.
+	 */
+	FPathCacheStats GetPathCacheStats() const { return PathCache.GetStats(); }
+
+	/**
+	 * Will find paths between random pairs of nodes with the straight line heuristic and with the landmark heuristic
+	 * and log how many nodes each expanded. Also available as the AGP.Pathfinding.CompareHeuristics console command.
+	 * @param NumSamples The number of random node pairs to search between.
+	 */
+	void LogHeuristicComparison(int32 NumSamples) const;
+	/**
+	 * Will find paths between random pairs of nodes with unidirectional and with bidirectional A* and log how many nodes
+	 * each expanded and how long each took. Also available as the AGP.Pathfinding.CompareBidirectional console command.
+	 * @param NumSamples The number of random node pairs to search between.
+	 */
+	void LogBidirectionalComparison(int32 NumSamples) const;
+
+	/**
+	 * Will replace the navigation graph with one built from the given node data instead of the node actors in the
+	 * world, along with everything derived from it. Used to run the pathfinding on generated graphs, such as in the
+	 * benchmarks. Planners made before this are left on the old graph.
+	 * @param Locations The world location of each node.
+	 * @param NodeTypes The point type of each node. Must be the same length as Locations.
+	 * @param Connections The ids of the nodes that each node is connected to. Must be the same length as Locations.
+	 */
+	void RebuildFromGraphData(TConstArrayView<FVector> Locations, TConstArrayView<EPointType> NodeTypes, TConstArrayView<TArray<int32>> Connections);
+
+	/**
+	 * Will flatten the navigation node actors in the world into a graph, build its landmarks and distance fields and
+	 * bake them all to the file that the map loads them from when its world settings ask for a baked navigation graph.
+	 * The current graph is left alone. Also available as the AGP.Pathfinding.BakeGraph console command, in the editor or
+	 * while playing.
+	 * @return true if the file was written.
+	 */
+	bool BakeNavigationGraph() const;
+
+	/**
+	 * @return The flattened navigation graph that the path queries run on. Null until the world has begun play.
+	 */
+	const FNavigationGraphPtr& GetGraph() const { return Graph; }
+	/**
+	 * @return The spatial indices over the nodes of the graph for nearest, k-nearest, radius and furthest queries. Null
+	 * until the world has begun play.
+	 */
+	const TSharedPtr<const FNavigationSpatialIndex, ESPMode::ThreadSafe>& GetSpatialIndex() const { return SpatialIndex; }
+
 protected:
 
+	/**
+	 * The flattened snapshot of the navigation nodes that all of the path and node queries run on. Built in
+	 * PopulateNodes.
+	 */
+	FNavigationGraphPtr Graph;
+	/**
+	 * The snapshot that PopulateNodes built or LoadBakedGraph loaded, without any of the runtime changes. The costs of
+	 * the Graph are always worked out from its costs.
+	 */
+	FNavigationGraphPtr BaseGraph;
+	/**
+	 * The runtime changes to the graph that have been applied to the Graph, by edge and node id.
+	 */
+	TBitArray<> BlockedEdges;
+	TBitArray<> BlockedNodes;
+	TArray<float> NodeCostMultipliers;
+	/**
+	 * The navigation node actors, indexed by their node id in the Graph.
+	 */
 	TArray<ANavigationNode*> Nodes;
-	TArray<ANavigationNode*> CoverNodes;
+	/**
+	 * Spatial indices over every node in the Graph and over the nodes of each EPointType, and the tree for finding the
+	 * node furthest away from a location. Shared by every snapshot with the same layout version.
+	 */
+	TSharedPtr<const FNavigationSpatialIndex, ESPMode::ThreadSafe> SpatialIndex;
+	/**
+	 * A bounding volume tree for finding the spline point furthest away from a location.
+	 */
+	FFurthestPointTree SplinePointFurthestTree;
+	/**
+	 * The path distance from every node to the nearest node of each EPointType, and the next node on the way. Used
+	 * for the exit, spawn point and cover paths. Only used while its graph version matches the graph being searched.
+	 */
+	TSharedPtr<const FNavigationDistanceFields, ESPMode::ThreadSafe> DistanceFields;
+	/**
+	 * The rebuild of the DistanceFields for a changed graph, on a worker thread. Invalid if there isn't one running.
+	 */
+	UE::Tasks::TTask<TSharedPtr<const FNavigationDistanceFields, ESPMode::ThreadSafe>> DistanceFieldsTask;
+	/**
+	 * Whether the graph has changed since the DistanceFieldsTask was launched, so the fields need rebuilding again.
+	 */
+	bool bDistanceFieldsStale = false;
+	/**
+	 * The reusable scratch memory for the searches, one workspace for each search that is running at the same time.
+	 */
+	mutable FNavigationSearchWorkspacePool WorkspacePool;
+	/**
+	 * Recently found node to node paths, including failed searches. Invalidated whenever the GraphVersion changes.
+	 */
+	mutable FPathCache PathCache;
+	/**
+	 * The precomputed paths between every pair of nodes. Only built when the world settings ask for it and the graph
+	 * is small enough. Only used while its graph version matches the graph being searched.
+	 */
+	TSharedPtr<const FNextHopTable, ESPMode::ThreadSafe> NextHopTable;
+	/**
+	 * The landmarks for the A* heuristic. Only used while their graph version matches the graph being searched.
+	 */
+	TSharedPtr<const FNavigationLandmarks, ESPMode::ThreadSafe> Landmarks;
+	/**
+	 * The contraction hierarchy that answers node to node paths when the world settings ask for it. Only used while
+	 * its graph version matches the graph being searched.
+	 */
+	TSharedPtr<const FContractionHierarchy, ESPMode::ThreadSafe> ContractionHierarchy;
+	/**
+	 * The clustered abstract graph that node to node path requests are answered on when the world settings ask for it.
+	 * Only used while its graph version matches the graph being searched.
+	 */
+	TSharedPtr<const FNavigationHierarchy, ESPMode::ThreadSafe> NavigationHierarchy;
+	/**
+	 * The Graph and everything above that the path queries read, bundled together by PublishSnapshot whenever any of
+	 * them changes. The queries on the workers only ever read the snapshot they were given, never the members above,
+	 * which the game thread is free to replace. Never null.
+	 */
+	FNavigationSnapshotPtr Snapshot = MakeShared<FNavigationSnapshot, ESPMode::ThreadSafe>();
+	/**
+	 * Bumped whenever the Graph is rebuilt or the costs of its edges change.
+	 */
+	uint32 GraphVersion = 0;
 	TArray<FVector> SplinePoints;
 	ABunker* BunkerActor;
 
 private:
+
+	/**
+	 * The state of a path request that is shared between the game thread and the worker that finds the path.
+	 */
+	struct FPendingPathRequest
+	{
+		FPathQuery Query;
+		// Used to pick the destination of Random queries on the worker.
+		int32 RandomSeed = 0;
+		FOnPathComputed OnComplete;
+		// Whether the request was made with a callback. If the callback has come unbound by the time the path is ready,
+		// whoever made the request is gone and the path is dropped rather than kept for TryGetPathResult.
+		bool bHasCallback = false;
+		TArray<FVector> Path;
+		FPathContinuation Continuation;
+		// The search that is still being advanced by AdvanceTimeSlicedSearches, if the request is time sliced.
+		TUniquePtr<FTimeSlicedPathSearch> Search;
+		std::atomic<bool> bCancelled{false};
+		// Set on the game thread once the worker has reported that the path is ready.
+		bool bCompleted = false;
+	};
+
+	// The graph changes made since the last tick. Later changes to the same edge or node replace earlier ones.
+	TMap<FIntPoint, bool> PendingEdgeBlocks;
+	TMap<int32, bool> PendingNodeBlocks;
+	TMap<int32, float> PendingNodeCostMultipliers;
+
+	// The planners handed out by CreatePlanner. Ones that are no longer held by anyone are dropped in CreatePlanner and
+	// NotifyPlanners.
+	TArray<TWeakPtr<FDStarLitePlanner, ESPMode::ThreadSafe>> Planners;
+
+	// Draws the Graph while the AGP.Pathfinding.DrawGraph console variable is set. Made the first time it is needed.
+	UPROPERTY(Transient)
+	TObjectPtr<UNavigationGraphDebugComponent> GraphDebugComponent;
+
+	uint32 NextPathRequestId = 1;
+	// The requests that have not been delivered or collected yet. Only touched on the game thread.
+	TMap<uint32, TSharedRef<FPendingPathRequest, ESPMode::ThreadSafe>> PendingPathRequests;
+	// The ids of requests that the workers have finished, waiting to be delivered in Tick.
+	TQueue<uint32, EQueueMode::Mpsc> CompletedPathRequestIds;
+	// The worker tasks that may still be running. Waited on in Deinitialize.
+	TArray<UE::Tasks::FTask> PathRequestTasks;
+	// The ids of the time sliced requests whose searches haven't finished, in the order they take turns.
+	TArray<uint32> TimeSlicedRequestIds;
+	// The index in TimeSlicedRequestIds of the search that gets the first turn next frame.
+	int32 NextTimeSlicedRequest = 0;
+	bool bTimeSlicePathRequests = false;
+	double PathSearchBudgetSeconds = 0.0;
+	bool bDeterministicPathDelivery = false;
+	// The largest open set of any search since the last tick, for the open set peak stat. Searches run on the workers
+	// too, so it is atomic.
+	mutable std::atomic<int32> FrameOpenSetPeak{0};
 	
 	void PopulateNodes();
+	/**
+	 * Will find the navigation node actors in the world and flatten them into node data, giving each actor its node id.
+	 */
+	void GatherNodeData(TArray<ANavigationNode*>& OutNodes, TArray<FVector>& OutLocations, TArray<EPointType>& OutNodeTypes,
+		TArray<TArray<int32>>& OutConnections) const;
+	/**
+	 * Will load the Graph, and its landmarks and distance fields if it has any, from the file baked for this map.
+	 * @return false if there is no usable baked file, in which case nothing was changed.
+	 */
+	bool LoadBakedGraph();
+	/**
+	 * Will build the Graph from the node data, with its spatial indices and distance fields.
+	 */
+	void BuildGraph(TConstArrayView<FVector> Locations, TConstArrayView<EPointType> NodeTypes, TConstArrayView<TArray<int32>> Connections);
+	/**
+	 * Will make a new snapshot the Graph, and build its spatial indices and distance fields.
+	 * @param NewGraph The graph to use.
+	 * @param BakedGraph The baked graph that the NewGraph was loaded from, if any. Its distance fields are used rather
+	 * than built when it has them.
+	 */
+	void SetGraph(const TSharedRef<FNavigationGraph, ESPMode::ThreadSafe>& NewGraph,
+		const TSharedPtr<const FBakedNavigationGraph, ESPMode::ThreadSafe>& BakedGraph = nullptr);
+	void BuildNextHopTable();
+	void BuildLandmarks();
+	void BuildContractionHierarchy();
+	void BuildNavigationHierarchy();
+	/**
+	 * Will bundle the current Graph, spatial indices and precomputed structures into a new Snapshot. Must be called
+	 * whenever any of them is replaced.
+	 */
+	void PublishSnapshot();
+	/**
+	 * Will find the path of a request on a worker thread.
+	 */
+	void LaunchPathRequestTask(uint32 Id, const TSharedRef<FPendingPathRequest, ESPMode::ThreadSafe>& Request);
+	/**
+	 * Will start the A* search of a time sliced request. Requests that can be answered by walking a precomputed table
+	 * are answered straight away, and the ones that need any other kind of search are handed to the workers, so that
+	 * the game thread never spends more than the budget on them.
+	 */
+	void StartTimeSlicedRequest(uint32 Id, const TSharedRef<FPendingPathRequest, ESPMode::ThreadSafe>& RequestRef);
+	/**
+	 * Will advance the time sliced searches in turn until they have used up the budget for this frame.
+	 */
+	void AdvanceTimeSlicedSearches();
+	/**
+	 * Will apply the pending graph changes to a new snapshot of the Graph, and update everything derived from it.
+	 */
+	void ApplyGraphChanges();
+	/**
+	 * Will swap in the distance fields of a finished DistanceFieldsTask, and launch a new one if the graph has changed
+	 * since the last one was launched. The paths to the nearest point types fall back to a search until then.
+	 */
+	void UpdateDistanceFields();
+	/**
+	 * @return The cost of an edge of the BaseGraph with the runtime changes applied.
+	 */
+	float GetModifiedEdgeCost(int32 EdgeId, int32 FromNode) const;
+	/**
+	 * Will move every planner that is still held onto the new graph snapshot. Must be called whenever the costs of
+	 * the Graph change.
+	 * @param ChangedEdges The ids of the edges whose costs are different in the NewGraph.
+	 */
+	void NotifyPlanners(const FNavigationGraphPtr& NewGraph, TConstArrayView<int32> ChangedEdges);
+	/**
+	 * Will add a search that actually ran to the pathfinding stats. Safe to call from any thread.
+	 */
+	void RecordSearchStats(int32 NumExpanded, int32 PeakOpenSetSize) const;
+#if ENABLE_DRAW_DEBUG
+	/**
+	 * Will draw the Graph again if it has changed since it was last drawn, or clear it, to match the
+	 * AGP.Pathfinding.DrawGraph console variable.
+	 */
+	void UpdateGraphDebugDrawing();
+#endif
 	void GetSplinePoint();
-	ANavigationNode* GetRandomNode();
-	ANavigationNode* FindNearestNode(const FVector& TargetLocation);
-	ANavigationNode* FindNearestNode(TArray<ANavigationNode*>Nodes,const FVector& TargetLocation);
-	ANavigationNode* FindFurthestNode(const FVector& TargetLocation);
-	TArray<FVector> GetPath(ANavigationNode* StartNode, ANavigationNode* EndNode);
-	static TArray<FVector> ReconstructPath(const TMap<ANavigationNode*, ANavigationNode*>& CameFromMap, ANavigationNode* EndNode);
+	int32 GetRandomNode() const;
+	int32 FindNearestNode(const FVector& TargetLocation) const;
+	/**
+	 * The node lookups on a given snapshot. Safe to call from any thread.
+	 */
+	int32 FindNearestNode(const FNavigationSnapshot& NavigationSnapshot, const FVector& TargetLocation) const;
+	int32 FindNearestNode(const FNavigationSnapshot& NavigationSnapshot, EPointType PointType, const FVector& TargetLocation) const;
+	int32 FindFurthestNode(const FNavigationSnapshot& NavigationSnapshot, const FVector& TargetLocation, EFurthestNodeMode Mode = EFurthestNodeMode::StraightLine) const;
+	TArray<FVector> GetPath(int32 StartNode, int32 EndNode, bool bBidirectional = false) const;
+	TArray<FVector> GetPathToNearest(EPointType PointType, const FVector& StartLocation) const;
+	/**
+	 * Will walk the NextHopTable, or query the ContractionHierarchy, if there is one for this graph. Otherwise will look
+	 * the path up in the PathCache and only search for it, with the given workspace, if it isn't there.
+	 * @param bBidirectional Whether the search, if there is one, runs from both ends at once.
+	 * @return true if there is a path.
+	 */
+	bool FindPathCached(const FNavigationSnapshot& NavigationSnapshot, FNavigationSearchWorkspace& Workspace, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath,
+		bool bBidirectional = false) const;
+	/**
+	 * Will walk the DistanceFields from the StartNode to the nearest node of the point type. Falls back to a multi-goal
+	 * search over the nodes of the type if the fields were built for a different graph.
+	 * @return true if there is a path.
+	 */
+	bool FindPathToNearest(const FNavigationSnapshot& NavigationSnapshot, FNavigationSearchWorkspace& Workspace, EPointType PointType, int32 StartNode, TArray<FVector>& OutPath) const;
+	/**
+	 * Will find the start and end nodes of a query on the given snapshot. The end node is left as INDEX_NONE
+	 * for the kinds that go to the nearest node of a point type, as that is found by FindQueryPath. Safe to call from
+	 * any thread.
+	 */
+	void ResolveQueryNodes(const FNavigationSnapshot& NavigationSnapshot, const FPathQuery& Query, const FRandomStream& RandomStream, int32& OutStartNode, int32& OutEndNode) const;
+	/**
+	 * Will find the path for a query whose nodes have already been resolved. Safe to call from any thread.
+	 * @return true if there is a path.
+	 */
+	bool FindQueryPath(const FNavigationSnapshot& NavigationSnapshot, FNavigationSearchWorkspace& Workspace, const FPathQuery& Query, int32 StartNode, int32 EndNode, TArray<FVector>& OutPath) const;
+	/**
+	 * Will refine the next steps of a hierarchical route into a short path of real nodes. Safe to call from any thread.
+	 * @return false if a step could no longer be walked.
+	 */
+	bool RefineRoute(FNavigationSearchWorkspace& Workspace, FPathContinuation& Continuation, TArray<FVector>& OutPath) const;
+	/**
+	 * Will find the path for a query on the given snapshot. Node to node queries are answered hierarchically if there is
+	 * a hierarchy for the graph of the snapshot, in which case only the first part of the path is returned and the rest
+	 * goes in the OutContinuation. Safe to call from any thread.
+	 */
+	TArray<FVector> SolveQuery(const FNavigationSnapshot& NavigationSnapshot, const FPathQuery& Query, const FRandomStream& RandomStream, FPathContinuation& OutContinuation) const;
 	
 };
@@ -0,0 +1,233 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SyntheticNavigationGraph.h"
+
+#include "NavigationNode.h"
+
+FSyntheticNavigationGraph FSyntheticNavigationGraph::Generate(ESyntheticGraphShape Shape, int32 NumNodes, int32 Seed, float Spacing)
+{
+	FSyntheticNavigationGraph Graph;
+	NumNodes = FMath::Max(NumNodes, 1);
+	Graph.Locations.Reserve(NumNodes);
+	Graph.Connections.SetNum(NumNodes);
+
+	FRandomStream RandomStream(Seed);
+	switch (Shape)
+	{
+	case ESyntheticGraphShape::Grid:
+		Graph.GenerateGrid(NumNodes, Spacing);
+		break;
+	case ESyntheticGraphShape::RandomGeometric:
+		Graph.GenerateRandomGeometric(NumNodes, RandomStream, Spacing);
+		break;
+	case ESyntheticGraphShape::Maze:
+		Graph.GenerateMaze(NumNodes, RandomStream, Spacing);
+		break;
+	}
+	Graph.AssignPointTypes(RandomStream);
+	return Graph;
+}
+
+const TCHAR* FSyntheticNavigationGraph::GetShapeName(ESyntheticGraphShape Shape)
+{
+	switch (Shape)
+	{
+	case ESyntheticGraphShape::Grid:
+		return TEXT("Grid");
+	case ESyntheticGraphShape::RandomGeometric:
+		return TEXT("RandomGeometric");
+	case ESyntheticGraphShape::Maze:
+		return TEXT("Maze");
+	}
+	return TEXT("Unknown");
+}
+
+bool FSyntheticNavigationGraph::ParseShape(const FString& Name, ESyntheticGraphShape& OutShape)
+{
+	for (const ESyntheticGraphShape Shape : {ESyntheticGraphShape::Grid, ESyntheticGraphShape::RandomGeometric, ESyntheticGraphShape::Maze})
+	{
+		if (Name.Equals(GetShapeName(Shape), ESearchCase::IgnoreCase))
+		{
+			OutShape = Shape;
+			return true;
+		}
+	}
+	return false;
+}
+
+int32 FSyntheticNavigationGraph::GetNumEdges() const
+{
+	int32 NumEdges = 0;
+	for (const TArray<int32>& NodeConnections : Connections)
+	{
+		NumEdges += NodeConnections.Num();
+	}
+	return NumEdges;
+}
+
+void FSyntheticNavigationGraph::GenerateGrid(int32 NumNodes, float Spacing)
+{
+	// The last row is only partly filled when the node count isn't a square number.
+	const int32 Side = FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(NumNodes)));
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		Locations.Add(FVector((NodeId % Side) * Spacing, (NodeId / Side) * Spacing, 0.0));
+		if (NodeId % Side + 1 < Side && NodeId + 1 < NumNodes)
+		{
+			Connect(NodeId, NodeId + 1);
+		}
+		if (NodeId + Side < NumNodes)
+		{
+			Connect(NodeId, NodeId + Side);
+		}
+	}
+}
+
+void FSyntheticNavigationGraph::GenerateRandomGeometric(int32 NumNodes, FRandomStream& RandomStream, float Spacing)
+{
+	// Spread the nodes over the area that a grid of the same spacing would cover, and connect each one to the nodes
+	// within one and a half spacings, which gives about seven connections per node.
+	const float Extent = Spacing * FMath::Sqrt(static_cast<float>(NumNodes));
+	const float Radius = Spacing * 1.5f;
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		Locations.Add(FVector(RandomStream.FRand() * Extent, RandomStream.FRand() * Extent, 0.0));
+	}
+
+	// Bucket the nodes into cells the size of the radius so each node only has to check the cells around it.
+	const int32 NumCellsPerAxis = FMath::Max(FMath::CeilToInt32(Extent / Radius), 1);
+	const auto GetCellCoord = [Radius, NumCellsPerAxis](double Coord)
+	{
+		return FMath::Clamp(FMath::FloorToInt32(Coord / Radius), 0, NumCellsPerAxis - 1);
+	};
+	TArray<int32> CellOffsets;
+	CellOffsets.Init(0, NumCellsPerAxis * NumCellsPerAxis + 1);
+	TArray<int32> NodeCells;
+	NodeCells.SetNumUninitialized(NumNodes);
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		NodeCells[NodeId] = GetCellCoord(Locations[NodeId].Y) * NumCellsPerAxis + GetCellCoord(Locations[NodeId].X);
+		++CellOffsets[NodeCells[NodeId] + 1];
+	}
+	for (int32 Cell = 0; Cell < NumCellsPerAxis * NumCellsPerAxis; ++Cell)
+	{
+		CellOffsets[Cell + 1] += CellOffsets[Cell];
+	}
+	TArray<int32> CellNodes;
+	CellNodes.SetNumUninitialized(NumNodes);
+	TArray<int32> CellFill(CellOffsets);
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		CellNodes[CellFill[NodeCells[NodeId]]++] = NodeId;
+	}
+
+	const double RadiusSquared = FMath::Square(Radius);
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		const int32 CellX = NodeCells[NodeId] % NumCellsPerAxis;
+		const int32 CellY = NodeCells[NodeId] / NumCellsPerAxis;
+		for (int32 Y = FMath::Max(CellY - 1, 0); Y <= FMath::Min(CellY + 1, NumCellsPerAxis - 1); ++Y)
+		{
+			for (int32 X = FMath::Max(CellX - 1, 0); X <= FMath::Min(CellX + 1, NumCellsPerAxis - 1); ++X)
+			{
+				const int32 Cell = Y * NumCellsPerAxis + X;
+				for (int32 Index = CellOffsets[Cell]; Index < CellOffsets[Cell + 1]; ++Index)
+				{
+					// Each pair is only connected once, from its lower id.
+					const int32 OtherNode = CellNodes[Index];
+					if (OtherNode > NodeId && FVector::DistSquared(Locations[NodeId], Locations[OtherNode]) <= RadiusSquared)
+					{
+						Connect(NodeId, OtherNode);
+					}
+				}
+			}
+		}
+	}
+}
+
+void FSyntheticNavigationGraph::GenerateMaze(int32 NumNodes, FRandomStream& RandomStream, float Spacing)
+{
+	const int32 Side = FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(NumNodes)));
+	for (int32 NodeId = 0; NodeId < NumNodes; ++NodeId)
+	{
+		Locations.Add(FVector((NodeId % Side) * Spacing, (NodeId / Side) * Spacing, 0.0));
+	}
+
+	const auto GetNeighbours = [Side, NumNodes](int32 NodeId, TArray<int32, TInlineAllocator<4>>& OutNeighbours)
+	{
+		OutNeighbours.Reset();
+		const int32 X = NodeId % Side;
+		if (X > 0) OutNeighbours.Add(NodeId - 1);
+		if (X + 1 < Side && NodeId + 1 < NumNodes) OutNeighbours.Add(NodeId + 1);
+		if (NodeId >= Side) OutNeighbours.Add(NodeId - Side);
+		if (NodeId + Side < NumNodes) OutNeighbours.Add(NodeId + Side);
+	};
+
+	// Carve the maze with a randomised depth first search, which connects every cell with exactly one path.
+	TBitArray<> Visited(false, NumNodes);
+	TArray<int32> Stack;
+	TArray<int32, TInlineAllocator<4>> Neighbours;
+	Stack.Add(0);
+	Visited[0] = true;
+	while (!Stack.IsEmpty())
+	{
+		const int32 NodeId = Stack.Last();
+		GetNeighbours(NodeId, Neighbours);
+		Neighbours.RemoveAllSwap([&Visited](int32 Neighbour) { return Visited[Neighbour]; });
+		if (Neighbours.IsEmpty())
+		{
+			Stack.Pop(false);
+			continue;
+		}
+		const int32 Next = Neighbours[RandomStream.RandHelper(Neighbours.Num())];
+		Visited[Next] = true;
+		Connect(NodeId, Next);
+		Stack.Add(Next);
+	}
+
+	// Knock through a few extra walls so that there is more than one way between most places.
+	const int32 NumLoops = NumNodes / 20;
+	for (int32 Loop = 0; Loop < NumLoops; ++Loop)
+	{
+		const int32 NodeId = RandomStream.RandHelper(NumNodes);
+		GetNeighbours(NodeId, Neighbours);
+		if (Neighbours.IsEmpty())
+		{
+			continue;
+		}
+		const int32 Neighbour = Neighbours[RandomStream.RandHelper(Neighbours.Num())];
+		if (!Connections[NodeId].Contains(Neighbour))
+		{
+			Connect(NodeId, Neighbour);
+		}
+	}
+}
+
+void FSyntheticNavigationGraph::AssignPointTypes(FRandomStream& RandomStream)
+{
+	NodeTypes.Init(EPointType::Normal, Locations.Num());
+	for (EPointType& NodeType : NodeTypes)
+	{
+		const float Roll = RandomStream.FRand();
+		NodeType = Roll < 0.03f ? EPointType::Cover
+			: Roll < 0.035f ? EPointType::SpawnPoint
+			: Roll < 0.04f ? EPointType::EscapePoint
+			: EPointType::Normal;
+	}
+
+	// Small graphs may not have rolled every type, and the queries to the nearest point of a type need one.
+	for (const EPointType PointType : {EPointType::Cover, EPointType::SpawnPoint, EPointType::EscapePoint})
+	{
+		if (!NodeTypes.Contains(PointType))
+		{
+			NodeTypes[RandomStream.RandHelper(NodeTypes.Num())] = PointType;
+		}
+	}
+}
+
+void FSyntheticNavigationGraph::Connect(int32 NodeA, int32 NodeB)
+{
+	Connections[NodeA].Add(NodeB);
+	Connections[NodeB].Add(NodeA);
+}
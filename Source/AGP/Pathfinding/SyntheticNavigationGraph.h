@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EPointType : uint8;
+
+/**
+ * The layouts of generated navigation graphs.
+ */
+enum class ESyntheticGraphShape : uint8
+{
+	// A square grid with every node connected to its four neighbours. Open ground with many equally short paths.
+	Grid,
+	// Nodes scattered at random and connected to every node within a fixed radius. Uneven density, like a hand placed
+	// graph.
+	RandomGeometric,
+	// A square grid with the connections of a random maze and a few extra loops. Long winding paths that the straight
+	// line heuristic guesses badly.
+	Maze
+};
+
+/**
+ * The node data of a generated navigation graph, in the form that UPathfindingSubsystem::RebuildFromGraphData takes.
+ * The same shape, node count and seed always generate the same graph, so runs on it can be compared.
+ */
+struct AGP_API FSyntheticNavigationGraph
+{
+	TArray<FVector> Locations;
+	TArray<EPointType> NodeTypes;
+	TArray<TArray<int32>> Connections;
+
+	/**
+	 * Will generate a graph. A few percent of the nodes are made cover points and a few spawn and escape points, with
+	 * at least one of each.
+	 * @param Shape The layout of the graph.
+	 * @param NumNodes The number of nodes to generate.
+	 * @param Seed The seed of the random layout and point types.
+	 * @param Spacing The distance between neighbouring nodes, or the average distance for the RandomGeometric shape.
+	 */
+	static FSyntheticNavigationGraph Generate(ESyntheticGraphShape Shape, int32 NumNodes, int32 Seed, float Spacing = 200.0f);
+
+	static const TCHAR* GetShapeName(ESyntheticGraphShape Shape);
+	/**
+	 * @return true if the Name matched one of the shape names, case insensitively.
+	 */
+	static bool ParseShape(const FString& Name, ESyntheticGraphShape& OutShape);
+
+	int32 GetNumEdges() const;
+
+private:
+
+	void GenerateGrid(int32 NumNodes, float Spacing);
+	void GenerateRandomGeometric(int32 NumNodes, FRandomStream& RandomStream, float Spacing);
+	void GenerateMaze(int32 NumNodes, FRandomStream& RandomStream, float Spacing);
+	void AssignPointTypes(FRandomStream& RandomStream);
+	void Connect(int32 NodeA, int32 NodeB);
+};
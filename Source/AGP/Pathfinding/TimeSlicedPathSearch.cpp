@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TimeSlicedPathSearch.h"
+
+#include "NavigationLandmarks.h"
+#include "NavigationSearch.h"
+#include "NavigationSearchWorkspace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+FTimeSlicedPathSearch::FTimeSlicedPathSearch(const FNavigationGraphPtr& InGraph, TUniquePtr<FNavigationSearchWorkspace>&& InWorkspace,
+	const TSharedPtr<const FNavigationLandmarks, ESPMode::ThreadSafe>& InLandmarks, int32 InStartNode, int32 InEndNode)
+	: Graph(InGraph), Workspace(MoveTemp(InWorkspace)), Landmarks(InLandmarks), StartNode(InStartNode), EndNode(InEndNode)
+{
+	if (!Graph || !Graph->IsValidNode(StartNode) || !Graph->IsValidNode(EndNode))
+	{
+		Status = ETimeSlicedSearchStatus::Failed;
+		return;
+	}
+
+	Workspace->BeginSearch(Graph->GetNumNodes());
+	Workspace->Visit(StartNode, GetHeuristic(StartNode));
+	Workspace->SetGScore(StartNode, 0.0f);
+	Workspace->GetOpenSet().Push(StartNode, Workspace->GetHScore(StartNode));
+}
+
+ETimeSlicedSearchStatus FTimeSlicedPathSearch::Advance(double EndTime)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE(FTimeSlicedPathSearch::Advance);
+	if (Status != ETimeSlicedSearchStatus::InProgress)
+	{
+		return Status;
+	}
+
+	// Reading the clock costs about as much as expanding a node, so only read it every few expansions.
+	constexpr int32 ExpansionsPerTimeCheck = 16;
+	const FNavigationGraph& SearchGraph = *Graph;
+	FNavigationOpenSet& OpenSet = Workspace->GetOpenSet();
+	int32 ExpansionsUntilTimeCheck = ExpansionsPerTimeCheck;
+	while (!OpenSet.IsEmpty())
+	{
+		if (--ExpansionsUntilTimeCheck == 0)
+		{
+			if (FPlatformTime::Seconds() >= EndTime)
+			{
+				return Status;
+			}
+			ExpansionsUntilTimeCheck = ExpansionsPerTimeCheck;
+		}
+
+		const int32 CurrentNode = Workspace->ExpandNext();
+		if (CurrentNode == EndNode)
+		{
+			Status = ETimeSlicedSearchStatus::Succeeded;
+			return Status;
+		}
+
+		const float CurrentGScore = Workspace->GetGScore(CurrentNode);
+		for (int32 EdgeId = SearchGraph.GetEdgeBegin(CurrentNode); EdgeId < SearchGraph.GetEdgeEnd(CurrentNode); ++EdgeId)
+		{
+			if (SearchGraph.IsEdgeBlocked(EdgeId)) continue;
+			const int32 ConnectedNode = SearchGraph.GetEdgeTarget(EdgeId);
+			const float TentativeGScore = CurrentGScore + SearchGraph.GetEdgeCost(EdgeId);
+			if (!Workspace->IsVisited(ConnectedNode))
+			{
+				Workspace->Visit(ConnectedNode, GetHeuristic(ConnectedNode));
+			}
+			if (TentativeGScore < Workspace->GetGScore(ConnectedNode))
+			{
+				Workspace->SetCameFrom(ConnectedNode, CurrentNode);
+				Workspace->SetGScore(ConnectedNode, TentativeGScore);
+				OpenSet.Push(ConnectedNode, TentativeGScore + Workspace->GetHScore(ConnectedNode));
+			}
+		}
+	}
+
+	Status = ETimeSlicedSearchStatus::Failed;
+	return Status;
+}
+
+void FTimeSlicedPathSearch::GetPath(TArray<FVector>& OutPath) const
+{
+	OutPath.Reset();
+	if (Status == ETimeSlicedSearchStatus::Succeeded && Workspace)
+	{
+		FNavigationSearch::ReconstructPath(*Graph, *Workspace, EndNode, OutPath);
+	}
+}
+
+TUniquePtr<FNavigationSearchWorkspace> FTimeSlicedPathSearch::ReleaseWorkspace()
+{
+	return MoveTemp(Workspace);
+}
+
+float FTimeSlicedPathSearch::GetHeuristic(int32 NodeId) const
+{
+	const float StraightLineDistance = Graph->Distance(NodeId, EndNode);
+	return Landmarks ? FMath::Max(StraightLineDistance, Landmarks->GetHeuristic(NodeId, EndNode)) : StraightLineDistance;
+}
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "NavigationGraph.h"
+#include "NavigationSearchWorkspace.h"
+
+class FNavigationLandmarks;
+
+/**
+ * The state of a time sliced search.
+ */
+enum class ETimeSlicedSearchStatus : uint8
+{
+	InProgress,
+	Succeeded,
+	Failed
+};
+
+/**
+ * An A* search between two nodes that can be stopped after any number of expansions and carried on later, so a long
+ * search can be spread across several frames. It holds on to its graph snapshot and its workspace until it finishes,
+ * so changes to the graph in the meantime don't affect it.
+ */
+class AGP_API FTimeSlicedPathSearch
+{
+public:
+
+	/**
+	 * @param InGraph The graph snapshot to search.
+	 * @param InWorkspace The scratch memory for the search. Kept until the search is done with it, see ReleaseWorkspace.
+	 * @param InLandmarks Optional landmarks that were built from the same graph layout.
+	 * @param InStartNode The node id that the path will start at.
+	 * @param InEndNode The node id that the path will end at.
+	 */
+	FTimeSlicedPathSearch(const FNavigationGraphPtr& InGraph, TUniquePtr<FNavigationSearchWorkspace>&& InWorkspace,
+		const TSharedPtr<const FNavigationLandmarks, ESPMode::ThreadSafe>& InLandmarks, int32 InStartNode, int32 InEndNode);
+
+	/**
+	 * Will expand nodes until the search finishes or the platform time passes the EndTime. The time is only checked
+	 * every few expansions, so a slice can run over by the cost of those expansions.
+	 * @param EndTime The FPlatformTime::Seconds at which to stop.
+	 * @return The status of the search after this slice.
+	 */
+	ETimeSlicedSearchStatus Advance(double EndTime);
+
+	ETimeSlicedSearchStatus GetStatus() const
+	{
+		return Status;
+	}
+
+	int32 GetStartNode() const
+	{
+		return StartNode;
+	}
+
+	int32 GetEndNode() const
+	{
+		return EndNode;
+	}
+
+	const FNavigationGraphPtr& GetGraph() const
+	{
+		return Graph;
+	}
+
+	/**
+	 * @param OutPath Will be filled with the node locations along the path, in reverse order. Empty unless the search
+	 * has succeeded.
+	 */
+	void GetPath(TArray<FVector>& OutPath) const;
+
+	/**
+	 * @return The workspace, so it can go back to its pool. The search can't be advanced or give its path any more.
+	 */
+	TUniquePtr<FNavigationSearchWorkspace> ReleaseWorkspace();
+
+private:
+
+	float GetHeuristic(int32 NodeId) const;
+
+	FNavigationGraphPtr Graph;
+	TUniquePtr<FNavigationSearchWorkspace> Workspace;
+	TSharedPtr<const FNavigationLandmarks, ESPMode::ThreadSafe> Landmarks;
+	int32 StartNode = INDEX_NONE;
+	int32 EndNode = INDEX_NONE;
+	ETimeSlicedSearchStatus Status = ETimeSlicedSearchStatus::InProgress;
+};
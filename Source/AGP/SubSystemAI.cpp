@@ -3,13 +3,190 @@
 
 #include "SubSystemAI.h"
 
-void USubSystemAI::OnWorldBeginPlay(UWorld& InWorld)
+#include "Async/ParallelFor.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+CSV_DECLARE_CATEGORY_EXTERN(EnemyAI);
+
+namespace
+{
+	// The decisions are cheap, so each worker takes a good number of agents at a time.
+	constexpr int32 DecisionBatchSize = 256;
+}
+
+void USubSystemAI::Tick(float DeltaTime)
+{
+	CSV_SCOPED_TIMING_STAT(EnemyAI, AgentUpdate);
+	Super::Tick(DeltaTime);
+
+	const int32 NumAgents = Agents.Num();
+	bUpdatingAgents = true;
+
+	// Run the behaviour of every enemy's state. This touches the actors so it stays on the game thread. The enemies
+	// write what the decisions are made from straight into the arrays as it changes.
+	{
+		CSV_SCOPED_TIMING_STAT(EnemyAI, AgentBehaviour);
+		for (int32 AgentIndex = 0; AgentIndex < NumAgents; ++AgentIndex)
+		{
+			AEnemyCharacter* Agent = Agents[AgentIndex];
+			if (!Agent) continue;
+
+			// Stands in for the Tick of the base character, as the enemy doesn't tick while it is registered.
+			Agent->UpdateTimeSinceLastShot(DeltaTime);
+			Agent->TickAgent(States[AgentIndex], DeltaTime);
+		}
+	}
+
+	// Make every decision from the arrays alone, so the agents can be spread over the workers. Nothing else writes the
+	// arrays until the game thread gets them back.
+	{
+		CSV_SCOPED_TIMING_STAT(EnemyAI, AgentDecisions);
+		Decisions.SetNumUninitialized(NumAgents);
+		ParallelFor(TEXT("SubSystemAI.Decide"), NumAgents, DecisionBatchSize, [this](int32 AgentIndex)
+		{
+			Decisions[AgentIndex] = Decide(States[AgentIndex], HealthFractions[AgentIndex], SensedTargets[AgentIndex] != nullptr,
+				PathCursors[AgentIndex] > 0, LastPathRequestsFailed[AgentIndex]);
+			States[AgentIndex] = Decisions[AgentIndex].NextState;
+		});
+	}
+
+	// Only the enemies whose decisions change anything need to be touched again.
+	for (int32 AgentIndex = 0; AgentIndex < NumAgents; ++AgentIndex)
+	{
+		if (Agents[AgentIndex] && Decisions[AgentIndex].HasChanges())
+		{
+			Agents[AgentIndex]->ApplyDecision(Decisions[AgentIndex]);
+		}
+	}
+
+	bUpdatingAgents = false;
+	if (bHasUnregisteredAgents)
+	{
+		bHasUnregisteredAgents = false;
+		for (int32 AgentIndex = Agents.Num() - 1; AgentIndex >= 0; --AgentIndex)
+		{
+			if (!Agents[AgentIndex])
+			{
+				RemoveAgentAt(AgentIndex);
+			}
+		}
+	}
+	CSV_CUSTOM_STAT(EnemyAI, Agents, Agents.Num(), ECsvCustomStatOp::Set);
+}
+
+TStatId USubSystemAI::GetStatId() const
 {
-	
+	RETURN_QUICK_DECLARE_CYCLE_STAT(USubSystemAI, STATGROUP_Tickables);
 }
 
-void USubSystemAI:: SneakAway()
+void USubSystemAI::RegisterAgent(AEnemyCharacter* Agent)
 {
-	
+	if (!Agent || Agent->AgentIndex != INDEX_NONE) return;
+
+	// Read the state before setting the agent index, as the enemy reads it from the arrays after.
+	States.Add(Agent->GetCurrentState());
+	PathCursors.Add(Agent->GetPathCursor());
+	HealthFractions.Add(Agent->GetHealthFraction());
+	SensedTargets.Add(Agent->GetSensedCharacter());
+	LastPathRequestsFailed.Add(Agent->HasLastPathRequestFailed());
+	Agent->AgentIndex = Agents.Add(Agent);
+}
+
+void USubSystemAI::UnregisterAgent(AEnemyCharacter* Agent)
+{
+	if (!Agent || !Agents.IsValidIndex(Agent->AgentIndex) || Agents[Agent->AgentIndex] != Agent) return;
+
+	// The enemy holds its own state again from now on.
+	const int32 AgentIndex = Agent->AgentIndex;
+	Agent->AgentIndex = INDEX_NONE;
+	Agent->CurrentState = States[AgentIndex];
+	Agent->SensedCharacter = SensedTargets[AgentIndex];
+	Agent->bLastPathRequestFailed = LastPathRequestsFailed[AgentIndex];
+	if (bUpdatingAgents)
+	{
+		// Moving the other agents around now would upset the loops over them, so leave a gap until the update ends.
+		Agents[AgentIndex] = nullptr;
+		bHasUnregisteredAgents = true;
+		return;
+	}
+	RemoveAgentAt(AgentIndex);
+}
+
+void USubSystemAI::RemoveAgentAt(int32 AgentIndex)
+{
+	Agents.RemoveAtSwap(AgentIndex);
+	States.RemoveAtSwap(AgentIndex);
+	PathCursors.RemoveAtSwap(AgentIndex);
+	HealthFractions.RemoveAtSwap(AgentIndex);
+	SensedTargets.RemoveAtSwap(AgentIndex);
+	LastPathRequestsFailed.RemoveAtSwap(AgentIndex);
+	if (Agents.IsValidIndex(AgentIndex) && Agents[AgentIndex])
+	{
+		Agents[AgentIndex]->AgentIndex = AgentIndex;
+	}
 }
 
+FEnemyAIDecision USubSystemAI::Decide(EEnemyState State, float HealthFraction, bool bHasTarget, bool bHasPath, bool bLastPathRequestFailed)
+{
+	FEnemyAIDecision Decision;
+	Decision.NextState = State;
+	switch (State)
+	{
+	case EEnemyState::Evade:
+		if (!bHasTarget)
+		{
+			Decision.NextState = EEnemyState::SlipAway;
+		}
+		else if (HealthFraction < 0.4f)
+		{
+			Decision.NextState = EEnemyState::LowHP;
+		}
+		break;
+
+	case EEnemyState::SlipAway:
+		if (bHasTarget)
+		{
+			if (HealthFraction == 1.0f)
+			{
+				Decision.NextState = EEnemyState::Controlled;
+			}
+			else if (HealthFraction >= 0.4f && HealthFraction <= 0.9f)
+			{
+				Decision.NextState = EEnemyState::Evade;
+			}
+			else if (HealthFraction < 0.4f)
+			{
+				Decision.NextState = EEnemyState::LowHP;
+			}
+		}
+		break;
+
+	case EEnemyState::LowHP:
+		if (!bHasTarget)
+		{
+			Decision.NextState = EEnemyState::SlipAway;
+		}
+		else
+		{
+			// Fall back to the spline when no cover path could be found.
+			Decision.bUseSplineFallback = !bHasPath && bLastPathRequestFailed;
+		}
+		break;
+
+	case EEnemyState::Controlled:
+		if (!bHasTarget)
+		{
+			Decision.NextState = EEnemyState::SlipAway;
+		}
+		else if (HealthFraction < 1.0f)
+		{
+			Decision.NextState = EEnemyState::Evade;
+		}
+		break;
+
+	default:
+		break;
+	}
+	Decision.bResetPath = Decision.NextState != State;
+	return Decision;
+}
@@ -4,23 +4,100 @@
 
 #include "CoreMinimal.h"
 #include "Subsystems/WorldSubsystem.h"
+#include "AGP/Characters/EnemyCharacter.h"
 #include "SubSystemAI.generated.h"
 
+class APlayerCharacter;
+
+/**
+ * What the state machine decided for one enemy this frame.
+ */
+struct FEnemyAIDecision
+{
+	EEnemyState NextState = EEnemyState::SlipAway;
+	// Set whenever the state changes, as the path of the old state is no use to the new one.
+	bool bResetPath = false;
+	// Set when a low health enemy couldn't find a path into cover and should head for the bunker spline instead.
+	bool bUseSplineFallback = false;
+
+	bool HasChanges() const
+	{
+		return bResetPath || bUseSplineFallback;
+	}
+};
+
 /**
- * 
+ * Updates every enemy character in one pass per frame instead of each enemy ticking on its own. The subsystem owns the
+ * state machine of every enemy, with the state and what the decisions are made from kept in parallel arrays indexed by
+ * agent: the state, how many points are left on the path, the health fraction and the sensed player. The arrays are
+ * the only copy while an enemy is registered. The enemies read and write them as their sight, path and health change,
+ * so nothing is copied out of the actors each frame.
+ *
+ * Each frame runs in three steps:
+ * 1. On the game thread, every enemy runs the behaviour of its state (sight, moving, asking for paths). This drives the
+ *    pawn sensing and the character movement, so it can't leave the game thread.
+ * 2. The decisions are made from the arrays alone, in a ParallelFor.
+ * 3. On the game thread, the decisions that change anything are applied to their enemies.
  */
-class ANavigationNode;
 UCLASS()
-class AGP_API USubSystemAI : public UWorldSubsystem
+class AGP_API USubSystemAI : public UTickableWorldSubsystem
 {
 	GENERATED_BODY()
 
-	
 public:
-	void OnWorldBeginPlay(UWorld& InWorld);
-	void SneakAway();
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Will start updating the enemy with the others, from the state it is in now. The enemy should stop ticking itself.
+	 */
+	void RegisterAgent(AEnemyCharacter* Agent);
+	/**
+	 * Will stop updating the enemy and hand its state back to it. Safe to call while the agents are being updated.
+	 */
+	void UnregisterAgent(AEnemyCharacter* Agent);
+
+	int32 GetNumAgents() const
+	{
+		return Agents.Num();
+	}
+
+	/**
+	 * Will make the state machine decision for one enemy. The transitions are:
+	 * - Any state other than SlipAway goes to SlipAway when the player is out of sight.
+	 * - SlipAway goes to Controlled at full health, Evade at 40 to 90 percent health and LowHP below that, once the
+	 *   player is in sight.
+	 * - Evade goes to LowHP below 40 percent health.
+	 * - Controlled goes to Evade once it has taken any damage.
+	 * - LowHP falls back to the spline when it has no path and the last path request failed.
+	 * @param bHasPath Whether the enemy has any points left on its path.
+	 */
+	static FEnemyAIDecision Decide(EEnemyState State, float HealthFraction, bool bHasTarget, bool bHasPath, bool bLastPathRequestFailed);
+
 private:
 
+	// The enemies read and write their own entries of the arrays.
+	friend class AEnemyCharacter;
+
+	/**
+	 * The enemies, indexed by their agent index. Entries are nullptr between an enemy unregistering during the update
+	 * and the end of the update.
+	 */
+	UPROPERTY()
+	TArray<AEnemyCharacter*> Agents;
+	TArray<EEnemyState> States;
+	// The number of points left on each enemy's path, which it walks from the back.
+	TArray<int32> PathCursors;
+	TArray<float> HealthFractions;
+	UPROPERTY()
+	TArray<APlayerCharacter*> SensedTargets;
+	TArray<bool> LastPathRequestsFailed;
+	// The decisions of the last update, one for each agent.
+	TArray<FEnemyAIDecision> Decisions;
 
+	bool bUpdatingAgents = false;
+	bool bHasUnregisteredAgents = false;
 
+	void RemoveAgentAt(int32 AgentIndex);
 };